@@ -87,8 +87,9 @@ int RealtimeMain(int argc, char** argv, std::function<void(elem::Runtime<float>&
     ma_device_config deviceConfig;
     ma_device device;
 
-    // XXX: I don't see a way to ask miniaudio for a specific block size. Let's just allocate
-    // here for 1024 and resize in the first callback if we need to.
+    // I don't see a way to ask miniaudio for a specific block size. The runtime splits any
+    // larger callback into blocks of 1024, and we resize our scratch space in the first
+    // callback if we need to.
     std::unique_ptr<DeviceProxy> proxy = std::make_unique<DeviceProxy>(44100.0, 1024);
 
     deviceConfig = ma_device_config_init(ma_device_type_playback);
@@ -73,6 +73,7 @@ export function sample(
     mode?: string;
     startOffset?: number;
     stopOffset?: number;
+    interpolation?: "linear" | "hermite" | "sinc";
   },
   trigger: ElemNode,
   rate: ElemNode,
@@ -84,16 +85,31 @@ export function table(
   props: {
     key?: string;
     path: string;
+    interpolation?: "linear" | "hermite" | "sinc";
   },
   t: ElemNode,
 ): NodeRepr_t {
   return createNode("table", props, [resolve(t)]);
 }
 
+export function wavetable(
+  props: {
+    key?: string;
+    path: string;
+  },
+  t: ElemNode,
+): NodeRepr_t {
+  return createNode("wavetable", props, [resolve(t)]);
+}
+
 export function convolve(
   props: {
     key?: string;
+    name?: string;
     path: string;
+    headSize?: number;
+    tailSize?: number;
+    background?: boolean;
   },
   x: ElemNode,
 ): NodeRepr_t {
@@ -173,6 +189,7 @@ export function sampleseq2(
     duration: number;
     stretch?: number;
     shift?: number;
+    background?: boolean;
   },
   time: ElemNode,
 ): NodeRepr_t {
@@ -288,6 +305,17 @@ export function biquad(
   ]);
 }
 
+export function biquadbank(
+  props: {
+    key?: string;
+    coeffs: Array<number> | Float32Array;
+    mode?: "cascade" | "parallel";
+  },
+  x: ElemNode,
+): NodeRepr_t {
+  return createNode("biquadbank", props, [resolve(x)]);
+}
+
 // Feedback nodes
 export function tapIn(props: { key?: string; name: string }): NodeRepr_t {
   return createNode("tapIn", props, []);
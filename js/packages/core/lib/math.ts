@@ -21,36 +21,70 @@ export function identity(
   return createNode("in", props, []);
 }
 
-export function sin(x: ElemNode): NodeRepr_t {
-  return createNode("sin", {}, [resolve(x)]);
+type UnaryMathProps = {
+  key?: string;
+  accuracy?: "exact" | "fast";
+};
+
+// The transcendental unary nodes accept an optional props object ahead of their
+// input, where `accuracy: "fast"` selects the runtime's vectorized polynomial kernels
+// over the default libm implementations.
+function unaryMath(
+  kind: string,
+  a: UnaryMathProps | ElemNode,
+  b?: ElemNode,
+): NodeRepr_t {
+  if (typeof b === "undefined") {
+    return createNode(kind, {}, [resolve(a as ElemNode)]);
+  }
+
+  return createNode(kind, a as UnaryMathProps, [resolve(b)]);
+}
+
+export function sin(x: ElemNode): NodeRepr_t;
+export function sin(props: UnaryMathProps, x: ElemNode): NodeRepr_t;
+export function sin(a: UnaryMathProps | ElemNode, b?: ElemNode): NodeRepr_t {
+  return unaryMath("sin", a, b);
 }
 
-export function cos(x: ElemNode): NodeRepr_t {
-  return createNode("cos", {}, [resolve(x)]);
+export function cos(x: ElemNode): NodeRepr_t;
+export function cos(props: UnaryMathProps, x: ElemNode): NodeRepr_t;
+export function cos(a: UnaryMathProps | ElemNode, b?: ElemNode): NodeRepr_t {
+  return unaryMath("cos", a, b);
 }
 
-export function tan(x: ElemNode): NodeRepr_t {
-  return createNode("tan", {}, [resolve(x)]);
+export function tan(x: ElemNode): NodeRepr_t;
+export function tan(props: UnaryMathProps, x: ElemNode): NodeRepr_t;
+export function tan(a: UnaryMathProps | ElemNode, b?: ElemNode): NodeRepr_t {
+  return unaryMath("tan", a, b);
 }
 
-export function tanh(x: ElemNode): NodeRepr_t {
-  return createNode("tanh", {}, [resolve(x)]);
+export function tanh(x: ElemNode): NodeRepr_t;
+export function tanh(props: UnaryMathProps, x: ElemNode): NodeRepr_t;
+export function tanh(a: UnaryMathProps | ElemNode, b?: ElemNode): NodeRepr_t {
+  return unaryMath("tanh", a, b);
 }
 
 export function asinh(x: ElemNode): NodeRepr_t {
   return createNode("asinh", {}, [resolve(x)]);
 }
 
-export function ln(x: ElemNode): NodeRepr_t {
-  return createNode("ln", {}, [resolve(x)]);
+export function ln(x: ElemNode): NodeRepr_t;
+export function ln(props: UnaryMathProps, x: ElemNode): NodeRepr_t;
+export function ln(a: UnaryMathProps | ElemNode, b?: ElemNode): NodeRepr_t {
+  return unaryMath("ln", a, b);
 }
 
-export function log(x: ElemNode): NodeRepr_t {
-  return createNode("log", {}, [resolve(x)]);
+export function log(x: ElemNode): NodeRepr_t;
+export function log(props: UnaryMathProps, x: ElemNode): NodeRepr_t;
+export function log(a: UnaryMathProps | ElemNode, b?: ElemNode): NodeRepr_t {
+  return unaryMath("log", a, b);
 }
 
-export function log2(x: ElemNode): NodeRepr_t {
-  return createNode("log2", {}, [resolve(x)]);
+export function log2(x: ElemNode): NodeRepr_t;
+export function log2(props: UnaryMathProps, x: ElemNode): NodeRepr_t;
+export function log2(a: UnaryMathProps | ElemNode, b?: ElemNode): NodeRepr_t {
+  return unaryMath("log2", a, b);
 }
 
 export function ceil(x: ElemNode): NodeRepr_t {
@@ -69,8 +103,10 @@ export function sqrt(x: ElemNode): NodeRepr_t {
   return createNode("sqrt", {}, [resolve(x)]);
 }
 
-export function exp(x: ElemNode): NodeRepr_t {
-  return createNode("exp", {}, [resolve(x)]);
+export function exp(x: ElemNode): NodeRepr_t;
+export function exp(props: UnaryMathProps, x: ElemNode): NodeRepr_t;
+export function exp(a: UnaryMathProps | ElemNode, b?: ElemNode): NodeRepr_t {
+  return unaryMath("exp", a, b);
 }
 
 export function abs(x: ElemNode): NodeRepr_t {
@@ -4,6 +4,7 @@ import {
   resolve,
   ElemNode,
   NodeRepr_t,
+  subgraph,
   unpack,
 } from "../nodeUtils";
 
@@ -18,6 +19,7 @@ export function sample(
     startOffset?: number;
     stopOffset?: number;
     playbackRate?: number;
+    interpolation?: "linear" | "hermite" | "sinc";
   },
   gate: ElemNode,
 ): Array<NodeRepr_t> {
@@ -59,6 +61,7 @@ export function sampleseq2(
     path: string;
     stretch?: number;
     shift?: number;
+    background?: boolean;
     channels: number;
   },
   time: ElemNode,
@@ -77,6 +80,7 @@ export function table(
   props: {
     key?: string;
     path: string;
+    interpolation?: "linear" | "hermite" | "sinc";
     channels: number;
   },
   t: ElemNode,
@@ -91,6 +95,297 @@ export function table(
   return unpack(createNode("mc.table", other, [resolve(t)]), channels);
 }
 
+export function biquadbank(
+  props: {
+    key?: string;
+    coeffs: Array<number> | Float32Array;
+    mode?: "cascade" | "parallel";
+    channels: number;
+  },
+  ...args: Array<ElemNode>
+): Array<NodeRepr_t> {
+  let { channels } = props;
+
+  invariant(
+    typeof channels === "number" && channels > 0,
+    "Must provide a positive number channels prop",
+  );
+
+  // Unlike the other mc nodes, the bank keeps `channels` in its props so that
+  // it can size its filter state for every channel up front
+  return unpack(createNode("mc.biquadbank", props, args.map(resolve)), channels);
+}
+
+export function blepsaw(
+  props: {
+    key?: string;
+  },
+  ...rates: Array<ElemNode>
+): Array<NodeRepr_t> {
+  invariant(rates.length > 0, "Must provide at least one voice frequency");
+
+  return unpack(
+    createNode("mc.blepsaw", { ...props, channels: rates.length }, rates.map(resolve)),
+    rates.length,
+  );
+}
+
+export function blepsquare(
+  props: {
+    key?: string;
+  },
+  ...rates: Array<ElemNode>
+): Array<NodeRepr_t> {
+  invariant(rates.length > 0, "Must provide at least one voice frequency");
+
+  return unpack(
+    createNode("mc.blepsquare", { ...props, channels: rates.length }, rates.map(resolve)),
+    rates.length,
+  );
+}
+
+export function bleptriangle(
+  props: {
+    key?: string;
+  },
+  ...rates: Array<ElemNode>
+): Array<NodeRepr_t> {
+  invariant(rates.length > 0, "Must provide at least one voice frequency");
+
+  return unpack(
+    createNode("mc.bleptriangle", { ...props, channels: rates.length }, rates.map(resolve)),
+    rates.length,
+  );
+}
+
+export function noise(props: {
+  key?: string;
+  seed?: number;
+  distribution?: "uniform" | "gaussian" | "pink";
+  channels: number;
+}): Array<NodeRepr_t> {
+  let { channels } = props;
+
+  invariant(
+    typeof channels === "number" && channels > 0,
+    "Must provide a positive number channels prop",
+  );
+
+  // As with biquadbank, `channels` stays in the props so that the node can size
+  // its pink filter state for every channel
+  return unpack(createNode("mc.noise", props, []), channels);
+}
+
+export function stft(
+  props: {
+    key?: string;
+    size: number;
+    hop: number;
+    window?: "hann" | "hamming" | "blackman" | "rect";
+  },
+  x: ElemNode,
+): Array<NodeRepr_t> {
+  let { size, hop } = props;
+
+  invariant(
+    typeof size === "number" && typeof hop === "number" && hop > 0 && size >= 2 * hop,
+    "Must provide a size prop of at least twice the hop prop",
+  );
+
+  // The spectrum is carried on size / hop channels of interleaved real and
+  // imaginary parts, followed by one channel of bin offsets within the hop
+  return unpack(createNode("mc.stft", props, [resolve(x)]), size / hop + 1);
+}
+
+export function istft(
+  props: {
+    key?: string;
+    size: number;
+    hop: number;
+    window?: "hann" | "hamming" | "blackman" | "rect";
+  },
+  ...spectrum: Array<ElemNode>
+): NodeRepr_t {
+  let { size, hop } = props;
+
+  invariant(
+    typeof size === "number" && typeof hop === "number" && hop > 0 && size >= 2 * hop,
+    "Must provide a size prop of at least twice the hop prop",
+  );
+
+  invariant(
+    spectrum.length >= size / hop,
+    "Must provide every spectral channel from the matching stft",
+  );
+
+  return createNode("mc.istft", props, spectrum.map(resolve));
+}
+
+export function fdn(
+  props: {
+    key?: string;
+    size?: number;
+    times?: Array<number>;
+    matrix?: "hadamard" | "householder";
+    decay?: number;
+    damping?: number;
+    channels: number;
+  },
+  ...args: Array<ElemNode>
+): Array<NodeRepr_t> {
+  let { channels, ...other } = props;
+
+  invariant(
+    typeof channels === "number" && channels > 0,
+    "Must provide a positive number channels prop",
+  );
+
+  return unpack(createNode("mc.fdn", other, args.map(resolve)), channels);
+}
+
+export function multitap(
+  props: {
+    key?: string;
+    size: number;
+    times?: Array<number>;
+    gains?: Array<number>;
+    sum?: boolean;
+  },
+  x: ElemNode,
+  ...taps: Array<ElemNode>
+): Array<NodeRepr_t> {
+  let { times, sum } = props;
+
+  invariant(
+    taps.length % 2 === 0,
+    "Must provide tap signals as (time, gain) pairs",
+  );
+
+  invariant(
+    taps.length > 0 || Array.isArray(times),
+    "Must provide either a times prop or tap signals",
+  );
+
+  // Signal taps, given in (time, gain) pairs, take precedence over the
+  // times and gains props
+  const numTaps = taps.length > 0 ? taps.length / 2 : (times ?? []).length;
+
+  return unpack(
+    createNode("mc.multitap", props, [resolve(x), ...taps.map(resolve)]),
+    sum ? 1 : numTaps,
+  );
+}
+
+export function dynamics(
+  props: {
+    key?: string;
+    mode?: "compressor" | "limiter" | "gate";
+    threshold?: number;
+    ratio?: number;
+    knee?: number;
+    range?: number;
+    attack?: number;
+    release?: number;
+    lookahead?: number;
+    channels: number;
+  },
+  ...args: Array<ElemNode>
+): Array<NodeRepr_t> {
+  let { channels } = props;
+
+  invariant(
+    typeof channels === "number" && channels > 0,
+    "Must provide a positive number channels prop",
+  );
+
+  invariant(
+    args.length >= channels,
+    "Must provide an input signal for every channel",
+  );
+
+  // The first `channels` children are processed, and any beyond them drive the
+  // detector as a sidechain. The node needs `channels` to tell the two apart.
+  return unpack(createNode("mc.dynamics", props, args.map(resolve)), channels);
+}
+
+export function voices(
+  props: {
+    key?: string;
+    voices: number;
+    inputs?: number;
+    gate?: number;
+  },
+  template: ElemNode | Array<ElemNode>,
+  ...args: Array<ElemNode>
+): Array<NodeRepr_t> {
+  let { voices } = props;
+
+  invariant(
+    typeof voices === "number" && voices > 0,
+    "Must provide a positive number voices prop",
+  );
+
+  // The template is rendered once per voice inside the container, where its
+  // `el.in` nodes read the voice's inputs rather than the host's
+  const outputs = Array.isArray(template) ? template : [template];
+
+  return unpack(
+    createNode("mc.voices", { ...props, template: subgraph(outputs) }, args.map(resolve)),
+    outputs.length,
+  );
+}
+
+export function oversample(
+  props: {
+    key?: string;
+    factor: number;
+  },
+  template: ElemNode | Array<ElemNode>,
+  ...args: Array<ElemNode>
+): Array<NodeRepr_t> {
+  let { factor } = props;
+
+  invariant(
+    [1, 2, 4, 8].includes(factor),
+    "The factor prop must be 1, 2, 4 or 8",
+  );
+
+  // The template runs inside the container at the raised rate, where its
+  // `el.in` nodes read the container's upsampled children
+  const outputs = Array.isArray(template) ? template : [template];
+
+  return unpack(
+    createNode("mc.oversample", { ...props, template: subgraph(outputs) }, args.map(resolve)),
+    outputs.length,
+  );
+}
+
+export function decimate(
+  props: {
+    key?: string;
+    factor: number;
+    interpolation?: "linear" | "cubic";
+  },
+  template: ElemNode | Array<ElemNode>,
+  ...args: Array<ElemNode>
+): Array<NodeRepr_t> {
+  let { factor } = props;
+
+  invariant(
+    Number.isInteger(factor) && factor > 0,
+    "Must provide a positive integer factor prop",
+  );
+
+  // The template runs inside the container at the reduced rate, where its
+  // `el.in` nodes read the container's decimated children
+  const outputs = Array.isArray(template) ? template : [template];
+
+  return unpack(
+    createNode("mc.decimate", { ...props, template: subgraph(outputs) }, args.map(resolve)),
+    outputs.length,
+  );
+}
+
 export function capture(
   props: {
     name?: string;
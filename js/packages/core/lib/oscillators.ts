@@ -132,17 +132,24 @@ export function bleptriangle(rate: ElemNode): NodeRepr_t {
 }
 
 /**
- * A simple white noise generator.
+ * A white noise generator.
  *
- * Generates values uniformly distributed on the range [-1, 1]
+ * By default generates values uniformly distributed on the range [-1, 1). The
+ * distribution property may instead select "gaussian" for normally distributed
+ * values with unit variance, or "pink" for noise with a -3dB/octave rolloff.
  *
- * The seed property may be used to seed the underying random number generator.
+ * The seed property may be used to seed the underying random number generator;
+ * the same seed always renders the same noise.
  *
  * @param {Object} props
  * @returns {NodeRepr_t}
  */
-export function noise(props?: { key?: string; seed?: number }): NodeRepr_t {
-  return el.sub(el.mul(2, el.rand(props)), 1);
+export function noise(props?: {
+  key?: string;
+  seed?: number;
+  distribution?: "uniform" | "gaussian" | "pink";
+}): NodeRepr_t {
+  return createNode("noise", props || {}, []);
 }
 
 /**
@@ -156,5 +163,5 @@ export function noise(props?: { key?: string; seed?: number }): NodeRepr_t {
  * @returns {core.Node}
  */
 export function pinknoise(props?: { key?: string; seed?: number }): NodeRepr_t {
-  return el.pink(noise(props));
+  return createNode("noise", { ...props, distribution: "pink" }, []);
 }
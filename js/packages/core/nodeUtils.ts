@@ -41,3 +41,35 @@ export function unpack(node: NodeRepr_t, numChannels: number): Array<NodeRepr_t>
     };
   });
 }
+
+// Serializes the graph behind the given output nodes into the template format that
+// container nodes such as `mc.voices` expect: a list of nodes, children first, each
+// with its kind, props, and children by index and output channel, followed by the
+// list of output channels.
+export function subgraph(outputs: Array<ElemNode>) {
+  const nodes: Array<[string, any, Array<[number, number]>]> = [];
+  const indices = new Map<number, number>();
+
+  const visit = (n: NodeRepr_t): number => {
+    const existing = indices.get(n.hash);
+
+    if (typeof existing === 'number')
+      return existing;
+
+    const children: Array<[number, number]> = [];
+
+    // Children are held in a ReScript list of {hd, tl} cells
+    for (let cell: any = n.children; cell; cell = cell.tl) {
+      children.push([visit(cell.hd), cell.hd.outputChannel]);
+    }
+
+    nodes.push([n.kind, n.props, children]);
+    indices.set(n.hash, nodes.length - 1);
+
+    return nodes.length - 1;
+  };
+
+  const outs = outputs.map(resolve).map((n) => [visit(n), n.outputChannel]);
+
+  return { nodes, outputs: outs };
+}
@@ -89,3 +89,37 @@ test('sdelay basics', async function() {
 
   expect(outs[0]).toMatchSnapshot();
 });
+
+test('mc.multitap matches sdelay', async function() {
+  let core = new OfflineRenderer();
+
+  await core.initialize({
+    numInputChannels: 1,
+    numOutputChannels: 3,
+  });
+
+  let x = el.in({channel: 0});
+  let taps = el.mc.multitap({size: 100, times: [3, 40], gains: [1, 0.5]}, x);
+  let [summed] = el.mc.multitap({size: 100, times: [3, 40], gains: [1, 0.5], sum: true}, x);
+
+  // Graph
+  core.render(
+    el.sub(taps[0], el.sdelay({size: 3}, x)),
+    el.sub(taps[1], el.mul(0.5, el.sdelay({size: 40}, x))),
+    el.sub(summed, el.add(taps[0], taps[1])),
+  );
+
+  let inps = [Float32Array.from({length: 512 * 4}, (_, i) => Math.sin(i * 0.1))];
+  let outs = [
+    new Float32Array(512 * 4),
+    new Float32Array(512 * 4),
+    new Float32Array(512 * 4),
+  ];
+
+  // Drive our delays
+  core.process(inps, outs);
+
+  for (let out of outs) {
+    expect(out.every((x) => Math.abs(x) < 1e-6)).toBe(true);
+  }
+});
@@ -0,0 +1,39 @@
+import OfflineRenderer from '..';
+import { el } from '@elemaudio/core';
+
+
+// The adsr graph as it was composed before the native node
+function composedAdsr(a, d, s, r, g) {
+  let atkSamps = el.mul(a, el.sr());
+  let atkGate = el.le(el.counter(g), atkSamps);
+  let targetValue = el.select(g, el.select(atkGate, 1.0, s), 0);
+  let t60 = el.max(0.0001, el.select(g, el.select(atkGate, a, d), r));
+  let p = el.tau2pole(el.div(t60, 6.91));
+
+  return el.smooth(p, targetValue);
+}
+
+test('adsr matches the composed graph', async function() {
+  let core = new OfflineRenderer();
+
+  await core.initialize({
+    numInputChannels: 1,
+    numOutputChannels: 2,
+  });
+
+  let args = [0.002, 0.005, 0.4, 0.01, el.in({channel: 0})];
+
+  core.render(el.adsr(...args), composedAdsr(...args));
+
+  // Get past the fade-in
+  core.process([new Float32Array(512 * 10)], [new Float32Array(512 * 10), new Float32Array(512 * 10)]);
+
+  // Two notes, the second released during its attack
+  let gate = Float32Array.from({length: 512 * 8}, (_, i) => (i < 1200 || (i >= 2400 && i < 2450)) ? 1 : 0);
+  let outs = [new Float32Array(gate.length), new Float32Array(gate.length)];
+
+  core.process([gate], outs);
+
+  expect(outs[0].some((x) => x > 0.9)).toBe(true);
+  outs[0].forEach((x, i) => expect(x).toBeCloseTo(outs[1][i], 5));
+});
@@ -0,0 +1,78 @@
+import OfflineRenderer from '..';
+import { el } from '@elemaudio/core';
+
+
+// A direct, per-sample implementation of the svf, computing its coefficients on
+// every tick
+function svfReference(mode, sampleRate, fc, q, x) {
+  let ic1eq = 0;
+  let ic2eq = 0;
+
+  return x.map((v0, i) => {
+    let g = Math.tan(3.14159265359 * Math.min(Math.max(fc[i], 20), sampleRate / 2.0001) / sampleRate);
+    let k = 1 / Math.min(Math.max(q, 0.25), 20);
+    let a1 = 1 / (1 + g * (g + k));
+    let a2 = g * a1;
+    let a3 = g * a2;
+
+    let v3 = v0 - ic2eq;
+    let v1 = ic1eq * a1 + v3 * a2;
+    let v2 = ic2eq + ic1eq * a2 + v3 * a3;
+
+    ic1eq = 2 * v1 - ic1eq;
+    ic2eq = 2 * v2 - ic2eq;
+
+    return mode === 'lowpass' ? v2 : v0 - k * v1 - v2;
+  });
+}
+
+test('svf with steady and modulated cutoff', async function() {
+  let core = new OfflineRenderer();
+  let blockSize = 512;
+  let numBlocks = 24;
+
+  await core.initialize({
+    numInputChannels: 2,
+    numOutputChannels: 2,
+    sampleRate: 44100,
+    blockSize,
+  });
+
+  let fc = el.in({channel: 0});
+  let x = el.in({channel: 1});
+
+  core.render(
+    el.svf({mode: 'lowpass'}, fc, 1.5, x),
+    el.svf({mode: 'highpass'}, fc, 1.5, x),
+  );
+
+  // The cutoff holds steady, sweeps within blocks, then holds steady at a new
+  // value, and finally changes between otherwise steady blocks. Steady blocks take
+  // the cached coefficients, and must not drift from the per-sample reference.
+  let cutoff = Float32Array.from({length: numBlocks * blockSize}, (_, i) => {
+    let block = Math.floor(i / blockSize);
+
+    if (block < 12)
+      return 1000;
+    if (block < 16)
+      return 1000 + 2000 * (i - 12 * blockSize) / (4 * blockSize);
+    if (block < 20)
+      return 3000;
+
+    return block % 2 === 0 ? 500 : 8000;
+  });
+
+  let input = Float32Array.from({length: numBlocks * blockSize}, () => 2 * Math.random() - 1);
+  let outs = [new Float32Array(numBlocks * blockSize), new Float32Array(numBlocks * blockSize)];
+
+  core.process([cutoff, input], outs);
+
+  ['lowpass', 'highpass'].forEach((mode, k) => {
+    let expected = svfReference(mode, 44100, Array.from(cutoff), 1.5, Array.from(input));
+
+    // Skip past the root node fade-in
+    for (let i = 10 * blockSize; i < expected.length; ++i) {
+      expect(outs[k][i]).toBeCloseTo(expected[i], 5);
+    }
+  });
+});
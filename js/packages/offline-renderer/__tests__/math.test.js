@@ -0,0 +1,121 @@
+import OfflineRenderer from '..';
+import { el } from '@elemaudio/core';
+
+
+const kernels = [
+  ['sin', -1000, 1000],
+  ['cos', -1000, 1000],
+  ['tan', -1.5, 1.5],
+  ['tanh', -20, 20],
+  ['exp', -20, 20],
+  ['ln', 1e-3, 1e3],
+  ['log', 1e-3, 1e3],
+  ['log2', 1e-3, 1e3],
+];
+
+test('fast math kernels match exact', async function() {
+  let core = new OfflineRenderer();
+
+  await core.initialize({
+    numInputChannels: 1,
+    numOutputChannels: kernels.length * 2,
+  });
+
+  core.render(...kernels.flatMap(([kind]) => [
+    el[kind](el.in({channel: 0})),
+    el[kind]({accuracy: 'fast'}, el.in({channel: 0})),
+  ]));
+
+  // Get past the fade-in
+  let inps = [new Float32Array(512 * 10)];
+  let outs = kernels.flatMap(() => [new Float32Array(512 * 10), new Float32Array(512 * 10)]);
+
+  core.process(inps, outs);
+
+  for (let k = 0; k < kernels.length; ++k) {
+    let [kind, lo, hi] = kernels[k];
+
+    inps = [Float32Array.from({length: 512}, (_, i) => lo + (hi - lo) * i / 511)];
+    outs = kernels.flatMap(() => [new Float32Array(512), new Float32Array(512)]);
+
+    core.process(inps, outs);
+
+    let exact = outs[2 * k];
+    let fast = outs[2 * k + 1];
+
+    exact.forEach((x, i) => {
+      expect(Math.abs(fast[i] - x)).toBeLessThanOrEqual(1e-6 * Math.max(1, Math.abs(x)));
+    });
+  }
+});
+
+test('fast trig stays bounded for huge arguments', async function() {
+  let core = new OfflineRenderer();
+
+  await core.initialize({
+    numInputChannels: 1,
+    numOutputChannels: 2,
+  });
+
+  core.render(
+    el.sin({accuracy: 'fast'}, el.in({channel: 0})),
+    el.cos({accuracy: 'fast'}, el.in({channel: 0})),
+  );
+
+  // Get past the fade-in
+  let inps = [new Float32Array(512 * 10)];
+  let outs = [new Float32Array(512 * 10), new Float32Array(512 * 10)];
+
+  core.process(inps, outs);
+
+  inps = [Float32Array.from([3e9, -3e9, 1e12, -1e12, 1e20, -1e20, 1e30, -1e30])];
+  outs = [new Float32Array(8), new Float32Array(8)];
+
+  core.process(inps, outs);
+
+  outs.forEach((out) => {
+    out.forEach((x) => {
+      expect(Number.isFinite(x)).toBe(true);
+      expect(Math.abs(x)).toBeLessThanOrEqual(1);
+    });
+  });
+});
+
+test('reducing math nodes match a sequential fold', async function() {
+  let core = new OfflineRenderer();
+  let numInputs = 7;
+
+  // An odd block size so that each block ends with a partial tile
+  await core.initialize({
+    numInputChannels: numInputs,
+    numOutputChannels: 4,
+    blockSize: 37,
+  });
+
+  let ins = Array.from({length: numInputs}, (_, i) => el.in({channel: i}));
+  let folds = [
+    [el.add, (a, b) => a + b],
+    [el.mul, (a, b) => a * b],
+    [el.min, Math.min],
+    [el.max, Math.max],
+  ];
+
+  core.render(...folds.map(([node]) => node(...ins)));
+
+  // Get past the fade-in
+  let inps = ins.map(() => new Float32Array(37 * 40));
+  let outs = folds.map(() => new Float32Array(37 * 40));
+
+  core.process(inps, outs);
+
+  inps = ins.map(() => Float32Array.from({length: 37 * 4}, () => 4 * Math.random() - 2));
+  outs = folds.map(() => new Float32Array(37 * 4));
+
+  core.process(inps, outs);
+
+  folds.forEach(([, fn], k) => {
+    outs[k].forEach((x, i) => {
+      expect(x).toBe(Math.fround(inps.reduce((acc, inp, j) => j === 0 ? inp[i] : fn(acc, inp[i]), 0)));
+    });
+  });
+});
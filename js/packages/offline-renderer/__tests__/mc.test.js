@@ -1,5 +1,5 @@
 import OfflineRenderer from "..";
-import { el } from "@elemaudio/core";
+import { el, createNode } from "@elemaudio/core";
 
 test("mc table", async function () {
   let core = new OfflineRenderer();
@@ -387,3 +387,387 @@ test("mc.sample again", async function () {
 
   expect(outs[0]).toMatchSnapshot();
 });
+
+test("mc biquadbank", async function () {
+  let core = new OfflineRenderer();
+
+  await core.initialize({
+    numInputChannels: 2,
+    numOutputChannels: 2,
+  });
+
+  // A pure gain section followed by a one sample delay with gain, such that
+  // the cascade delays by one sample and the parallel form sums the two
+  let coeffs = [0.5, 0, 0, 0, 0, 0, 2, 0, 0, 0];
+
+  await core.render(
+    ...el.mc.biquadbank(
+      { coeffs, channels: 2 },
+      el.in({ channel: 0 }),
+      el.in({ channel: 1 }),
+    ),
+  );
+
+  // Get past the fade-in
+  let inps = [new Float32Array(512 * 10), new Float32Array(512 * 10)];
+  let outs = [new Float32Array(512 * 10), new Float32Array(512 * 10)];
+
+  core.process(inps, outs);
+
+  inps = [
+    Float32Array.from([1, 2, 3, 4, 5, 6, 7, 8]),
+    Float32Array.from([-1, -2, -3, -4, -5, -6, -7, -8]),
+  ];
+  outs = [new Float32Array(8), new Float32Array(8)];
+
+  core.process(inps, outs);
+
+  // Adding zero folds any negative zeros, which toEqual would distinguish
+  expect(Array.from(outs[0], (x) => x + 0)).toEqual([0, 1, 2, 3, 4, 5, 6, 7]);
+  expect(Array.from(outs[1], (x) => x + 0)).toEqual([0, -1, -2, -3, -4, -5, -6, -7]);
+
+  await core.render(
+    ...el.mc.biquadbank(
+      { coeffs, channels: 2, mode: "parallel" },
+      el.in({ channel: 0 }),
+      el.in({ channel: 1 }),
+    ),
+  );
+
+  inps = [new Float32Array(512 * 10), new Float32Array(512 * 10)];
+  outs = [new Float32Array(512 * 10), new Float32Array(512 * 10)];
+
+  core.process(inps, outs);
+
+  inps = [Float32Array.from([2, 4, 6, 8]), Float32Array.from([0, 0, 0, 0])];
+  outs = [new Float32Array(4), new Float32Array(4)];
+
+  core.process(inps, outs);
+
+  expect(Array.from(outs[0], (x) => x + 0)).toEqual([1, 6, 11, 16]);
+  expect(Array.from(outs[1], (x) => x + 0)).toEqual([0, 0, 0, 0]);
+});
+
+test("mc blepsaw matches blepsaw", async function () {
+  let core = new OfflineRenderer();
+
+  await core.initialize({
+    numInputChannels: 0,
+    numOutputChannels: 3,
+  });
+
+  let [a, b, c] = el.mc.blepsaw({}, 440, 660, 12000);
+
+  await core.render(
+    el.sub(a, el.blepsaw(440)),
+    el.sub(b, el.blepsaw(660)),
+    el.sub(c, el.blepsaw(12000)),
+  );
+
+  let inps = [];
+  let outs = [
+    new Float32Array(512 * 4),
+    new Float32Array(512 * 4),
+    new Float32Array(512 * 4),
+  ];
+
+  core.process(inps, outs);
+
+  for (let out of outs) {
+    expect(out.every((x) => x === 0)).toBe(true);
+  }
+});
+
+test("mc noise", async function () {
+  let core = new OfflineRenderer();
+
+  await core.initialize({
+    numInputChannels: 0,
+    numOutputChannels: 2,
+  });
+
+  let [a, b] = el.mc.noise({ seed: 7, channels: 2 });
+
+  await core.render(el.sub(a, el.noise({ seed: 7 })), b);
+
+  let inps = [];
+  let outs = [new Float32Array(512 * 4), new Float32Array(512 * 4)];
+
+  core.process(inps, outs);
+
+  // Channel 0 follows the same stream as a single noise node with the same
+  // seed, while channel 1 is an independent stream
+  expect(outs[0].every((x) => x === 0)).toBe(true);
+  expect(outs[1].some((x) => x !== 0)).toBe(true);
+  expect(outs[1].every((x) => x >= -1 && x < 1)).toBe(true);
+});
+
+test("mc stft resynthesis", async function () {
+  let core = new OfflineRenderer();
+
+  await core.initialize({
+    numInputChannels: 1,
+    numOutputChannels: 1,
+  });
+
+  // An untouched spectrum resynthesizes to the input, delayed by size + hop
+  let framing = { size: 64, hop: 16 };
+  let spectrum = el.mc.stft(framing, el.in({ channel: 0 }));
+
+  await core.render(el.mc.istft(framing, ...spectrum));
+
+  // Get past the fade-in
+  core.process([new Float32Array(512 * 10)], [new Float32Array(512 * 10)]);
+
+  let x = Float32Array.from({ length: 512 * 4 }, (_, i) => Math.sin(i * 0.1) * Math.cos(i * 0.013));
+  let inps = [x];
+  let outs = [new Float32Array(x.length)];
+
+  core.process(inps, outs);
+
+  for (let i = 80; i < x.length; ++i) {
+    expect(outs[0][i]).toBeCloseTo(x[i - 80], 5);
+  }
+});
+
+test("mc dynamics", async function () {
+  let core = new OfflineRenderer();
+
+  await core.initialize({
+    numInputChannels: 1,
+    numOutputChannels: 2,
+  });
+
+  // A hard knee compressor matches the composed el.compress, and lookahead only
+  // delays the signal, by 1ms or 44 samples, when the detector stays below the
+  // threshold
+  let x = el.in({ channel: 0 });
+  let props = { threshold: -20, ratio: 4, attack: 5, release: 50, channels: 1 };
+  let [a] = el.mc.dynamics(props, x);
+  let [b] = el.mc.dynamics({ threshold: 0, lookahead: 1, channels: 1 }, x);
+
+  await core.render(el.sub(a, el.compress(5, 50, -20, 4, x, x)), b);
+
+  let inp = Float32Array.from({ length: 512 * 4 }, (_, i) => 0.9 * Math.sin(i * 0.05));
+  let outs = [new Float32Array(inp.length), new Float32Array(inp.length)];
+
+  core.process([inp], outs);
+
+  for (let i = 0; i < inp.length; ++i) {
+    expect(outs[0][i]).toBeCloseTo(0, 4);
+    expect(outs[1][i]).toBeCloseTo(i >= 44 ? inp[i - 44] : 0, 5);
+  }
+});
+
+test("mc fdn", async function () {
+  let core = new OfflineRenderer();
+
+  await core.initialize({
+    numInputChannels: 1,
+    numOutputChannels: 2,
+  });
+
+  let [left, right] = el.mc.fdn({ size: 8, decay: 0.5, channels: 2 }, el.in({ channel: 0 }));
+
+  await core.render(left, right);
+
+  // Get past the fade-in
+  core.process([new Float32Array(512 * 10)], [new Float32Array(512 * 10), new Float32Array(512 * 10)]);
+
+  let x = new Float32Array(44100);
+  let outs = [new Float32Array(x.length), new Float32Array(x.length)];
+
+  x[0] = 1;
+  core.process([x], outs);
+
+  // Nothing comes out before the shortest line, 25ms, and the tail falls by
+  // 60dB every half second
+  let energy = (out, from, to) => out.slice(from, to).reduce((acc, v) => acc + v * v, 0);
+
+  for (let out of outs) {
+    expect(energy(out, 0, 1100)).toBe(0);
+    expect(energy(out, 4410, 8820)).toBeGreaterThan(0);
+    expect(energy(out, 26460, 30870)).toBeLessThan(energy(out, 4410, 8820) * 1e-4);
+  }
+});
+
+test("mc fdn line lengths", async function () {
+  let core = new OfflineRenderer();
+
+  await core.initialize({
+    numInputChannels: 1,
+    numOutputChannels: 1,
+    sampleRate: 44100,
+  });
+
+  let fdn = (times) => el.mc.fdn({ size: 2, times, channels: 1 }, el.in({ channel: 0 }))[0];
+
+  // Lines may be up to five seconds long
+  await core.render(fdn([5 * 44100, 100]));
+
+  for (let t of [5 * 44100 + 1, 1e12, 0]) {
+    await expect(core.render(fdn([t, 100]))).rejects.toMatchObject({ success: false });
+  }
+});
+
+test("mc voices", async function () {
+  let core = new OfflineRenderer();
+
+  await core.initialize({
+    numInputChannels: 0,
+    numOutputChannels: 1,
+  });
+
+  // Each voice reads its gate and frequency from its own pair of children
+  let template = el.mul(el.in({ channel: 0 }), el.phasor(el.in({ channel: 1 })));
+  let gates = [1, 0, 1, 0.5];
+  let freqs = [220, 330, 440, 550];
+
+  let [poly] = el.mc.voices(
+    { voices: 4 },
+    template,
+    ...gates.flatMap((g, i) => [g, freqs[i]]),
+  );
+
+  let flat = el.add(...gates.map((g, i) => el.mul(g, el.phasor(freqs[i]))));
+
+  await core.render(el.sub(poly, flat));
+
+  let outs = [new Float32Array(512 * 4)];
+
+  core.process([], outs);
+
+  expect(outs[0].every((x) => Math.abs(x) < 1e-6)).toBe(true);
+});
+
+test("mc voices vfs update", async function () {
+  let core = new OfflineRenderer();
+
+  await core.initialize({
+    numInputChannels: 0,
+    numOutputChannels: 1,
+    virtualFileSystem: {
+      "/v/level": Float32Array.from([1, 1, 1, 1]),
+    },
+  });
+
+  // Two ungated voices, each reading the table from within its subgraph
+  let [poly] = el.mc.voices(
+    { voices: 2, gate: -1 },
+    el.table({ path: "/v/level" }, el.const({ value: 0.5 })),
+  );
+
+  await core.render(poly);
+
+  // Get past the fade-in
+  let outs = [new Float32Array(512 * 10)];
+
+  core.process([], outs);
+  expect(outs[0][outs[0].length - 1]).toBeCloseTo(2, 6);
+
+  // Replacing the resource reaches the nodes inside the voices without a render
+  core.updateVirtualFileSystem(
+    { "/v/level": Float32Array.from([3, 3, 3, 3]) },
+    { replaceExisting: true },
+  );
+
+  outs = [new Float32Array(512)];
+
+  core.process([], outs);
+  expect(outs[0][outs[0].length - 1]).toBeCloseTo(6, 6);
+});
+
+// Renders a container whose template outputs a constant on the given channel of its
+// one node, checks that out of range channels are rejected, and that the container
+// keeps its previous template through a rebuild afterwards
+async function expectTemplateChecks(type, props, rebuildProps, expected) {
+  let core = new OfflineRenderer();
+
+  await core.initialize({
+    numInputChannels: 0,
+    numOutputChannels: 1,
+  });
+
+  let template = (channel) => ({
+    nodes: [["const", { value: 1 }, []]],
+    outputs: [[0, channel]],
+  });
+
+  let render = (p, channel) =>
+    core.render(createNode(type, { key: "container", ...p, template: template(channel) }, []));
+
+  await render(props, 0);
+
+  // Get past the fade-in
+  let outs = [new Float32Array(512 * 10)];
+
+  core.process([], outs);
+  expect(outs[0][outs[0].length - 1]).toBeCloseTo(1, 3);
+
+  for (let channel of [1e12, 1024, -1, NaN]) {
+    await expect(render(props, channel)).rejects.toMatchObject({ success: false });
+  }
+
+  await render(rebuildProps, 0);
+
+  outs = [new Float32Array(512 * 4)];
+
+  core.process([], outs);
+  expect(outs[0][outs[0].length - 1]).toBeCloseTo(expected, 3);
+}
+
+test("mc voices template checks", async function () {
+  await expectTemplateChecks("mc.voices", { voices: 1, gate: -1 }, { voices: 2, gate: -1 }, 2);
+});
+
+test("mc oversample", async function () {
+  let core = new OfflineRenderer();
+
+  await core.initialize({
+    numInputChannels: 0,
+    numOutputChannels: 1,
+  });
+
+  // A linear template comes back out as its input, delayed by the 63 samples
+  // of latency in the 2x halfband filters
+  let x = el.cycle(440);
+  let [y] = el.mc.oversample({ factor: 2 }, el.mul(0.5, el.in({ channel: 0 })), x);
+
+  await core.render(el.sub(y, el.mul(0.5, el.sdelay({ size: 63 }, x))));
+
+  let outs = [new Float32Array(512 * 4)];
+
+  core.process([], outs);
+
+  expect(outs[0].slice(512).every((v) => Math.abs(v) < 1e-3)).toBe(true);
+});
+
+test("mc oversample template checks", async function () {
+  await expectTemplateChecks("mc.oversample", { factor: 2 }, { factor: 4 }, 1);
+});
+
+test("mc decimate", async function () {
+  let core = new OfflineRenderer();
+
+  await core.initialize({
+    numInputChannels: 0,
+    numOutputChannels: 1,
+  });
+
+  // Linear interpolation delays the subgraph's output by one decimated step,
+  // and a slow LFO comes through otherwise intact
+  let x = el.cycle(2);
+  let [y] = el.mc.decimate({ factor: 16 }, el.in({ channel: 0 }), x);
+
+  await core.render(el.sub(y, el.sdelay({ size: 16 }, x)));
+
+  let outs = [new Float32Array(512 * 4)];
+
+  core.process([], outs);
+
+  expect(outs[0].every((v) => Math.abs(v) < 1e-4)).toBe(true);
+});
+
+test("mc decimate template checks", async function () {
+  await expectTemplateChecks("mc.decimate", { factor: 1 }, { factor: 2 }, 1);
+});
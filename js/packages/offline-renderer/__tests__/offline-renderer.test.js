@@ -119,3 +119,67 @@ test('render stats', async function() {
     success: false,
   });
 });
+
+test('prepare for new settings', async function() {
+  let graph = (x) => [
+    el.sr(),
+    el.adsr(0.01, 0.02, 0.5, 0.05, x),
+    el.svf({mode: 'lowpass'}, 2000, 1.5, x),
+    el.delay({size: 1000}, 300, 0.5, x),
+  ];
+
+  let settle = (core, blockSize) => {
+    core.process([new Float32Array(blockSize * 40)], [0, 1, 2, 3].map(() => new Float32Array(blockSize * 40)));
+  };
+
+  let step = (core) => {
+    let gate = Float32Array.from({length: 4096}, (_, i) => i < 2000 ? 1 : 0);
+    let outs = [0, 1, 2, 3].map(() => new Float32Array(gate.length));
+
+    core.process([gate], outs);
+    return outs;
+  };
+
+  // One renderer prepared for the new settings after its graph is built, the other
+  // built with them from the start
+  let moved = new OfflineRenderer();
+  let fresh = new OfflineRenderer();
+
+  await moved.initialize({numInputChannels: 1, numOutputChannels: 4, sampleRate: 44100, blockSize: 512});
+  await moved.render(...graph(el.in({channel: 0})));
+  settle(moved, 512);
+
+  moved.prepare(96000, 128);
+  await fresh.initialize({numInputChannels: 1, numOutputChannels: 4, sampleRate: 96000, blockSize: 128});
+  await fresh.render(...graph(el.in({channel: 0})));
+  settle(fresh, 128);
+
+  let a = step(moved);
+  let b = step(fresh);
+
+  expect(a[0][0]).toBe(96000);
+  expect(a[1].some((x) => x > 0.9)).toBe(true);
+
+  for (let c = 0; c < 4; ++c) {
+    a[c].forEach((x, i) => expect(x).toBeCloseTo(b[c][i], 5));
+  }
+});
+
+test('prepare with invalid settings', async function() {
+  let core = new OfflineRenderer();
+
+  await core.initialize({numInputChannels: 0, numOutputChannels: 1, sampleRate: 44100, blockSize: 512});
+  await core.render(el.sr());
+
+  // Get past the fade-in
+  core.process([], [new Float32Array(512 * 10)]);
+
+  expect(() => core.prepare(0, 128)).toThrow();
+  expect(() => core.prepare(48000, 0)).toThrow();
+
+  // The graph carries on at the old settings
+  let outs = [new Float32Array(512)];
+
+  core.process([], outs);
+  expect(outs[0].every((x) => x === 44100)).toBe(true);
+});
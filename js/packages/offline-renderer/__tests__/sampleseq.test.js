@@ -102,3 +102,82 @@ test('sampleseq basics', async function() {
 
   expect(outs[0]).toMatchSnapshot();
 });
+
+test('sampleseq2 background seek', async function() {
+  let core = new OfflineRenderer();
+  let blockSize = 512;
+
+  await core.initialize({
+    numInputChannels: 2,
+    numOutputChannels: 3,
+    blockSize,
+    virtualFileSystem: {
+      '/v/sine': Float32Array.from({length: 48000}, (_, i) => Math.sin(i * 0.01)),
+    },
+  });
+
+  let props = {
+    path: '/v/sine',
+    duration: 48000,
+    seq: [{ time: 0, value: 1 }],
+  };
+
+  // Channel 0 carries the time we seek around in, channel 1 a time which runs
+  // straight into the seek target, for reference
+  core.render(
+    el.sampleseq2({...props, background: true}, el.in({channel: 0})),
+    el.sampleseq2({...props, background: false}, el.in({channel: 0})),
+    el.sampleseq2({...props, background: false}, el.in({channel: 1})),
+  );
+
+  let seekAt = 20;
+  let target = 20000;
+
+  let t = 0;
+  let ref = target - seekAt * blockSize;
+  let blocks = [];
+
+  for (let i = 0; i < seekAt + 10; ++i) {
+    if (i === seekAt)
+      t = target;
+
+    let inps = [
+      Float32Array.from({length: blockSize}, (_, j) => t + j),
+      Float32Array.from({length: blockSize}, (_, j) => ref + j),
+    ];
+
+    let outs = [new Float32Array(blockSize), new Float32Array(blockSize), new Float32Array(blockSize)];
+
+    core.process(inps, outs);
+    blocks.push(outs);
+
+    t += blockSize;
+    ref += blockSize;
+
+    // Give the worker, if there is one, time to render ahead as it would in
+    // realtime
+    await new Promise((resolve) => setTimeout(resolve, 2));
+  }
+
+  // Without thread support, as in this wasm build, the background node stretches
+  // inline and matches the inline node throughout. With a worker, the seek block
+  // fades out the audio lined up for the old time, ending in silence.
+  let [background, inline] = blocks[seekAt];
+
+  if (background.some((x, i) => x !== inline[i])) {
+    background.forEach((x, i) => {
+      expect(Math.abs(x)).toBeLessThanOrEqual(1 - (i + 1) / blockSize + 1e-6);
+    });
+  }
+
+  // Within a couple of blocks both nodes have re-anchored at the new time, and
+  // play exactly what a node which got there without seeking plays
+  for (let i = seekAt + 2; i < blocks.length; ++i) {
+    let [background, inline, reference] = blocks[i];
+
+    for (let j = 0; j < blockSize; ++j) {
+      expect(inline[j]).toBeCloseTo(reference[j], 5);
+      expect(background[j]).toBeCloseTo(reference[j], 5);
+    }
+  }
+});
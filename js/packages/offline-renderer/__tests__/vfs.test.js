@@ -33,6 +33,39 @@ test('vfs sample', async function() {
   expect(outs[0]).toMatchSnapshot();
 });
 
+test('vfs wavetable', async function() {
+  let core = new OfflineRenderer();
+
+  await core.initialize({
+    numInputChannels: 1,
+    numOutputChannels: 1,
+    virtualFileSystem: {
+      '/v/sine': Float32Array.from({length: 256}, (_, i) => Math.sin(2 * Math.PI * i / 256)),
+    },
+  });
+
+  // Graph
+  core.render(el.wavetable({path: '/v/sine'}, el.in({channel: 0})));
+
+  // Ten blocks of data
+  let inps = [new Float32Array(512 * 10)];
+  let outs = [new Float32Array(512 * 10)];
+
+  // Get past the fade-in
+  core.process(inps, outs);
+
+  // A single harmonic survives in every mip level, so whichever levels the read
+  // rate selects, we should read back the sine itself
+  inps = [Float32Array.from([0, 0.25, 0.5, 0.75, 1])];
+  outs = [new Float32Array(inps[0].length)];
+
+  core.process(inps, outs);
+
+  [0, 1, 0, -1, 0].forEach((v, i) => {
+    expect(outs[0][i]).toBeCloseTo(v, 4);
+  });
+});
+
 test('vfs list', async function() {
   let core = new OfflineRenderer();
 
@@ -86,3 +119,168 @@ test('vfs prune', async function() {
   core.pruneVirtualFileSystem();
   expect(core.listVirtualFileSystem()).toEqual(['three']);
 });
+
+test('vfs table interpolation', async function() {
+  let core = new OfflineRenderer();
+
+  await core.initialize({
+    numInputChannels: 1,
+    numOutputChannels: 3,
+    virtualFileSystem: {
+      '/v/ramp': Float32Array.from({length: 9}, (_, i) => i),
+    },
+  });
+
+  // Graph
+  core.render(
+    el.table({path: '/v/ramp', interpolation: 'linear'}, el.in({channel: 0})),
+    el.table({path: '/v/ramp', interpolation: 'hermite'}, el.in({channel: 0})),
+    el.table({path: '/v/ramp', interpolation: 'sinc'}, el.in({channel: 0})),
+  );
+
+  // Reads on and between the table points away from its ends, where every mode
+  // reproduces a straight line. The windowed sinc kernel only does so approximately.
+  let inps = [Float32Array.from([0.375, 0.4375, 0.5, 0.53125, 0.625])];
+  let outs = [0, 1, 2].map(() => new Float32Array(inps[0].length));
+
+  core.process(inps, outs);
+
+  expect(Array.from(outs[0])).toEqual([3, 3.5, 4, 4.25, 5]);
+  expect(Array.from(outs[1])).toEqual([3, 3.5, 4, 4.25, 5]);
+
+  outs[2].forEach((x, i) => expect(x).toBeCloseTo(outs[0][i], 2));
+});
+
+test('vfs convolve', async function() {
+  let ir = Float32Array.from({length: 100}, (_, i) => Math.sin(i) * Math.exp(-i / 40));
+  let core = new OfflineRenderer();
+
+  await core.initialize({
+    numInputChannels: 1,
+    numOutputChannels: 1,
+    virtualFileSystem: {
+      '/v/ir': ir,
+    },
+  });
+
+  // Small partitions, so that the impulse response spans both the head and the tail
+  core.render(el.convolve({path: '/v/ir', headSize: 16, tailSize: 32}, el.in({channel: 0})));
+
+  // Get past the fade-in
+  let inps = [new Float32Array(512 * 10)];
+  let outs = [new Float32Array(512 * 10)];
+
+  core.process(inps, outs);
+
+  // An impulse in should give us back the impulse response
+  inps = [Float32Array.from({length: 128}, (_, i) => i === 0 ? 1 : 0)];
+  outs = [new Float32Array(128)];
+
+  core.process(inps, outs);
+
+  outs[0].forEach((x, i) => expect(x).toBeCloseTo(i < ir.length ? ir[i] : 0, 4));
+});
+
+test('vfs convolve shared impulse response', async function() {
+  let ir = Float32Array.from({length: 100}, (_, i) => Math.sin(i) * Math.exp(-i / 40));
+  let core = new OfflineRenderer();
+
+  await core.initialize({
+    numInputChannels: 2,
+    numOutputChannels: 2,
+    virtualFileSystem: {
+      '/v/ir': ir,
+    },
+  });
+
+  // Two convolvers with the same impulse response and layout share its spectra,
+  // while each keeps its own input history
+  core.render(
+    el.convolve({path: '/v/ir', headSize: 16, tailSize: 32}, el.in({channel: 0})),
+    el.convolve({path: '/v/ir', headSize: 16, tailSize: 32}, el.in({channel: 1})),
+  );
+
+  // Get past the fade-in
+  let inps = [new Float32Array(512 * 10), new Float32Array(512 * 10)];
+  let outs = [new Float32Array(512 * 10), new Float32Array(512 * 10)];
+
+  core.process(inps, outs);
+
+  // Impulses at different times on each input should each give us back the
+  // impulse response from that time on
+  let expectImpulseResponses = (expected) => {
+    inps = [
+      Float32Array.from({length: 512}, (_, i) => i === 0 ? 1 : 0),
+      Float32Array.from({length: 512}, (_, i) => i === 7 ? 1 : 0),
+    ];
+    outs = [new Float32Array(512), new Float32Array(512)];
+
+    core.process(inps, outs);
+
+    outs[0].forEach((x, i) => expect(x).toBeCloseTo(i < expected.length ? expected[i] : 0, 4));
+    outs[1].forEach((x, i) => expect(x).toBeCloseTo(i >= 7 && i - 7 < expected.length ? expected[i - 7] : 0, 4));
+  };
+
+  expectImpulseResponses(ir);
+
+  // Replacing the impulse response reaches both convolvers
+  let ir2 = Float32Array.from({length: 60}, (_, i) => Math.cos(i) * Math.exp(-i / 20));
+  let result = core.updateVirtualFileSystem({'/v/ir': ir2}, {replaceExisting: true});
+
+  expect(result.success).toBe(true);
+
+  // Let the last responses ring out
+  inps = [new Float32Array(512), new Float32Array(512)];
+  outs = [new Float32Array(512), new Float32Array(512)];
+
+  core.process(inps, outs);
+
+  expectImpulseResponses(ir2);
+});
+
+test('vfs replace', async function() {
+  let core = new OfflineRenderer();
+
+  await core.initialize({
+    numInputChannels: 1,
+    numOutputChannels: 1,
+    virtualFileSystem: {
+      '/v/increment': Float32Array.from([1, 2, 3, 4, 5]),
+    },
+  });
+
+  core.render(el.table({path: '/v/increment'}, el.in({channel: 0})));
+
+  // Get past the fade-in
+  let inps = [new Float32Array(512 * 10)];
+  let outs = [new Float32Array(512 * 10)];
+
+  core.process(inps, outs);
+
+  inps = [Float32Array.from([0, 0.25, 0.5, 0.75, 1])];
+  outs = [new Float32Array(inps[0].length)];
+
+  core.process(inps, outs);
+  expect(Array.from(outs[0])).toEqual([1, 2, 3, 4, 5]);
+
+  // Swapping the contents under the same name reaches the running table without
+  // another render
+  let result = core.updateVirtualFileSystem({
+    '/v/increment': Float32Array.from([10, 20, 30, 40, 50]),
+  }, {replaceExisting: true});
+
+  expect(result.success).toBe(true);
+
+  core.process(inps, outs);
+  expect(Array.from(outs[0])).toEqual([10, 20, 30, 40, 50]);
+
+  // Without the option, an existing entry is left alone
+  result = core.updateVirtualFileSystem({
+    '/v/increment': Float32Array.from([0, 0, 0, 0, 0]),
+  });
+
+  expect(result.success).toBe(false);
+
+  core.process(inps, outs);
+  expect(Array.from(outs[0])).toEqual([10, 20, 30, 40, 50]);
+});
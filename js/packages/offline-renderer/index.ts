@@ -70,6 +70,19 @@ export default class OfflineRenderer extends EventEmitter {
     });
   }
 
+  // Moves the current graph to a new sample rate and block size, as a host would on
+  // a device change, without rebuilding it. Throws if the graph can't be prepared
+  // for the new settings, in which case it carries on with the old ones.
+  prepare(sampleRate: number, blockSize: number) {
+    const result = this._native.prepare(sampleRate, blockSize);
+
+    if (!result.success) {
+      throw new Error(result.message);
+    }
+
+    this._blockSize = blockSize;
+  }
+
   async render(...args) {
     const {result, ...stats} = await this._renderer.render(...args);
 
@@ -132,7 +145,11 @@ export default class OfflineRenderer extends EventEmitter {
     }
   }
 
-  updateVirtualFileSystem(vfs) {
+  // Adds the given entries to the virtual file system. By default an entry may not
+  // replace an existing one; with `replaceExisting: true`, existing entries are swapped
+  // for the new data in place and every node referencing them picks up the change
+  // without a re-render.
+  updateVirtualFileSystem(vfs, options = { replaceExisting: false }) {
     const valid = typeof vfs === 'object' && vfs !== null;
 
     invariant(valid, "Virtual file system must be an object mapping string type keys to Array<Float32Array> | Float32Array type values");
@@ -145,7 +162,9 @@ export default class OfflineRenderer extends EventEmitter {
     });
 
     for (let [key, val] of Object.entries(vfs)) {
-      let result = this._native.addSharedResource(key, val);
+      let result = options.replaceExisting
+        ? this._native.updateSharedResource(key, val)
+        : this._native.addSharedResource(key, val);
 
       if (!result.success) {
         return result;
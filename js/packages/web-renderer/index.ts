@@ -142,7 +142,11 @@ export default class WebRenderer extends EventEmitter {
     return Promise.resolve(stats);
   }
 
-  async updateVirtualFileSystem(vfs) {
+  // Adds the given entries to the virtual file system. By default an entry may not
+  // replace an existing one; with `replaceExisting: true`, existing entries are swapped
+  // for the new data in place and every node referencing them picks up the change
+  // without a re-render.
+  async updateVirtualFileSystem(vfs, options = { replaceExisting: false }) {
     const valid = typeof vfs === 'object' && vfs !== null;
 
     invariant(valid, "Virtual file system must be an object mapping string type keys to Array<Float32Array> | Float32Array type values");
@@ -156,6 +160,7 @@ export default class WebRenderer extends EventEmitter {
 
     return await this._sendWorkletRequest('updateSharedResourceMap', {
       resources: vfs,
+      replaceExisting: !!options.replaceExisting,
     });
   }
 
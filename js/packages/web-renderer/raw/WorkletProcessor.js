@@ -91,7 +91,9 @@ class ElementaryAudioWorkletProcessor extends AudioWorkletProcessor {
           }]);
         case 'updateSharedResourceMap':
           for (let [key, val] of Object.entries(payload.resources)) {
-            let result = this._native.addSharedResource(key, val);
+            let result = payload.replaceExisting
+              ? this._native.updateSharedResource(key, val)
+              : this._native.addSharedResource(key, val);
 
             if (!result.success) {
               return this.port.postMessage(['reply', {
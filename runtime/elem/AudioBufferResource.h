@@ -1,5 +1,6 @@
 #pragma once
 
+#include <type_traits>
 #include <vector>
 #include "SharedResource.h"
 #include "Types.h"
@@ -8,37 +9,90 @@
 namespace elem
 {
 
-    class AudioBufferResource : public SharedResource {
+    // A SharedResource holding multichannel audio data in the given sample format.
+    //
+    // Resources storing doubles expose that data natively through `getChannelDataDouble`
+    // so that a Runtime<double> can read them without converting every sample. Because
+    // every SharedResource must also answer `getChannelData`, the double variant keeps
+    // a float copy of its data alongside, taken at construction time. Writes made
+    // through the double view afterwards (as with feedback tap buffers) are not
+    // reflected in that copy.
+    //
+    // In practice the double variant only holds the tap lines and rate-matched sample
+    // copies of a Runtime<double>, and the nodes reading those go through
+    // `visitChannelData` or `getChannelDataAs`. Nodes which only read float data, such
+    // as convolve and sampleseq, would see a tap line as it was when it was created.
+    template <typename SampleType>
+    class BasicAudioBufferResource : public SharedResource {
+        static_assert(std::is_same_v<SampleType, float> || std::is_same_v<SampleType, double>,
+            "BasicAudioBufferResource supports float and double sample data");
+
     public:
-        AudioBufferResource(float* data, size_t numSamples)
+        BasicAudioBufferResource(SampleType* data, size_t numSamples, double _sampleRate = 0)
+            : sampleRate(_sampleRate)
         {
-            channels.push_back(std::vector<float>(data, data + numSamples));
+            channels.push_back(std::vector<SampleType>(data, data + numSamples));
+            updateFloatMirror();
         }
 
-        AudioBufferResource(float** data, size_t numChannels, size_t numSamples)
+        BasicAudioBufferResource(SampleType** data, size_t numChannels, size_t numSamples, double _sampleRate = 0)
+            : sampleRate(_sampleRate)
         {
             for (size_t i = 0; i < numChannels; ++i) {
-                channels.push_back(std::vector<float>(data[i], data[i] + numSamples));
+                channels.push_back(std::vector<SampleType>(data[i], data[i] + numSamples));
             }
+
+            updateFloatMirror();
+        }
+
+        // Takes ownership of already deinterleaved channel data. Each channel is
+        // expected to hold the same number of samples.
+        explicit BasicAudioBufferResource(std::vector<std::vector<SampleType>>&& data, double _sampleRate = 0)
+            : channels(std::move(data))
+            , sampleRate(_sampleRate)
+        {
+            updateFloatMirror();
         }
 
-        AudioBufferResource(size_t numChannels, size_t numSamples)
+        BasicAudioBufferResource(size_t numChannels, size_t numSamples)
         {
             for (size_t i = 0; i < numChannels; ++i) {
-                channels.push_back(std::vector<float>(numSamples));
+                channels.push_back(std::vector<SampleType>(numSamples));
             }
+
+            updateFloatMirror();
         }
 
         BufferView<float> getChannelData(size_t channelIndex) override
         {
-            if (channelIndex < channels.size()) {
-                auto& chan = channels[channelIndex];
+            auto& source = [this]() -> std::vector<std::vector<float>>& {
+                if constexpr (std::is_same_v<SampleType, float>) {
+                    return channels;
+                } else {
+                    return floatMirror;
+                }
+            }();
+
+            if (channelIndex < source.size()) {
+                auto& chan = source[channelIndex];
                 return BufferView<float>(chan.data(), chan.size());
             }
 
             return BufferView<float>(nullptr, 0);
         }
 
+        BufferView<double> getChannelDataDouble(size_t channelIndex) override
+        {
+            if constexpr (std::is_same_v<SampleType, double>) {
+                if (channelIndex < channels.size()) {
+                    auto& chan = channels[channelIndex];
+                    return BufferView<double>(chan.data(), chan.size());
+                }
+            }
+
+            return BufferView<double>(nullptr, 0);
+        }
+
         size_t numChannels() override {
             return channels.size();
         }
@@ -51,9 +105,30 @@ namespace elem
             return 0;
         }
 
+        double getSampleRate() override {
+            return sampleRate;
+        }
+
     private:
+        void updateFloatMirror()
+        {
+            if constexpr (std::is_same_v<SampleType, double>) {
+                floatMirror.resize(channels.size());
+
+                for (size_t i = 0; i < channels.size(); ++i) {
+                    floatMirror[i].assign(channels[i].begin(), channels[i].end());
+                }
+            }
+        }
+
         // TODO: make this one contiguous chunk of data
-        std::vector<std::vector<float>> channels;
+        std::vector<std::vector<SampleType>> channels;
+        std::vector<std::vector<float>> floatMirror;
+        double sampleRate = 0;
     };
 
+    //==============================================================================
+    // The default resource type, holding float sample data
+    using AudioBufferResource = BasicAudioBufferResource<float>;
+
 } // namespace elem
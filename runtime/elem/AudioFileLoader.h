@@ -0,0 +1,457 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "AudioBufferResource.h"
+#include "SharedResource.h"
+#include "ThreadPool.h"
+
+#include "builtins/helpers/Resampler.h"
+
+
+namespace elem
+{
+
+    //==============================================================================
+    // Sample encodings understood by the audio file decoder
+    enum class PCMSampleFormat {
+        Int8 = 0,
+        UInt8 = 1,
+        Int16 = 2,
+        Int24 = 3,
+        Int32 = 4,
+        Float32 = 5,
+        Float64 = 6,
+    };
+
+    // Describes the layout of a headerless PCM file
+    struct RawPCMFormat {
+        size_t numChannels = 1;
+        double sampleRate = 44100.0;
+        PCMSampleFormat sampleFormat = PCMSampleFormat::Int16;
+        bool bigEndian = false;
+
+        // Number of leading bytes to skip before the sample data begins
+        size_t headerBytes = 0;
+    };
+
+    struct AudioFileLoadOptions {
+        // When true, decoded audio at a sample rate other than the runtime's is
+        // converted to the runtime sample rate before being registered.
+        bool resampleToRuntimeRate = true;
+
+        // When provided, the file is read as headerless PCM data in this format
+        // rather than being parsed as a WAV or AIFF file.
+        std::optional<RawPCMFormat> raw;
+    };
+
+    // The result of decoding an audio file: deinterleaved float channel data
+    // alongside the file's sample rate.
+    struct DecodedAudioFile {
+        double sampleRate = 0;
+        std::vector<std::vector<float>> channels;
+    };
+
+    //==============================================================================
+    namespace detail
+    {
+        inline uint32_t readUInt(uint8_t const* p, size_t numBytes, bool bigEndian)
+        {
+            uint32_t v = 0;
+
+            for (size_t i = 0; i < numBytes; ++i) {
+                auto const shift = bigEndian ? (8 * (numBytes - 1 - i)) : (8 * i);
+                v |= static_cast<uint32_t>(p[i]) << shift;
+            }
+
+            return v;
+        }
+
+        inline size_t bytesPerSample(PCMSampleFormat format)
+        {
+            switch (format) {
+                case PCMSampleFormat::Int8:
+                case PCMSampleFormat::UInt8:
+                    return 1;
+                case PCMSampleFormat::Int16:
+                    return 2;
+                case PCMSampleFormat::Int24:
+                    return 3;
+                case PCMSampleFormat::Int32:
+                case PCMSampleFormat::Float32:
+                    return 4;
+                case PCMSampleFormat::Float64:
+                    return 8;
+                default:
+                    return 0;
+            }
+        }
+
+        inline float decodeSample(uint8_t const* p, PCMSampleFormat format, bool bigEndian)
+        {
+            switch (format) {
+                case PCMSampleFormat::Int8:
+                    return static_cast<float>(static_cast<int8_t>(p[0])) / 128.0f;
+                case PCMSampleFormat::UInt8:
+                    return (static_cast<float>(p[0]) - 128.0f) / 128.0f;
+                case PCMSampleFormat::Int16:
+                    return static_cast<float>(static_cast<int16_t>(readUInt(p, 2, bigEndian))) / 32768.0f;
+                case PCMSampleFormat::Int24: {
+                    // Shift up into the top of a 32-bit word to pick up the sign bit
+                    auto const v = static_cast<int32_t>(readUInt(p, 3, bigEndian) << 8);
+                    return static_cast<float>(static_cast<double>(v) / 2147483648.0);
+                }
+                case PCMSampleFormat::Int32:
+                    return static_cast<float>(static_cast<double>(static_cast<int32_t>(readUInt(p, 4, bigEndian))) / 2147483648.0);
+                case PCMSampleFormat::Float32: {
+                    auto const bits = readUInt(p, 4, bigEndian);
+                    float v;
+                    std::memcpy(&v, &bits, sizeof(float));
+                    return v;
+                }
+                case PCMSampleFormat::Float64: {
+                    auto const lo = static_cast<uint64_t>(readUInt(bigEndian ? p + 4 : p, 4, bigEndian));
+                    auto const hi = static_cast<uint64_t>(readUInt(bigEndian ? p : p + 4, 4, bigEndian));
+                    auto const bits = (hi << 32) | lo;
+                    double v;
+                    std::memcpy(&v, &bits, sizeof(double));
+                    return static_cast<float>(v);
+                }
+                default:
+                    return 0.0f;
+            }
+        }
+
+        // Deinterleaves and converts a block of PCM frames into the result channels
+        inline std::string decodeInterleaved(uint8_t const* data, size_t numBytes, size_t numChannels, PCMSampleFormat format, bool bigEndian, DecodedAudioFile& result)
+        {
+            auto const sampleBytes = bytesPerSample(format);
+
+            if (numChannels == 0 || sampleBytes == 0)
+                return "Invalid channel count or sample format";
+
+            auto const frameBytes = sampleBytes * numChannels;
+            auto const numFrames = numBytes / frameBytes;
+
+            result.channels.assign(numChannels, std::vector<float>(numFrames));
+
+            for (size_t i = 0; i < numFrames; ++i) {
+                for (size_t j = 0; j < numChannels; ++j) {
+                    result.channels[j][i] = decodeSample(data + i * frameBytes + j * sampleBytes, format, bigEndian);
+                }
+            }
+
+            return "";
+        }
+
+        // Converts an 80-bit IEEE 754 extended precision number, as used for the
+        // AIFF sample rate field, to a double
+        inline double readExtended(uint8_t const* p)
+        {
+            auto const exponent = static_cast<int>(((p[0] & 0x7f) << 8) | p[1]);
+            auto const mantissaHi = readUInt(p + 2, 4, true);
+            auto const mantissaLo = readUInt(p + 6, 4, true);
+
+            if (exponent == 0 && mantissaHi == 0 && mantissaLo == 0)
+                return 0.0;
+
+            auto const mantissa = static_cast<double>(mantissaHi) * 4294967296.0 + static_cast<double>(mantissaLo);
+            auto const value = std::ldexp(mantissa, exponent - 16383 - 63);
+
+            return (p[0] & 0x80) ? -value : value;
+        }
+
+        inline std::string decodeWav(std::vector<uint8_t> const& bytes, DecodedAudioFile& result)
+        {
+            size_t numChannels = 0;
+            size_t bitsPerSample = 0;
+            uint32_t formatTag = 0;
+            bool hasFormat = false;
+
+            size_t pos = 12;
+
+            while (pos + 8 <= bytes.size()) {
+                auto const* chunk = bytes.data() + pos;
+                auto const chunkSize = static_cast<size_t>(readUInt(chunk + 4, 4, false));
+                auto const available = std::min(chunkSize, bytes.size() - (pos + 8));
+
+                if (std::memcmp(chunk, "fmt ", 4) == 0) {
+                    if (available < 16)
+                        return "Malformed WAV fmt chunk";
+
+                    formatTag = readUInt(chunk + 8, 2, false);
+                    numChannels = readUInt(chunk + 10, 2, false);
+                    result.sampleRate = static_cast<double>(readUInt(chunk + 12, 4, false));
+                    bitsPerSample = readUInt(chunk + 22, 2, false);
+
+                    // WAVE_FORMAT_EXTENSIBLE carries the actual format code at the start
+                    // of its sub format GUID
+                    if (formatTag == 0xFFFE) {
+                        if (available < 26)
+                            return "Malformed WAV fmt chunk";
+
+                        formatTag = readUInt(chunk + 32, 2, false);
+                    }
+
+                    hasFormat = true;
+                }
+
+                if (std::memcmp(chunk, "data", 4) == 0) {
+                    if (!hasFormat)
+                        return "WAV data chunk precedes fmt chunk";
+
+                    auto format = PCMSampleFormat::Int16;
+
+                    if (formatTag == 1) {
+                        switch (bitsPerSample) {
+                            case 8: format = PCMSampleFormat::UInt8; break;
+                            case 16: format = PCMSampleFormat::Int16; break;
+                            case 24: format = PCMSampleFormat::Int24; break;
+                            case 32: format = PCMSampleFormat::Int32; break;
+                            default: return "Unsupported WAV bit depth";
+                        }
+                    } else if (formatTag == 3) {
+                        switch (bitsPerSample) {
+                            case 32: format = PCMSampleFormat::Float32; break;
+                            case 64: format = PCMSampleFormat::Float64; break;
+                            default: return "Unsupported WAV bit depth";
+                        }
+                    } else {
+                        return "Unsupported WAV encoding";
+                    }
+
+                    return decodeInterleaved(chunk + 8, available, numChannels, format, false, result);
+                }
+
+                // Chunks are padded to an even number of bytes
+                pos += 8 + chunkSize + (chunkSize & 1);
+            }
+
+            return "WAV file has no data chunk";
+        }
+
+        inline std::string decodeAiff(std::vector<uint8_t> const& bytes, DecodedAudioFile& result)
+        {
+            bool const isCompressed = std::memcmp(bytes.data() + 8, "AIFC", 4) == 0;
+
+            size_t numChannels = 0;
+            size_t sampleSize = 0;
+            bool bigEndian = true;
+            bool isFloat = false;
+            bool hasFormat = false;
+
+            size_t pos = 12;
+
+            while (pos + 8 <= bytes.size()) {
+                auto const* chunk = bytes.data() + pos;
+                auto const chunkSize = static_cast<size_t>(readUInt(chunk + 4, 4, true));
+                auto const available = std::min(chunkSize, bytes.size() - (pos + 8));
+
+                if (std::memcmp(chunk, "COMM", 4) == 0) {
+                    if (available < 18 || (isCompressed && available < 22))
+                        return "Malformed AIFF COMM chunk";
+
+                    numChannels = readUInt(chunk + 8, 2, true);
+                    sampleSize = readUInt(chunk + 14, 2, true);
+                    result.sampleRate = readExtended(chunk + 16);
+
+                    if (isCompressed) {
+                        auto const* type = chunk + 26;
+
+                        if (std::memcmp(type, "sowt", 4) == 0) {
+                            bigEndian = false;
+                        } else if (std::memcmp(type, "fl32", 4) == 0 || std::memcmp(type, "FL32", 4) == 0) {
+                            isFloat = true;
+                            sampleSize = 32;
+                        } else if (std::memcmp(type, "fl64", 4) == 0 || std::memcmp(type, "FL64", 4) == 0) {
+                            isFloat = true;
+                            sampleSize = 64;
+                        } else if (std::memcmp(type, "NONE", 4) != 0 && std::memcmp(type, "twos", 4) != 0) {
+                            return "Unsupported AIFC compression type";
+                        }
+                    }
+
+                    hasFormat = true;
+                }
+
+                if (std::memcmp(chunk, "SSND", 4) == 0) {
+                    if (!hasFormat)
+                        return "AIFF SSND chunk precedes COMM chunk";
+
+                    if (available < 8)
+                        return "Malformed AIFF SSND chunk";
+
+                    auto const offset = static_cast<size_t>(readUInt(chunk + 8, 4, true));
+
+                    if (offset + 8 > available)
+                        return "Malformed AIFF SSND chunk";
+
+                    auto format = PCMSampleFormat::Int16;
+
+                    if (isFloat) {
+                        format = (sampleSize == 64) ? PCMSampleFormat::Float64 : PCMSampleFormat::Float32;
+                    } else {
+                        switch (sampleSize) {
+                            case 8: format = PCMSampleFormat::Int8; break;
+                            case 16: format = PCMSampleFormat::Int16; break;
+                            case 24: format = PCMSampleFormat::Int24; break;
+                            case 32: format = PCMSampleFormat::Int32; break;
+                            default: return "Unsupported AIFF bit depth";
+                        }
+                    }
+
+                    return decodeInterleaved(chunk + 16 + offset, available - 8 - offset, numChannels, format, bigEndian, result);
+                }
+
+                pos += 8 + chunkSize + (chunkSize & 1);
+            }
+
+            return "AIFF file has no SSND chunk";
+        }
+    }
+
+    //==============================================================================
+    // Decodes the audio file at the given path.
+    //
+    // WAV (PCM and IEEE float, including WAVE_FORMAT_EXTENSIBLE) and AIFF/AIFC files are
+    // recognized by their headers. If a raw format is provided, the file is instead read
+    // as headerless PCM data. Returns an empty string on success, or a description of
+    // the failure otherwise.
+    inline std::string decodeAudioFile(std::string const& filePath, DecodedAudioFile& result, std::optional<RawPCMFormat> const& raw = std::nullopt)
+    {
+        std::ifstream file(filePath, std::ios::binary | std::ios::ate);
+
+        if (!file)
+            return "Failed to open file: " + filePath;
+
+        auto const size = static_cast<size_t>(file.tellg());
+        std::vector<uint8_t> bytes(size);
+
+        file.seekg(0);
+
+        if (!file.read(reinterpret_cast<char*>(bytes.data()), static_cast<std::streamsize>(size)))
+            return "Failed to read file: " + filePath;
+
+        if (raw.has_value()) {
+            if (raw->headerBytes > bytes.size())
+                return "Raw PCM header exceeds file length";
+
+            result.sampleRate = raw->sampleRate;
+            return detail::decodeInterleaved(bytes.data() + raw->headerBytes, bytes.size() - raw->headerBytes, raw->numChannels, raw->sampleFormat, raw->bigEndian, result);
+        }
+
+        if (bytes.size() >= 12 && std::memcmp(bytes.data(), "RIFF", 4) == 0 && std::memcmp(bytes.data() + 8, "WAVE", 4) == 0)
+            return detail::decodeWav(bytes, result);
+
+        if (bytes.size() >= 12 && std::memcmp(bytes.data(), "FORM", 4) == 0
+            && (std::memcmp(bytes.data() + 8, "AIFF", 4) == 0 || std::memcmp(bytes.data() + 8, "AIFC", 4) == 0))
+            return detail::decodeAiff(bytes, result);
+
+        return "Unrecognized audio file format: " + filePath;
+    }
+
+    //==============================================================================
+    // Decodes audio files into shared resources on a pool of background threads.
+    //
+    // Each call to `load` schedules a job which reads, decodes, and optionally resamples
+    // a file, then parks the finished resource in a completion list. Nothing is written
+    // to a SharedResourceMap from the worker threads; instead the owner periodically
+    // drains the completion list from its own (non-realtime) thread and registers the
+    // resources there. This keeps the SharedResourceMap single-threaded.
+    class AudioFileLoader
+    {
+    public:
+        //==============================================================================
+        struct Result {
+            std::string name;
+            std::string filePath;
+            SharedResourcePtr resource;
+            std::string error;
+        };
+
+        // A value of 0 for numThreads picks the hardware concurrency of the host machine.
+        // No threads are started until the first call to `load`.
+        explicit AudioFileLoader(size_t numThreads = 0)
+            : pool(numThreads)
+        {}
+
+        //==============================================================================
+        // Schedules the given file for decoding.
+        //
+        // If targetSampleRate is greater than zero and the options request it, the decoded
+        // audio is resampled to the target rate on the worker thread.
+        void load(std::string const& name, std::string const& filePath, double targetSampleRate, AudioFileLoadOptions const& options)
+        {
+            pool.enqueue([=]() {
+                DecodedAudioFile decoded;
+                Result result { name, filePath, nullptr, decodeAudioFile(filePath, decoded, options.raw) };
+
+                if (result.error.empty() && (decoded.channels.empty() || decoded.channels[0].empty()))
+                    result.error = "Audio file contains no sample data: " + filePath;
+
+                if (result.error.empty()) {
+                    auto const shouldResample = options.resampleToRuntimeRate
+                        && targetSampleRate > 0.0
+                        && decoded.sampleRate > 0.0
+                        && std::abs(decoded.sampleRate - targetSampleRate) > 1e-6;
+
+                    if (shouldResample) {
+                        SincResampler resampler(decoded.sampleRate, targetSampleRate);
+
+                        for (auto& channel : decoded.channels) {
+                            channel = resampler.process(channel);
+                        }
+
+                        decoded.sampleRate = targetSampleRate;
+                    }
+
+                    result.resource = std::make_shared<AudioBufferResource>(std::move(decoded.channels), decoded.sampleRate);
+                }
+
+                std::lock_guard<std::mutex> guard(lock);
+                completed.push_back(std::move(result));
+            });
+        }
+
+        // Invokes the callback with each load that has finished since the last call,
+        // successfully or otherwise, in order of completion.
+        template <typename Fn>
+        void drainCompleted(Fn&& fn)
+        {
+            std::vector<Result> finished;
+
+            {
+                std::lock_guard<std::mutex> guard(lock);
+                std::swap(finished, completed);
+            }
+
+            for (auto& result : finished) {
+                fn(result);
+            }
+        }
+
+        // Returns the number of loads which have been scheduled but not yet completed
+        size_t numPendingLoads()
+        {
+            return pool.numPendingJobs();
+        }
+
+    private:
+        //==============================================================================
+        std::mutex lock;
+        std::vector<Result> completed;
+
+        // Declared last so that it is destroyed first, joining any in-flight jobs
+        // before the completion list goes away.
+        ThreadPool pool;
+    };
+
+} // namespace elem
@@ -0,0 +1,170 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+
+namespace elem
+{
+
+    //==============================================================================
+    // A single worker thread which runs one fixed job whenever the realtime thread
+    // asks it to.
+    //
+    // This is the counterpart to ThreadPool for work which the realtime thread hands
+    // off at a steady rate and collects again a little later, such as the long tail
+    // partitions of a convolution. Triggering the job never blocks or allocates. The
+    // realtime thread checks `isIdle` before collecting the result, and decides for
+    // itself what to do if the worker has fallen behind.
+    //
+    // The worker sleeps on a condition variable between jobs. Waking it reliably means
+    // notifying while it isn't between checking for work and going to sleep, which the
+    // realtime thread can only try for without blocking; if that attempt fails it is
+    // repeated by `retryWake`, which the realtime thread calls once per block.
+    //
+    // The thread is started at construction, which must therefore happen off the
+    // realtime thread, and in an environment with thread support.
+    class BackgroundWorker
+    {
+    public:
+        //==============================================================================
+        explicit BackgroundWorker(std::function<void()>&& job);
+
+        // Returns false for builds which can't start a thread at all, such as wasm
+        // builds without pthreads. Those can't catch the exception std::thread throws
+        // to say so either, so callers check here first.
+        static constexpr bool isSupported()
+        {
+#if defined(__EMSCRIPTEN__) && !defined(__EMSCRIPTEN_PTHREADS__)
+            return false;
+#else
+            return true;
+#endif
+        }
+
+        // Waits for a running job to finish before joining the worker thread
+        ~BackgroundWorker();
+
+        BackgroundWorker(BackgroundWorker const&) = delete;
+        BackgroundWorker& operator= (BackgroundWorker const&) = delete;
+
+        //==============================================================================
+        // Asks the worker to run the job once. Must only be called while the worker
+        // is idle.
+        void trigger();
+
+        // Wakes the worker if the last trigger couldn't. Cheap when there's nothing to
+        // retry, and never blocks.
+        void retryWake();
+
+        // Returns true if there is no triggered job still waiting or running
+        bool isIdle() const;
+
+        // Blocks until the most recently triggered job has finished. Must be called
+        // off the realtime thread.
+        void waitUntilIdle();
+
+    private:
+        //==============================================================================
+        void wake();
+        void run();
+
+        std::function<void()> job;
+
+        std::atomic<bool> pending { false };
+        std::atomic<bool> wakeMissed { false };
+        std::atomic<bool> shouldExit { false };
+
+        std::mutex lock;
+        std::condition_variable cv;
+        std::thread thread;
+    };
+
+    //==============================================================================
+    // Details...
+    inline BackgroundWorker::BackgroundWorker(std::function<void()>&& _job)
+        : job(std::move(_job))
+    {
+        thread = std::thread([this]() { run(); });
+    }
+
+    inline BackgroundWorker::~BackgroundWorker()
+    {
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            shouldExit.store(true);
+        }
+
+        cv.notify_one();
+
+        if (thread.joinable()) {
+            thread.join();
+        }
+    }
+
+    inline void BackgroundWorker::trigger()
+    {
+        pending.store(true, std::memory_order_release);
+        wake();
+    }
+
+    inline void BackgroundWorker::retryWake()
+    {
+        if (wakeMissed.load(std::memory_order_relaxed))
+            wake();
+    }
+
+    inline void BackgroundWorker::wake()
+    {
+        // The worker only holds the lock from checking for work until it's asleep. If we
+        // can take the lock after raising the flag, the worker will either see the flag
+        // when it next checks or is already asleep and gets the notification. If we
+        // can't, it may be about to sleep through this trigger, so we try again later.
+        if (lock.try_lock()) {
+            lock.unlock();
+            wakeMissed.store(false, std::memory_order_relaxed);
+            cv.notify_one();
+            return;
+        }
+
+        wakeMissed.store(true, std::memory_order_relaxed);
+    }
+
+    inline bool BackgroundWorker::isIdle() const
+    {
+        return !pending.load(std::memory_order_acquire);
+    }
+
+    inline void BackgroundWorker::waitUntilIdle()
+    {
+        while (pending.load(std::memory_order_acquire)) {
+            retryWake();
+            std::this_thread::yield();
+        }
+    }
+
+    inline void BackgroundWorker::run()
+    {
+        while (true) {
+            {
+                std::unique_lock<std::mutex> guard(lock);
+
+                cv.wait(guard, [this]() {
+                    return shouldExit.load() || pending.load(std::memory_order_acquire);
+                });
+            }
+
+            if (shouldExit.load())
+                return;
+
+            if (pending.load(std::memory_order_acquire)) {
+                job();
+                pending.store(false, std::memory_order_release);
+            }
+        }
+    }
+
+} // namespace elem
@@ -3,10 +3,16 @@
 #include <cmath>
 
 #include "builtins/Analyzers.h"
+#include "builtins/Convolution.h"
 #include "builtins/Core.h"
+#include "builtins/Decimate.h"
 #include "builtins/Delays.h"
+#include "builtins/Dynamics.h"
+#include "builtins/Envelopes.h"
+#include "builtins/FDN.h"
 #include "builtins/Feedback.h"
 #include "builtins/Filters.h"
+#include "builtins/filters/BiquadBank.h"
 #include "builtins/filters/MultiMode1p.h"
 #include "builtins/filters/SVF.h"
 #include "builtins/filters/SVFShelf.h"
@@ -14,13 +20,18 @@
 #include "builtins/Math.h"
 #include "builtins/Oscillators.h"
 #include "builtins/Noise.h"
+#include "builtins/Oversample.h"
 #include "builtins/Sample.h"
 #include "builtins/SampleSeq.h"
 #include "builtins/Seq2.h"
 #include "builtins/SparSeq.h"
 #include "builtins/SparSeq2.h"
+#include "builtins/STFT.h"
 #include "builtins/Table.h"
+#include "builtins/Voices.h"
+#include "builtins/Wavetable.h"
 #include "builtins/mc/Capture.h"
+#include "builtins/mc/Oscillators.h"
 #include "builtins/mc/Sample.h"
 #include "builtins/mc/SampleSeq.h"
 #include "builtins/mc/Table.h"
@@ -51,19 +62,19 @@ namespace elem
 
             // Unary math nodes
             callback("in",              GenericNodeFactory<IdentityNode<FloatType>>());
-            callback("sin",             GenericNodeFactory<UnaryOperationNode<FloatType, std::sin>>());
-            callback("cos",             GenericNodeFactory<UnaryOperationNode<FloatType, std::cos>>());
-            callback("tan",             GenericNodeFactory<UnaryOperationNode<FloatType, std::tan>>());
-            callback("tanh",            GenericNodeFactory<UnaryOperationNode<FloatType, std::tanh>>());
+            callback("sin",             GenericNodeFactory<UnaryOperationNode<FloatType, std::sin, simd::Sin>>());
+            callback("cos",             GenericNodeFactory<UnaryOperationNode<FloatType, std::cos, simd::Cos>>());
+            callback("tan",             GenericNodeFactory<UnaryOperationNode<FloatType, std::tan, simd::Tan>>());
+            callback("tanh",            GenericNodeFactory<UnaryOperationNode<FloatType, std::tanh, simd::Tanh>>());
             callback("asinh",           GenericNodeFactory<UnaryOperationNode<FloatType, std::asinh>>());
-            callback("ln",              GenericNodeFactory<UnaryOperationNode<FloatType, std::log>>());
-            callback("log",             GenericNodeFactory<UnaryOperationNode<FloatType, std::log10>>());
-            callback("log2",            GenericNodeFactory<UnaryOperationNode<FloatType, std::log2>>());
+            callback("ln",              GenericNodeFactory<UnaryOperationNode<FloatType, std::log, simd::Log>>());
+            callback("log",             GenericNodeFactory<UnaryOperationNode<FloatType, std::log10, simd::Log10>>());
+            callback("log2",            GenericNodeFactory<UnaryOperationNode<FloatType, std::log2, simd::Log2>>());
             callback("ceil",            GenericNodeFactory<UnaryOperationNode<FloatType, std::ceil>>());
             callback("floor",           GenericNodeFactory<UnaryOperationNode<FloatType, std::floor>>());
             callback("round",           GenericNodeFactory<UnaryOperationNode<FloatType, std::round>>());
             callback("sqrt",            GenericNodeFactory<UnaryOperationNode<FloatType, std::sqrt>>());
-            callback("exp",             GenericNodeFactory<UnaryOperationNode<FloatType, std::exp>>());
+            callback("exp",             GenericNodeFactory<UnaryOperationNode<FloatType, std::exp, simd::Exp>>());
             callback("abs",             GenericNodeFactory<UnaryOperationNode<FloatType, std::abs>>());
 
             // Binary math nodes
@@ -77,13 +88,13 @@ namespace elem
             callback("or",              GenericNodeFactory<BinaryOperationNode<FloatType, BinaryOr<FloatType>>>());
 
             // Reducing nodes
-            callback("add",             GenericNodeFactory<BinaryReducingNode<FloatType, std::plus<FloatType>>>());
+            callback("add",             GenericNodeFactory<BinaryReducingNode<FloatType, std::plus<FloatType>, simd::Add>>());
             callback("sub",             GenericNodeFactory<BinaryReducingNode<FloatType, std::minus<FloatType>>>());
-            callback("mul",             GenericNodeFactory<BinaryReducingNode<FloatType, std::multiplies<FloatType>>>());
+            callback("mul",             GenericNodeFactory<BinaryReducingNode<FloatType, std::multiplies<FloatType>, simd::Mul>>());
             callback("div",             GenericNodeFactory<BinaryReducingNode<FloatType, SafeDivides<FloatType>>>());
             callback("mod",             GenericNodeFactory<BinaryReducingNode<FloatType, Modulus<FloatType>>>());
-            callback("min",             GenericNodeFactory<BinaryReducingNode<FloatType, Min<FloatType>>>());
-            callback("max",             GenericNodeFactory<BinaryReducingNode<FloatType, Max<FloatType>>>());
+            callback("min",             GenericNodeFactory<BinaryReducingNode<FloatType, Min<FloatType>, simd::Min>>());
+            callback("max",             GenericNodeFactory<BinaryReducingNode<FloatType, Max<FloatType>, simd::Max>>());
 
             // Core nodes
             callback("root",            GenericNodeFactory<RootNode<FloatType>>());
@@ -101,6 +112,7 @@ namespace elem
             callback("maxhold",         GenericNodeFactory<MaxHold<FloatType>>());
             callback("once",            GenericNodeFactory<OnceNode<FloatType>>());
             callback("rand",            GenericNodeFactory<UniformRandomNoiseNode<FloatType>>());
+            callback("noise",           GenericNodeFactory<NoiseNode<FloatType>>());
 
             // Delay nodes
             callback("delay",           GenericNodeFactory<VariableDelayNode<FloatType>>());
@@ -110,7 +122,9 @@ namespace elem
             // Filter nodes
             callback("pole",            GenericNodeFactory<OnePoleNode<FloatType>>());
             callback("env",             GenericNodeFactory<EnvelopeNode<FloatType>>());
+            callback("adsr",            GenericNodeFactory<ADSRNode<FloatType>>());
             callback("biquad",          GenericNodeFactory<BiquadFilterNode<FloatType>>());
+            callback("biquadbank",      GenericNodeFactory<BiquadBankNode<FloatType>>());
             callback("prewarp",         GenericNodeFactory<CutoffPrewarpNode<FloatType>>());
             callback("mm1p",            GenericNodeFactory<MultiMode1p<FloatType>>());
             callback("svf",             GenericNodeFactory<StateVariableFilterNode<FloatType>>());
@@ -125,11 +139,26 @@ namespace elem
             callback("sampleseq",       GenericNodeFactory<SampleSeqNode<FloatType>>());
             callback("sampleseq2",      GenericNodeFactory<SampleSeqWithStretchNode<FloatType>>());
             callback("table",           GenericNodeFactory<TableNode<FloatType>>());
+            callback("wavetable",       GenericNodeFactory<WavetableNode<FloatType>>());
+            callback("convolve",        GenericNodeFactory<ConvolutionNode<FloatType>>());
+            callback("mc.biquadbank",   GenericNodeFactory<BiquadBankNode<FloatType>>());
+            callback("mc.blepsaw",      GenericNodeFactory<MCPolyBlepOscillatorNode<FloatType, detail::BlepMode::Saw>>());
+            callback("mc.blepsquare",   GenericNodeFactory<MCPolyBlepOscillatorNode<FloatType, detail::BlepMode::Square>>());
+            callback("mc.bleptriangle", GenericNodeFactory<MCPolyBlepOscillatorNode<FloatType, detail::BlepMode::Triangle>>());
             callback("mc.capture",      GenericNodeFactory<MCCaptureNode<FloatType>>());
+            callback("mc.dynamics",     GenericNodeFactory<DynamicsNode<FloatType>>());
+            callback("mc.fdn",          GenericNodeFactory<FDNNode<FloatType>>());
+            callback("mc.multitap",     GenericNodeFactory<MultiTapDelayNode<FloatType>>());
+            callback("mc.voices",       GenericNodeFactory<VoicesNode<FloatType>>());
+            callback("mc.oversample",   GenericNodeFactory<OversampleNode<FloatType>>());
+            callback("mc.decimate",     GenericNodeFactory<DecimateNode<FloatType>>());
+            callback("mc.noise",        GenericNodeFactory<NoiseNode<FloatType>>());
             callback("mc.sample",       GenericNodeFactory<MCSampleNode<FloatType>>());
             callback("mc.sampleseq",    GenericNodeFactory<StereoSampleSeqNode<FloatType>>());
             callback("mc.sampleseq2",   GenericNodeFactory<StereoSampleSeqWithStretchNode<FloatType>>());
             callback("mc.table",        GenericNodeFactory<StereoTableNode<FloatType>>());
+            callback("mc.stft",         GenericNodeFactory<STFTNode<FloatType>>());
+            callback("mc.istft",        GenericNodeFactory<ISTFTNode<FloatType>>());
 
             // Oscillator nodes
             callback("blepsaw",         GenericNodeFactory<PolyBlepOscillatorNode<FloatType, detail::BlepMode::Saw>>());
@@ -50,6 +50,15 @@ namespace elem
         virtual int setProperty(std::string const& key, js::Value const& val);
         virtual int setProperty(std::string const& key, js::Value const& val, SharedResourceMap& resources);
 
+        // Called once a batch of `setProperty` calls has been applied to this node.
+        //
+        // Nodes that derive something costly from several properties together can note
+        // which properties changed in `setProperty` and do the work once here, rather
+        // than once for every property in the batch.
+        //
+        // This method will be called on the non-realtime thread.
+        virtual void commitProperties(SharedResourceMap& /* resources */) {}
+
         // Retreives a property from the Node's props, falling back to the provided
         // default value if no property exists by the given name.
         //
@@ -80,6 +89,18 @@ namespace elem
         // Thread safety must be managed by the user.
         virtual void processEvents(std::function<void(std::string const&, js::Value)>& /* eventHandler */) {}
 
+        // Updates the sample rate and block size, as when the host device changes.
+        //
+        // The default implementation stores the new values. Nodes which size buffers or
+        // compute coefficients from either value in their constructor should override this
+        // method to redo that work, calling the base class first. Anything derived from
+        // properties is taken care of by the Runtime, which hands every node its current
+        // properties again once this returns.
+        //
+        // This method will be called from Runtime's `prepare` on the non-realtime thread,
+        // while the realtime thread is not processing.
+        virtual void prepare(double sr, size_t bs);
+
         // Derived classes may override this method to reset themselves.
         //
         // This method will be called by the end user through Runtime/GraphHost
@@ -105,6 +126,12 @@ namespace elem
     {
     }
 
+    template <typename FloatType>
+    void GraphNode<FloatType>::prepare(double sr, size_t bs) {
+        sampleRate = sr;
+        blockSize = bs;
+    }
+
     template <typename FloatType>
     int GraphNode<FloatType>::setProperty(std::string const& key, js::Value const& val) {
         props.insert_or_assign(key, val);
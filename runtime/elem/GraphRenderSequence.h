@@ -258,6 +258,18 @@ namespace elem
             subseqs.push_back(std::move(sq));
         }
 
+        // The most samples that the buffers of this sequence, and the nodes in it, are
+        // prepared to process at once, or 0 if unknown
+        void setBlockSize(size_t bs)
+        {
+            blockSize = bs;
+        }
+
+        size_t getBlockSize() const
+        {
+            return blockSize;
+        }
+
         void processQueuedEvents(std::function<void(std::string const&, js::Value)>&& evtCallback)
         {
             std::for_each(subseqs.begin(), subseqs.end(), [&](RootRenderSequence<FloatType>& sq) {
@@ -312,6 +324,7 @@ namespace elem
 
     private:
         std::vector<RootRenderSequence<FloatType>> subseqs;
+        size_t blockSize = 0;
     };
 
 } // namespace elem
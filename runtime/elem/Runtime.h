@@ -1,13 +1,16 @@
 #pragma once
 
+#include <algorithm>
 #include <memory>
 #include <set>
 #include <unordered_map>
 
 #include "builtins/helpers/RefCountedPool.h"
+#include "AudioFileLoader.h"
 #include "DefaultNodeTypes.h"
 #include "GraphNode.h"
 #include "GraphRenderSequence.h"
+#include "Subgraph.h"
 #include "Types.h"
 #include "Value.h"
 #include "JSON.h"
@@ -43,11 +46,32 @@ namespace elem
         //==============================================================================
         Runtime(double sampleRate, int blockSize);
 
+        //==============================================================================
+        // Changes the sample rate and maximum block size, keeping the current graph.
+        //
+        // Every node in the node table is prepared for the new values and handed its
+        // current properties again, the same way it would receive them from the frontend,
+        // and the render sequence is rebuilt over buffers of the new size. Container nodes
+        // rebuild their subgraphs. Shared resources stay in the map; nodes which match a
+        // resource to the sample rate derive a new copy from the one already loaded.
+        //
+        // Every property is checked against the new settings before anything changes, so
+        // a call which returns an error leaves the runtime as it was.
+        //
+        // Must not be called while `process` may be running, as with the host's own
+        // prepare callback.
+        int prepare(double sampleRate, int maxBlockSize);
+
         //==============================================================================
         // Apply graph rendering instructions
         int applyInstructions(js::Array const& batch);
 
         // Run the internal audio processing callback
+        //
+        // Calls with more samples than the block size given at construction are split
+        // into blocks of that size, so hosts may pass buffers of any length. Each of those
+        // blocks sees the same userData pointer, so hosts that keep a running sample time
+        // there and need it exact per block should call with at most the block size.
         void process(
             const FloatType** inputChannelData,
             size_t numInputChannels,
@@ -60,7 +84,11 @@ namespace elem
         // Process queued events
         //
         // This raises events from the processing graph such as new data from analysis nodes
-        // or errors encountered while processing.
+        // or errors encountered while processing, as well as the completion of any
+        // background file loads started by `loadSharedResourceAsync`.
+        //
+        // Completed loads are added to the shared resource map from within this call, so
+        // it must be made from the same (non-realtime) thread that applies instructions.
         void processQueuedEvents(std::function<void(std::string const&, js::Value)>&& evtCallback);
 
         // Reset the internal graph nodes
@@ -82,6 +110,32 @@ namespace elem
         // shared pointer to the resource.
         bool addSharedResource(std::string const& name, std::unique_ptr<SharedResource> resource);
 
+        // Replaces the contents of a shared resource, or adds it if no resource exists by
+        // that name.
+        //
+        // Every graph node whose `path` property refers to the given name is handed the new
+        // resource through its usual property channel, and picks it up at the start of its
+        // next block. No render from the frontend is required. The previous resource stays
+        // alive until `pruneSharedResources` finds that no node still holds it, so it is never
+        // freed on the realtime thread.
+        bool updateSharedResource(std::string const& name, std::unique_ptr<SharedResource> resource);
+
+        // Decodes an audio file on a background thread and loads the result into the
+        // shared resource map under the given name.
+        //
+        // WAV and AIFF/AIFC files are supported, as is headerless PCM data when `options.raw`
+        // describes its layout. By default, audio recorded at a different sample rate is
+        // resampled to the runtime sample rate as part of the load.
+        //
+        // The resource is added to the map during a subsequent call to `processQueuedEvents`,
+        // which also raises a "sharedResourceLoaded" event carrying the resource name, the
+        // file path, and a success flag with an accompanying message.
+        //
+        // This is for native hosts reading from their own file system. The wasm processor
+        // doesn't expose it; the web and offline renderers take decoded audio through their
+        // virtual file system instead.
+        void loadSharedResourceAsync(std::string const& name, std::string const& filePath, AudioFileLoadOptions const& options = {});
+
         // Removes unused resources from the map
         //
         // This method will retain any resource with references held by an active
@@ -121,6 +175,7 @@ namespace elem
         };
 
         int createNode(js::Value const& nodeId, js::Value const& type);
+        std::shared_ptr<GraphNode<FloatType>> makeNode(std::string const& type, NodeId const nodeId, double sr, int bs);
         int setProperty(js::Value const& nodeId, js::Value const& prop, js::Value const& v);
         int appendChild(js::Value const& parentId, js::Value const& childId, js::Value const& childOutputChannel);
         int activateRoots(js::Array const& v);
@@ -132,11 +187,17 @@ namespace elem
 
         SingleWriterSingleReaderQueue<std::shared_ptr<GraphRenderSequence<FloatType>>> rseqQueue;
 
+        // Channel pointers offset into the host buffers, for processing oversized calls
+        // one block at a time
+        std::vector<FloatType const*> rtInputPtrs;
+        std::vector<FloatType*> rtOutputPtrs;
+
         //==============================================================================
         std::unordered_map<std::string, NodeFactoryFn> nodeFactory;
 
         struct GraphEntry {
             std::shared_ptr<GraphNode<FloatType>> node;
+            std::string type;
             std::vector<InletConnection> inlets;
             std::vector<OutletConnection> outlets;
         };
@@ -147,6 +208,7 @@ namespace elem
         RefCountedPool<GraphRenderSequence<FloatType>> renderSeqPool;
 
         SharedResourceMap sharedResourceMap;
+        AudioFileLoader fileLoader;
 
         double sampleRate;
         int blockSize;
@@ -160,17 +222,82 @@ namespace elem
         , sampleRate(sampleRate)
         , blockSize(blockSize)
     {
+        rtInputPtrs.reserve(64);
+        rtOutputPtrs.reserve(64);
+
         DefaultNodeTypes<FloatType>::forEach([this](std::string const& type, NodeFactoryFn&& fn) {
             registerNodeType(type, std::move(fn));
         });
     }
 
+    //==============================================================================
+    template <typename FloatType>
+    int Runtime<FloatType>::prepare(double sr, int maxBlockSize)
+    {
+        if (sr <= 0.0 || maxBlockSize <= 0)
+            return ReturnCode::InvalidPropertyValue();
+
+        // Before touching anything, we replay each node's properties onto a scratch node of
+        // the same type built for the new settings, against a copy of the resource map. A
+        // property the new settings can't accommodate thereby fails the call while the
+        // runtime is still fully prepared for the old ones. Anything the scratch nodes add
+        // to the map, such as resources matched to the new rate, is kept for the real pass.
+        auto resources = sharedResourceMap;
+
+        for (auto const& [nodeId, entry] : nodeTable) {
+            auto scratch = makeNode(entry.type, nodeId, sr, maxBlockSize);
+
+            for (auto const& [key, value] : entry.node->getProperties()) {
+                if (auto res = scratch->setProperty(key, value, resources); res != ReturnCode::Ok())
+                    return res;
+            }
+        }
+
+        sharedResourceMap = std::move(resources);
+        sampleRate = sr;
+        blockSize = maxBlockSize;
+        bufferAllocator = BufferAllocator<FloatType>(static_cast<size_t>(maxBlockSize));
+
+        // Nothing is processing, so we can take the pending sequence off the queue here
+        // rather than leave one built over the old buffers for the realtime thread
+        while (rseqQueue.size() > 0) {
+            std::shared_ptr<GraphRenderSequence<FloatType>> rseq;
+            rseqQueue.pop(rseq);
+        }
+
+        // Having validated every property above, these can't fail
+        for (auto& [nodeId, entry] : nodeTable) {
+            entry.node->prepare(sr, static_cast<size_t>(maxBlockSize));
+
+            for (auto const& [key, value] : entry.node->getProperties())
+                entry.node->setProperty(key, value, sharedResourceMap);
+
+            entry.node->commitProperties(sharedResourceMap);
+        }
+
+        if (rtRenderSeq || !currentRoots.empty())
+            rtRenderSeq = buildRenderSequence();
+
+        return ReturnCode::Ok();
+    }
+
     //==============================================================================
     template <typename FloatType>
     int Runtime<FloatType>::applyInstructions(elem::js::Array const& batch)
     {
         bool shouldRebuild = false;
 
+        // Nodes which received properties in this batch, each of which gets a single call
+        // to commit them at the end of the batch or at the next commit instruction
+        std::set<NodeId> updatedNodes;
+
+        auto commitProperties = [&]() {
+            for (auto const& nodeId : updatedNodes)
+                nodeTable.at(nodeId).node->commitProperties(sharedResourceMap);
+
+            updatedNodes.clear();
+        };
+
         // TODO: For correct transaction semantics here, we should createNode into a separate
         // map that only gets merged into the actual nodeMap on commitUpdaes
         for (auto& next : batch) {
@@ -191,6 +318,10 @@ namespace elem
                     break;
                 case InstructionType::SET_PROPERTY:
                     res = setProperty(ar[1], ar[2], ar[3]);
+
+                    if (res == ReturnCode::Ok())
+                        updatedNodes.insert(static_cast<int32_t>((elem::js::Number) ar[1]));
+
                     break;
                 case InstructionType::APPEND_CHILD:
                     res = appendChild(ar[1], ar[2], ar[3]);
@@ -200,6 +331,8 @@ namespace elem
                     shouldRebuild = true;
                     break;
                 case InstructionType::COMMIT_UPDATES:
+                    commitProperties();
+
                     if (shouldRebuild) {
                         rseqQueue.push(buildRenderSequence());
                     }
@@ -210,10 +343,12 @@ namespace elem
 
             // TODO: And here we should abort the transaction and revert any applied properties
             if (res != ReturnCode::Ok()) {
+                commitProperties();
                 return res;
             }
         }
 
+        commitProperties();
         return ReturnCode::Ok();
     }
 
@@ -284,8 +419,34 @@ namespace elem
             rtRenderSeq = rseq;
         }
 
-        if (rtRenderSeq) {
+        if (!rtRenderSeq)
+            return;
+
+        auto const maxBlockSize = rtRenderSeq->getBlockSize();
+
+        // A sequence which doesn't know its block size can't be sliced, and gets the
+        // whole call as it did before block sizes were tracked
+        if (maxBlockSize == 0 || numSamples <= maxBlockSize) {
             rtRenderSeq->process(inputChannelData, numInputChannels, outputChannelData, numOutputChannels, numSamples, userData);
+            return;
+        }
+
+        // The node buffers only hold maxBlockSize samples, so we run the graph over
+        // successive slices of the host buffers. Only hosts with more channels than we
+        // reserved for will allocate here, and only on their first oversized call.
+        rtInputPtrs.resize(numInputChannels);
+        rtOutputPtrs.resize(numOutputChannels);
+
+        for (size_t offset = 0; offset < numSamples; offset += maxBlockSize) {
+            auto const n = std::min(maxBlockSize, numSamples - offset);
+
+            for (size_t i = 0; i < numInputChannels; ++i)
+                rtInputPtrs[i] = inputChannelData[i] + offset;
+
+            for (size_t i = 0; i < numOutputChannels; ++i)
+                rtOutputPtrs[i] = outputChannelData[i] + offset;
+
+            rtRenderSeq->process(rtInputPtrs.data(), numInputChannels, rtOutputPtrs.data(), numOutputChannels, n, userData);
         }
     }
 
@@ -306,12 +467,28 @@ namespace elem
         if (nodeTable.find(nodeId) != nodeTable.end())
             return ReturnCode::NodeAlreadyExists();
 
-        auto node = nodeFactory[type](nodeId, sampleRate, blockSize);
-        nodeTable.insert({nodeId, {node, {}, {}}});
+        nodeTable.insert({nodeId, {makeNode(type, nodeId, sampleRate, blockSize), type, {}, {}}});
 
         return ReturnCode::Ok();
     }
 
+    template <typename FloatType>
+    std::shared_ptr<GraphNode<FloatType>> Runtime<FloatType>::makeNode(std::string const& type, NodeId const nodeId, double sr, int bs)
+    {
+        auto node = nodeFactory.at(type)(nodeId, sr, bs);
+
+        // Container nodes instantiate the node types named in their templates through
+        // the same factory functions
+        if (auto container = std::dynamic_pointer_cast<SubgraphContainer<FloatType>>(node)) {
+            container->setNodeFactory([this](std::string const& t, NodeId const id, double sr, int const bs) -> std::shared_ptr<GraphNode<FloatType>> {
+                auto it = nodeFactory.find(t);
+                return it != nodeFactory.end() ? it->second(id, sr, bs) : nullptr;
+            });
+        }
+
+        return node;
+    }
+
     template <typename FloatType>
     int Runtime<FloatType>::setProperty(js::Value const& a1, js::Value const& a2, js::Value const& v)
     {
@@ -437,6 +614,24 @@ namespace elem
     template <typename FloatType>
     void Runtime<FloatType>::processQueuedEvents(std::function<void(std::string const&, js::Value)>&& evtCallback)
     {
+        // First we pick up any background file loads that have finished since last time
+        fileLoader.drainCompleted([&](AudioFileLoader::Result& result) {
+            auto success = result.error.empty();
+            auto message = result.error;
+
+            if (success && !sharedResourceMap.add(result.name, std::move(result.resource))) {
+                success = false;
+                message = "A shared resource already exists with the name: " + result.name;
+            }
+
+            evtCallback("sharedResourceLoaded", js::Object({
+                {"name", result.name},
+                {"path", result.filePath},
+                {"success", success},
+                {"message", message},
+            }));
+        });
+
         // This looks a little shady, but because of the atomic ref count in std::shared_ptr this assignment
         // is indeed thread-safe
         if (auto ptr = rtRenderSeq)
@@ -464,6 +659,28 @@ namespace elem
         return sharedResourceMap.add(name, std::move(resource));
     }
 
+    template <typename FloatType>
+    bool Runtime<FloatType>::updateSharedResource(std::string const& name, std::unique_ptr<SharedResource> resource)
+    {
+        if (!sharedResourceMap.update(name, std::move(resource)))
+            return false;
+
+        // Re-dispatch the path property to each referencing node so that it pushes the new
+        // resource through its queue to the realtime thread, including the nodes within
+        // container subgraphs
+        for (auto& [nodeId, entry] : nodeTable) {
+            updateSharedResourceReferences(*entry.node, name, sharedResourceMap);
+        }
+
+        return true;
+    }
+
+    template <typename FloatType>
+    void Runtime<FloatType>::loadSharedResourceAsync(std::string const& name, std::string const& filePath, AudioFileLoadOptions const& options)
+    {
+        fileLoader.load(name, filePath, sampleRate, options);
+    }
+
     template <typename FloatType>
     void Runtime<FloatType>::pruneSharedResources()
     {
@@ -525,6 +742,7 @@ namespace elem
 
         // Clear in case it was already used
         rseq->reset();
+        rseq->setBlockSize(static_cast<size_t>(blockSize));
 
         // Reset our buffer allocator
         bufferAllocator.reset();
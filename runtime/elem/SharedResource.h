@@ -1,7 +1,10 @@
 #pragma once
 
+#include <algorithm>
 #include <memory>
+#include <type_traits>
 #include <unordered_map>
+#include <vector>
 
 #include "Types.h"
 
@@ -19,20 +22,61 @@ namespace elem
 
       virtual BufferView<float> getChannelData (size_t channelIndex) = 0;
 
+      // Resources which store double precision data can expose it here. The default
+      // implementation returns an empty view, indicating that only float data is available.
+      virtual BufferView<double> getChannelDataDouble (size_t) { return BufferView<double>(nullptr, 0); }
+
+      // Returns a view over the channel data in the requested sample format, which is
+      // empty if the resource does not store data in that format.
+      template <typename SampleType>
+      BufferView<SampleType> getChannelDataAs (size_t channelIndex)
+      {
+          static_assert(std::is_same_v<SampleType, float> || std::is_same_v<SampleType, double>);
+
+          if constexpr (std::is_same_v<SampleType, double>) {
+              return getChannelDataDouble(channelIndex);
+          } else {
+              return getChannelData(channelIndex);
+          }
+      }
+
       virtual size_t numChannels() = 0;
       virtual size_t numSamples() = 0;
+
+      // The sample rate at which the resource data was recorded, if known. A value of 0
+      // indicates that the data carries no particular rate and should be read as-is.
+      virtual double getSampleRate() { return 0.0; }
     };
 
     //==============================================================================
     // Utility type definition
     using SharedResourcePtr = std::shared_ptr<SharedResource>;
 
+    // Invokes `fn` with a view over the given channel of the resource, picking the
+    // resource's native double data when FloatType is double and such data exists, and
+    // its float data otherwise. The callback is typically a generic lambda, so that a
+    // node instantiates a conversion-free read loop for each sample format it may see.
+    template <typename FloatType, typename Fn>
+    auto visitChannelData(SharedResource& resource, size_t channelIndex, Fn&& fn)
+    {
+        if constexpr (std::is_same_v<FloatType, double>) {
+            auto view = resource.getChannelDataDouble(channelIndex);
+
+            if (view.size() > 0)
+                return fn(view);
+        }
+
+        return fn(resource.getChannelData(channelIndex));
+    }
+
     //==============================================================================
     // A small wrapper around an unordered_map for holding and interacting with
     // shared resources
     class SharedResourceMap {
     private:
         std::unordered_map<std::string, SharedResourcePtr> resources;
+        std::unordered_map<std::string, std::unordered_map<std::string, SharedResourcePtr>> derivedResources;
+        std::vector<SharedResourcePtr> retiredResources;
 
     public:
         SharedResourceMap() = default;
@@ -41,9 +85,18 @@ namespace elem
 
         // Accessor methods for resources
         //
-        // We only allow insertions, not updates. This preserves immutability of existing
-        // entries which we need in case any active graph nodes hold references to those entries.
+        // `add` only allows insertions. Existing entries are never mutated in place, which we
+        // need in case any active graph nodes hold references to those entries.
         bool add(std::string const& name, SharedResourcePtr resource);
+
+        // Replaces the entry under the given name with a new resource, or inserts it if no
+        // such entry exists.
+        //
+        // The previous resource, and any resources derived from it, are not mutated. Instead
+        // they are retired: kept alive by the map until `prune()` finds them unreferenced, so
+        // that graph nodes still holding them can swap to the new entry from the realtime
+        // thread without dropping the last reference there.
+        bool update(std::string const& name, SharedResourcePtr resource);
         bool has(std::string const& name) const;
         SharedResourcePtr get(std::string const& name) const;
 
@@ -51,6 +104,15 @@ namespace elem
         // inserting a default entry
         SharedResourcePtr getTapResource(std::string const& name, std::function<SharedResourcePtr()> makeDefault);
 
+        // Accessor for resources derived from an existing entry, such as a copy converted
+        // to the engine sample rate.
+        //
+        // Derived resources are built lazily by `makeDerived` on the first request for a given
+        // (name, key) pair and cached thereafter. They are not visible through `keys()`, and a
+        // source entry is retained by `prune()` for as long as any of its derived resources
+        // are still referenced. Returns nullptr if no entry exists with the given name.
+        SharedResourcePtr getDerived(std::string const& name, std::string const& key, std::function<SharedResourcePtr(SharedResourcePtr const&)> makeDerived);
+
         // Inspecting and clearing entries
         KeyViewType keys();
         void prune();
@@ -62,6 +124,31 @@ namespace elem
         return resources.emplace(name, resource).second;
     }
 
+    inline bool SharedResourceMap::update (std::string const& name, SharedResourcePtr resource) {
+        if (resource == nullptr)
+            return false;
+
+        auto it = resources.find(name);
+
+        if (it == resources.end())
+            return add(name, std::move(resource));
+
+        retiredResources.push_back(std::move(it->second));
+        it->second = std::move(resource);
+
+        auto dit = derivedResources.find(name);
+
+        if (dit != derivedResources.end()) {
+            for (auto& [key, derived] : dit->second) {
+                retiredResources.push_back(std::move(derived));
+            }
+
+            derivedResources.erase(dit);
+        }
+
+        return true;
+    }
+
     inline bool SharedResourceMap::has (std::string const& name) const {
         return resources.count(name) > 0;
     }
@@ -90,9 +177,53 @@ namespace elem
         return resource;
     }
 
+    inline SharedResourcePtr SharedResourceMap::getDerived(std::string const& name, std::string const& key, std::function<SharedResourcePtr(SharedResourcePtr const&)> makeDerived) {
+        auto source = get(name);
+
+        if (source == nullptr)
+            return nullptr;
+
+        auto& entries = derivedResources[name];
+        auto it = entries.find(key);
+
+        if (it != entries.end())
+            return it->second;
+
+        SharedResourcePtr resource = makeDerived(source);
+
+        if (resource != nullptr)
+            entries.emplace(key, resource);
+
+        return resource;
+    }
+
     inline void SharedResourceMap::prune() {
+        // Derived entries go first, so that any source whose derived resources are all
+        // unused can be released in the same pass
+        for (auto it = derivedResources.begin(); it != derivedResources.end(); /* no increment */) {
+            auto& entries = it->second;
+
+            for (auto jt = entries.cbegin(); jt != entries.cend(); /* no increment */) {
+                if (jt->second.use_count() == 1) {
+                    entries.erase(jt++);
+                } else {
+                    jt++;
+                }
+            }
+
+            if (entries.empty()) {
+                derivedResources.erase(it++);
+            } else {
+                it++;
+            }
+        }
+
+        retiredResources.erase(std::remove_if(retiredResources.begin(), retiredResources.end(), [](auto const& r) {
+            return r.use_count() == 1;
+        }), retiredResources.end());
+
         for (auto it = resources.cbegin(); it != resources.cend(); /* no increment */) {
-            if (it->second.use_count() == 1) {
+            if (it->second.use_count() == 1 && derivedResources.count(it->first) == 0) {
                 resources.erase(it++);
             } else {
                 it++;
@@ -0,0 +1,469 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "GraphNode.h"
+#include "JSON.h"
+#include "SharedResource.h"
+#include "SingleWriterSingleReaderQueue.h"
+#include "Types.h"
+#include "Value.h"
+
+#include "builtins/helpers/RefCountedPool.h"
+
+
+namespace elem
+{
+
+    //==============================================================================
+    // Creates a new graph node of any type registered with the Runtime, returning
+    // nullptr for unknown types.
+    template <typename FloatType>
+    using NodeTypeFactoryFn = std::function<std::shared_ptr<GraphNode<FloatType>>(std::string const& type, NodeId const id, double sampleRate, int const blockSize)>;
+
+    // Implemented by graph nodes which render a subgraph of their own, such as the voices
+    // container.
+    //
+    // The Runtime hands such nodes its node factory as soon as they're created, before
+    // any of their properties are set, so that they can instantiate the node types
+    // named in their templates.
+    //
+    // When a shared resource is replaced in place, the Runtime calls
+    // `updateSharedResource` so that nodes within the container's subgraphs which
+    // reference it pick up the new one, as nodes in the root graph do.
+    template <typename FloatType>
+    struct SubgraphContainer {
+        virtual ~SubgraphContainer() = default;
+        virtual void setNodeFactory(NodeTypeFactoryFn<FloatType> const& fn) = 0;
+        virtual void updateSharedResource(std::string const& name, SharedResourceMap& resources) = 0;
+    };
+
+    // Re-dispatches the `path` property of the given node if it refers to the named
+    // shared resource, so that the node pushes the new resource through to the realtime
+    // thread, and passes the update on if the node is itself a container
+    template <typename FloatType>
+    void updateSharedResourceReferences(GraphNode<FloatType>& node, std::string const& name, SharedResourceMap& resources)
+    {
+        auto const path = node.getPropertyWithDefault("path", js::Value());
+
+        if (path.isString() && (js::String) path == name) {
+            node.setProperty("path", path, resources);
+            node.commitProperties(resources);
+        }
+
+        if (auto* container = dynamic_cast<SubgraphContainer<FloatType>*>(&node))
+            container->updateSharedResource(name, resources);
+    }
+
+    //==============================================================================
+    // A description of a subgraph, as the frontend sends it in a container node's
+    // `template` property:
+    //
+    //   {
+    //     nodes: [[type, props, [[childIndex, childChannel], ...]], ...],
+    //     outputs: [[nodeIndex, channel], ...],
+    //   }
+    //
+    // Nodes are listed children first, so that every node comes after its children.
+    // Within the subgraph, `in` nodes read from the inputs the container provides rather
+    // than from the host, and the subgraph's outputs are the given node output channels.
+    struct SubgraphTemplate {
+        struct NodeSpec {
+            std::string type;
+            js::Object props;
+            std::vector<std::pair<size_t, size_t>> inlets;
+            size_t numOutputs = 1;
+        };
+
+        std::vector<NodeSpec> nodes;
+        std::vector<std::pair<size_t, size_t>> outputs;
+
+        // The most channels a template may refer to on any one node, or read through
+        // its `in` nodes
+        static constexpr size_t kMaxChannels = 1024;
+
+        // Parses the template, returning a ReturnCode. Leaves the template as it was
+        // unless parsing succeeds.
+        int parse(js::Value const& v)
+        {
+            if (!v.isObject())
+                return ReturnCode::InvalidPropertyType();
+
+            auto const& obj = v.getObject();
+
+            if (obj.count("nodes") == 0 || obj.count("outputs") == 0)
+                return ReturnCode::InvalidPropertyValue();
+
+            if (!obj.at("nodes").isArray() || !obj.at("outputs").isArray())
+                return ReturnCode::InvalidPropertyType();
+
+            auto const& nodeList = obj.at("nodes").getArray();
+            auto const& outputList = obj.at("outputs").getArray();
+
+            // Checks for a number we can use as an index below `limit`
+            auto const isIndex = [](js::Number n, size_t limit) {
+                return std::isfinite(n) && n >= 0 && n < static_cast<double>(limit);
+            };
+
+            // Reads a [index, channel] pair referring to a node before `limit`
+            auto const readConnection = [&](js::Value const& c, size_t limit, std::pair<size_t, size_t>& out) {
+                if (!c.isArray() || c.getArray().size() != 2 || !c.getArray()[0].isNumber() || !c.getArray()[1].isNumber())
+                    return false;
+
+                auto const index = (js::Number) c.getArray()[0];
+                auto const channel = (js::Number) c.getArray()[1];
+
+                if (!isIndex(index, limit) || !isIndex(channel, kMaxChannels))
+                    return false;
+
+                out = { static_cast<size_t>(index), static_cast<size_t>(channel) };
+                return true;
+            };
+
+            std::vector<NodeSpec> parsedNodes;
+            std::vector<std::pair<size_t, size_t>> parsedOutputs;
+
+            for (size_t i = 0; i < nodeList.size(); ++i) {
+                auto const& entry = nodeList[i];
+
+                if (!entry.isArray() || entry.getArray().size() != 3)
+                    return ReturnCode::InvalidPropertyValue();
+
+                auto const& parts = entry.getArray();
+
+                if (!parts[0].isString() || !parts[1].isObject() || !parts[2].isArray())
+                    return ReturnCode::InvalidPropertyValue();
+
+                NodeSpec spec;
+                spec.type = (js::String) parts[0];
+                spec.props = parts[1].getObject();
+
+                // A negative channel reads silence, but the container sizes its inputs
+                // for the highest one
+                if (spec.type == "in") {
+                    auto const it = spec.props.find("channel");
+
+                    if (it != spec.props.end() && it->second.isNumber()) {
+                        auto const channel = (js::Number) it->second;
+
+                        if (!std::isfinite(channel) || channel >= static_cast<double>(kMaxChannels))
+                            return ReturnCode::InvalidPropertyValue();
+                    }
+                }
+
+                for (auto const& c : parts[2].getArray()) {
+                    std::pair<size_t, size_t> inlet;
+
+                    if (!readConnection(c, i, inlet))
+                        return ReturnCode::InvalidPropertyValue();
+
+                    spec.inlets.push_back(inlet);
+                    parsedNodes[inlet.first].numOutputs = std::max(parsedNodes[inlet.first].numOutputs, inlet.second + 1);
+                }
+
+                parsedNodes.push_back(std::move(spec));
+            }
+
+            for (auto const& c : outputList) {
+                std::pair<size_t, size_t> output;
+
+                if (!readConnection(c, parsedNodes.size(), output))
+                    return ReturnCode::InvalidPropertyValue();
+
+                parsedOutputs.push_back(output);
+                parsedNodes[output.first].numOutputs = std::max(parsedNodes[output.first].numOutputs, output.second + 1);
+            }
+
+            nodes = std::move(parsedNodes);
+            outputs = std::move(parsedOutputs);
+
+            return ReturnCode::Ok();
+        }
+
+        // Returns the number of container inputs the template reads, through its `in` nodes
+        size_t getNumInputs() const
+        {
+            size_t n = 0;
+
+            for (auto const& spec : nodes) {
+                if (spec.type != "in" || !spec.inlets.empty())
+                    continue;
+
+                auto const it = spec.props.find("channel");
+                auto const channel = (it != spec.props.end() && it->second.isNumber()) ? (js::Number) it->second : 0.0;
+
+                n = std::max(n, static_cast<size_t>(std::max(0.0, channel)) + 1);
+            }
+
+            return n;
+        }
+
+        // Returns a string identifying the template's contents, or an empty string if it
+        // can't be serialized, so that containers can skip rebuilding for a template they
+        // already have
+        static std::string getKey(js::Value const& v)
+        {
+            try {
+                return js::serialize(v);
+            } catch (std::exception const&) {
+                return {};
+            }
+        }
+    };
+
+    //==============================================================================
+    // One instance of a subgraph template: its nodes, in render order, and the buffers
+    // between them.
+    //
+    // Nodes are processed one at a time by index so that a container can interleave
+    // the processing of several instances node by node.
+    template <typename FloatType>
+    class SubgraphInstance
+    {
+    public:
+        // Creates and configures the template's nodes. Must be called off the realtime
+        // thread. Returns a ReturnCode.
+        int build(SubgraphTemplate const& tmpl, NodeTypeFactoryFn<FloatType> const& factory, double sampleRate, int blockSize, SharedResourceMap& resources)
+        {
+            nodes.clear();
+            inletPtrs.clear();
+            outputPtrs.clear();
+            outputs.clear();
+
+            size_t numBuffers = 0;
+
+            for (auto const& spec : tmpl.nodes)
+                numBuffers += spec.numOutputs;
+
+            storage.assign(numBuffers * static_cast<size_t>(blockSize), FloatType(0));
+
+            auto* next = storage.data();
+
+            for (size_t i = 0; i < tmpl.nodes.size(); ++i) {
+                auto const& spec = tmpl.nodes[i];
+                auto node = factory ? factory(spec.type, static_cast<NodeId>(i), sampleRate, blockSize) : nullptr;
+
+                if (node == nullptr)
+                    return ReturnCode::UnknownNodeType();
+
+                // Containers within the subgraph need the factory too
+                if (auto container = std::dynamic_pointer_cast<SubgraphContainer<FloatType>>(node))
+                    container->setNodeFactory(factory);
+
+                if (!spec.inlets.empty())
+                    node->setProperty("_internal:numChildren", js::Number(spec.inlets.size()));
+
+                for (auto const& [key, value] : spec.props) {
+                    auto const res = node->setProperty(key, value, resources);
+
+                    if (res != ReturnCode::Ok())
+                        return res;
+                }
+
+                node->commitProperties(resources);
+
+                std::vector<FloatType*> outs(spec.numOutputs);
+
+                for (auto& p : outs) {
+                    p = next;
+                    next += blockSize;
+                }
+
+                std::vector<FloatType const*> ins(spec.inlets.size());
+
+                for (size_t j = 0; j < spec.inlets.size(); ++j)
+                    ins[j] = outputPtrs[spec.inlets[j].first][spec.inlets[j].second];
+
+                nodes.push_back(std::move(node));
+                inletPtrs.push_back(std::move(ins));
+                outputPtrs.push_back(std::move(outs));
+            }
+
+            for (auto const& [index, channel] : tmpl.outputs)
+                outputs.push_back(outputPtrs[index][channel]);
+
+            return ReturnCode::Ok();
+        }
+
+        size_t getNumNodes() const { return nodes.size(); }
+        size_t getNumOutputs() const { return outputs.size(); }
+
+        // Returns the given output channel of the subgraph as of the last process call
+        FloatType const* getOutput(size_t channel) const { return outputs[channel]; }
+
+        // Processes the node at the given index. Nodes without children read from the
+        // given inputs, as nodes in the root graph read from the host's inputs.
+        void processNode(size_t index, FloatType const** inputs, size_t numInputs, size_t numSamples, void* userData)
+        {
+            auto& ins = inletPtrs[index];
+            auto& outs = outputPtrs[index];
+            auto const isLeaf = ins.empty();
+
+            nodes[index]->process(BlockContext<FloatType> {
+                isLeaf ? inputs : ins.data(),
+                isLeaf ? numInputs : ins.size(),
+                outs.data(),
+                outs.size(),
+                numSamples,
+                userData,
+                true,
+            });
+        }
+
+        // Processes every node in order
+        void process(FloatType const** inputs, size_t numInputs, size_t numSamples, void* userData)
+        {
+            for (size_t i = 0; i < nodes.size(); ++i)
+                processNode(i, inputs, numInputs, numSamples, userData);
+        }
+
+        void processEvents(std::function<void(std::string const&, js::Value)>& eventHandler)
+        {
+            for (auto& n : nodes)
+                n->processEvents(eventHandler);
+        }
+
+        void reset()
+        {
+            for (auto& n : nodes)
+                n->reset();
+        }
+
+        // Must be called off the realtime thread
+        void updateSharedResource(std::string const& name, SharedResourceMap& resources)
+        {
+            for (auto& n : nodes)
+                updateSharedResourceReferences(*n, name, resources);
+        }
+
+    private:
+        std::vector<std::shared_ptr<GraphNode<FloatType>>> nodes;
+        std::vector<std::vector<FloatType const*>> inletPtrs;
+        std::vector<std::vector<FloatType*>> outputPtrs;
+        std::vector<FloatType const*> outputs;
+        std::vector<FloatType> storage;
+    };
+
+    //==============================================================================
+    // A base for container nodes, holding everything about a container that doesn't
+    // depend on how it renders: the `template` property, the engine built from it, and
+    // the handoff of each new engine to the realtime thread.
+    //
+    // An engine holds the container's subgraph instances and whatever else it renders
+    // with. Containers implement `buildEngine`, which sets up a pooled engine from the
+    // current template and their own properties, and `forEachSubgraph`, which visits the
+    // instances in an engine. They call `rebuild` when one of their own properties
+    // changes, and `getActiveEngine` at the top of `process`.
+    template <typename FloatType, typename Engine>
+    struct SubgraphContainerNode : public GraphNode<FloatType>, public SubgraphContainer<FloatType> {
+        using GraphNode<FloatType>::GraphNode;
+
+        // Sets up the given engine for the current template, returning a ReturnCode.
+        // Called off the realtime thread; the engine may have been used before.
+        virtual int buildEngine(Engine& engine, SharedResourceMap& resources) = 0;
+
+        virtual void forEachSubgraph(Engine& engine, std::function<void(SubgraphInstance<FloatType>&)> const& fn) = 0;
+
+        void setNodeFactory(NodeTypeFactoryFn<FloatType> const& fn) override
+        {
+            factory = fn;
+        }
+
+        void prepare(double sr, size_t bs) override
+        {
+            GraphNode<FloatType>::prepare(sr, bs);
+
+            // Engines are built for one rate and block size, so we let the template
+            // through again when the runtime hands it back to us
+            currentTemplateKey.clear();
+        }
+
+        int setProperty(std::string const& key, js::Value const& val, SharedResourceMap& resources) override
+        {
+            if (key == "template") {
+                auto const templateKey = SubgraphTemplate::getKey(val);
+
+                // The frontend sends the template again on every render that touches this
+                // node, and rebuilding would reset every subgraph
+                if (templateKey.empty() || templateKey != currentTemplateKey) {
+                    SubgraphTemplate next;
+
+                    if (auto res = next.parse(val); res != ReturnCode::Ok())
+                        return res;
+
+                    subgraphTemplate = std::move(next);
+                    hasTemplate = true;
+                    currentTemplateKey = templateKey;
+
+                    if (auto res = rebuild(resources); res != ReturnCode::Ok())
+                        return res;
+                }
+            }
+
+            return GraphNode<FloatType>::setProperty(key, val);
+        }
+
+        // Builds a new engine and queues it for the realtime thread
+        int rebuild(SharedResourceMap& resources)
+        {
+            if (!hasTemplate)
+                return ReturnCode::Ok();
+
+            auto engine = enginePool.allocate();
+
+            if (auto res = buildEngine(*engine, resources); res != ReturnCode::Ok())
+                return res;
+
+            builtEngine = engine;
+            engineQueue.push(std::move(engine));
+
+            return ReturnCode::Ok();
+        }
+
+        // Returns the most recently built engine to reach the realtime thread, or nullptr
+        // before the first. Must be called from the realtime thread.
+        Engine* getActiveEngine()
+        {
+            while (engineQueue.size() > 0)
+                engineQueue.pop(activeEngine);
+
+            return activeEngine.get();
+        }
+
+        void processEvents(std::function<void(std::string const&, js::Value)>& eventHandler) override
+        {
+            if (builtEngine)
+                forEachSubgraph(*builtEngine, [&](auto& subgraph) { subgraph.processEvents(eventHandler); });
+        }
+
+        void reset() override
+        {
+            if (builtEngine)
+                forEachSubgraph(*builtEngine, [](auto& subgraph) { subgraph.reset(); });
+        }
+
+        void updateSharedResource(std::string const& name, SharedResourceMap& resources) override
+        {
+            if (builtEngine)
+                forEachSubgraph(*builtEngine, [&](auto& subgraph) { subgraph.updateSharedResource(name, resources); });
+        }
+
+        // Props, as seen from the non-realtime thread
+        NodeTypeFactoryFn<FloatType> factory;
+        SubgraphTemplate subgraphTemplate;
+        std::string currentTemplateKey;
+        bool hasTemplate = false;
+        std::shared_ptr<Engine> builtEngine;
+
+        RefCountedPool<Engine> enginePool;
+        SingleWriterSingleReaderQueue<std::shared_ptr<Engine>> engineQueue;
+        std::shared_ptr<Engine> activeEngine;
+    };
+
+} // namespace elem
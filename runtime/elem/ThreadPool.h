@@ -0,0 +1,137 @@
+#pragma once
+
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+
+namespace elem
+{
+
+    //==============================================================================
+    // A small, general purpose pool of worker threads for non-realtime jobs.
+    //
+    // Jobs are run in the order in which they were enqueued, spread across however
+    // many threads the pool was configured with. The worker threads are started lazily
+    // on the first call to `enqueue` so that simply holding a ThreadPool costs nothing,
+    // which matters for environments without thread support (e.g. a wasm build without
+    // pthreads) that never ask for background work.
+    //
+    // This class must not be used from the realtime thread; enqueueing a job takes a
+    // lock and may allocate.
+    class ThreadPool
+    {
+    public:
+        //==============================================================================
+        // Constructs a pool with the given number of threads. A value of 0 picks
+        // the hardware concurrency of the host machine.
+        explicit ThreadPool(size_t numThreads = 0);
+
+        // Any jobs that have not yet started are discarded, and the destructor waits
+        // for in-flight jobs to finish before joining the worker threads.
+        ~ThreadPool();
+
+        ThreadPool(ThreadPool const&) = delete;
+        ThreadPool& operator= (ThreadPool const&) = delete;
+
+        //==============================================================================
+        // Schedules a job for execution on one of the worker threads.
+        void enqueue(std::function<void()>&& job);
+
+        // Returns the number of jobs that are either queued or currently running
+        size_t numPendingJobs();
+
+    private:
+        //==============================================================================
+        void run();
+
+        std::vector<std::thread> threads;
+        std::deque<std::function<void()>> jobs;
+        std::mutex lock;
+        std::condition_variable cv;
+
+        size_t numThreads = 0;
+        size_t numRunningJobs = 0;
+        bool shouldExit = false;
+    };
+
+    //==============================================================================
+    // Details...
+    inline ThreadPool::ThreadPool(size_t n)
+        : numThreads(n > 0 ? n : std::max(1u, std::thread::hardware_concurrency()))
+    {
+    }
+
+    inline ThreadPool::~ThreadPool()
+    {
+        {
+            std::lock_guard<std::mutex> guard(lock);
+
+            shouldExit = true;
+            jobs.clear();
+        }
+
+        cv.notify_all();
+
+        for (auto& t : threads) {
+            if (t.joinable()) {
+                t.join();
+            }
+        }
+    }
+
+    inline void ThreadPool::enqueue(std::function<void()>&& job)
+    {
+        {
+            std::lock_guard<std::mutex> guard(lock);
+
+            // Lazily bring up our workers the first time we receive a job
+            if (threads.empty()) {
+                for (size_t i = 0; i < numThreads; ++i) {
+                    threads.emplace_back([this]() { run(); });
+                }
+            }
+
+            jobs.push_back(std::move(job));
+        }
+
+        cv.notify_one();
+    }
+
+    inline size_t ThreadPool::numPendingJobs()
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        return jobs.size() + numRunningJobs;
+    }
+
+    inline void ThreadPool::run()
+    {
+        while (true) {
+            std::function<void()> job;
+
+            {
+                std::unique_lock<std::mutex> guard(lock);
+                cv.wait(guard, [this]() { return shouldExit || !jobs.empty(); });
+
+                if (shouldExit)
+                    return;
+
+                job = std::move(jobs.front());
+                jobs.pop_front();
+                numRunningJobs++;
+            }
+
+            job();
+
+            {
+                std::lock_guard<std::mutex> guard(lock);
+                numRunningJobs--;
+            }
+        }
+    }
+
+} // namespace elem
@@ -0,0 +1,117 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <vector>
+
+#include "SharedResource.h"
+#include "Types.h"
+
+#include "builtins/helpers/FFT.h"
+
+
+namespace elem
+{
+
+    // A SharedResource holding one cycle of a waveform as a set of band-limited mip levels.
+    //
+    // Level 0 carries every harmonic the table can represent, and each subsequent level
+    // carries half as many as the one before it, down to a lone fundamental. The levels
+    // are computed once, at construction, by zeroing the upper harmonics of the cycle's
+    // spectrum, so that a reader can pick a level with no harmonics above Nyquist for its
+    // current read rate rather than filtering or oversampling at runtime.
+    //
+    // Each level is exposed through the SharedResource interface as one channel, with
+    // channel 0 the full bandwidth level.
+    class WavetableResource : public SharedResource {
+    public:
+        static constexpr size_t kMinTableSize = 64;
+        static constexpr size_t kMaxTableSize = 65536;
+
+        // Builds the mip levels from a single cycle of the given waveform. Cycles whose
+        // length is not a power of two are first resampled with linear interpolation to
+        // the next power of two size (within [kMinTableSize, kMaxTableSize]).
+        template <typename SampleType>
+        WavetableResource(SampleType const* data, size_t length)
+        {
+            tableSize = kMinTableSize;
+
+            while (tableSize < length && tableSize < kMaxTableSize)
+                tableSize <<= 1;
+
+            using Complex = std::complex<double>;
+            std::vector<Complex> spectrum(tableSize);
+
+            for (size_t i = 0; i < tableSize && length > 0; ++i) {
+                auto const pos = static_cast<double>(i) * static_cast<double>(length) / static_cast<double>(tableSize);
+                auto const left = static_cast<size_t>(pos);
+                auto const right = (left + 1) % length;
+                auto const frac = pos - static_cast<double>(left);
+
+                spectrum[i] = static_cast<double>(data[left]) + frac * (static_cast<double>(data[right]) - static_cast<double>(data[left]));
+            }
+
+            ComplexFFT<double> fft(tableSize);
+            fft.forward(spectrum.data());
+
+            std::vector<Complex> scratch(tableSize);
+
+            for (size_t maxHarmonic = tableSize / 2; maxHarmonic >= 1; maxHarmonic >>= 1) {
+                // The Nyquist bin itself has no distinct negative frequency partner, so the
+                // top level stops one short of it
+                auto const numHarmonics = (maxHarmonic == tableSize / 2) ? maxHarmonic - 1 : maxHarmonic;
+
+                std::fill(scratch.begin(), scratch.end(), Complex(0.0, 0.0));
+                scratch[0] = spectrum[0];
+
+                for (size_t h = 1; h <= numHarmonics; ++h) {
+                    scratch[h] = spectrum[h];
+                    scratch[tableSize - h] = spectrum[tableSize - h];
+                }
+
+                fft.inverse(scratch.data());
+
+                // Each level carries one guard sample equal to its first, so that readers
+                // can interpolate across the wrap point without a modulo
+                std::vector<float> level(tableSize + 1);
+
+                for (size_t i = 0; i < tableSize; ++i) {
+                    level[i] = static_cast<float>(scratch[i].real());
+                }
+
+                level[tableSize] = level[0];
+                levels.push_back(std::move(level));
+            }
+        }
+
+        BufferView<float> getChannelData(size_t channelIndex) override
+        {
+            if (channelIndex < levels.size())
+                return BufferView<float>(levels[channelIndex].data(), tableSize);
+
+            return BufferView<float>(nullptr, 0);
+        }
+
+        size_t numChannels() override {
+            return levels.size();
+        }
+
+        size_t numSamples() override {
+            return tableSize;
+        }
+
+        // Direct access for readers: the given level's data, holding tableSize + 1 samples
+        float const* getLevelData(size_t levelIndex) const {
+            return levels[std::min(levelIndex, levels.size() - 1)].data();
+        }
+
+        size_t getNumLevels() const { return levels.size(); }
+        size_t getTableSize() const { return tableSize; }
+
+    private:
+        std::vector<std::vector<float>> levels;
+        size_t tableSize = 0;
+    };
+
+} // namespace elem
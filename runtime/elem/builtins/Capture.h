@@ -14,10 +14,20 @@ namespace elem
     struct CaptureNode : public GraphNode<FloatType> {
         CaptureNode(NodeId id, FloatType const sr, int const blockSize)
             : GraphNode<FloatType>::GraphNode(id, sr, blockSize),
-              ringBuffer(1, elem::bitceil(static_cast<size_t>(sr)))
+              ringBuffer(std::make_unique<MultiChannelRingBuffer<FloatType>>(1, elem::bitceil(static_cast<size_t>(sr))))
         {
         }
 
+        void prepare(double sr, size_t bs) override
+        {
+            GraphNode<FloatType>::prepare(sr, bs);
+
+            // The ring holds about a second of audio between event polls, so it's resized
+            // for the new rate, keeping whatever the old one hadn't relayed yet
+            drainRing();
+            ringBuffer = std::make_unique<MultiChannelRingBuffer<FloatType>>(1, elem::bitceil(static_cast<size_t>(sr)));
+        }
+
         void process (BlockContext<FloatType> const& ctx) override {
             auto** inputData = ctx.inputData;
             auto* outputData = ctx.outputData[0];
@@ -42,7 +52,7 @@ namespace elem
                 // we propagate the data into the ring
                 if (fallingEdge || scratchSize >= scratchBuffer.size()) {
                     auto const* writeData = scratchBuffer.data();
-                    ringBuffer.write(&writeData, 1, scratchSize);
+                    ringBuffer->write(&writeData, 1, scratchSize);
                     scratchSize = 0;
 
                     // And if it's the falling edge we alert the event processor
@@ -59,17 +69,8 @@ namespace elem
         }
 
         void processEvents(std::function<void(std::string const&, js::Value)>& eventHandler) override {
-            auto const samplesAvailable = ringBuffer.size();
-
-            if (samplesAvailable > 0) {
-                auto currentSize = relayBuffer.size();
-                relayBuffer.resize(currentSize + samplesAvailable);
-
-                auto relayData = relayBuffer.data() + currentSize;
-
-                if (!ringBuffer.read(&relayData, 1, samplesAvailable))
-                    return;
-            }
+            if (!drainRing())
+                return;
 
             if (relayReady.exchange(false)) {
                 // Now we can go ahead and relay the data
@@ -94,8 +95,25 @@ namespace elem
             }
         }
 
+        // Moves everything in the ring onto the end of the relay buffer
+        bool drainRing() {
+            auto const samplesAvailable = ringBuffer->size();
+
+            if (samplesAvailable > 0) {
+                auto currentSize = relayBuffer.size();
+                relayBuffer.resize(currentSize + samplesAvailable);
+
+                auto relayData = relayBuffer.data() + currentSize;
+
+                if (!ringBuffer->read(&relayData, 1, samplesAvailable))
+                    return false;
+            }
+
+            return true;
+        }
+
         Change<FloatType> change;
-        MultiChannelRingBuffer<FloatType> ringBuffer;
+        std::unique_ptr<MultiChannelRingBuffer<FloatType>> ringBuffer;
         std::array<FloatType, 128> scratchBuffer;
         size_t scratchSize = 0;
 
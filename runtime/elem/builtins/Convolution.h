@@ -0,0 +1,357 @@
+#pragma once
+
+#include <system_error>
+
+#include "../BackgroundWorker.h"
+#include "../GraphNode.h"
+#include "../SingleWriterSingleReaderQueue.h"
+
+#include "helpers/BufferUtils.h"
+#include "helpers/PartitionedConvolver.h"
+#include "helpers/RefCountedPool.h"
+
+
+namespace elem
+{
+
+    namespace detail
+    {
+        // A two stage convolver: a head stage of short partitions covering the start of
+        // the impulse response with no added latency, and a tail stage of long partitions
+        // covering the rest.
+        //
+        // The tail stage runs a whole tail block at a time, on each tail block boundary.
+        // Run inline, the tail begins one tail block into the impulse response, so the
+        // block just completed is convolved in time for the very next output block.
+        //
+        // Run in the background, the tail begins two tail blocks in and the head covers
+        // the rest. At each boundary we collect the worker's result for the block before
+        // the one just completed, which is due now, and hand it the block just completed,
+        // whose result isn't due until the next boundary. The worker thereby has a whole
+        // tail block of time for each job, and the audio thread only ever runs the head.
+        //
+        // The audio thread never waits on the worker. If a result isn't ready when it's
+        // due, the next tail block is silent and the block just completed is dropped from
+        // the tail; the late result is discarded when it arrives. Each such overrun is
+        // counted in `numOverruns`.
+        struct TwoStageConvolver {
+            // Starts the worker thread if the tail is to run in the background and we
+            // don't have one yet, returning whether the tail will in fact run in the
+            // background. Must be called off the realtime thread, before `init`.
+            bool prepareWorker(bool wantBackground)
+            {
+                if (wantBackground && !worker) {
+                    // Without thread support we simply run the tail inline
+                    if (!BackgroundWorker::isSupported())
+                        return false;
+
+                    try {
+                        worker = std::make_unique<BackgroundWorker>([this]() {
+                            tail.process(jobInput.data(), jobOutput, tailSize);
+                        });
+                    } catch (std::system_error const&) {
+                        return false;
+                    }
+                }
+
+                return wantBackground;
+            }
+
+            // The length of impulse response the head should cover for the given mode
+            static size_t getHeadLength(size_t tailSize, bool background)
+            {
+                return (background ? 2 : 1) * tailSize;
+            }
+
+            // Sets the convolver up for a new impulse response, laid out with the head length
+            // given by getHeadLength. Must be called off the realtime thread, and only while
+            // the realtime thread isn't processing with it.
+            void init(std::shared_ptr<ConvolutionSpectra const> spectra, bool _background)
+            {
+                // A job may still be running from before the realtime thread let us go
+                if (worker)
+                    worker->waitUntilIdle();
+
+                background = _background;
+                tailSize = spectra->tail.blockSize;
+                hasTail = spectra->tail.numPartitions > 0;
+
+                // The partitions share ownership of the spectra they point into
+                head.init(std::shared_ptr<ConvolutionPartitions const>(spectra, &spectra->head));
+                tail.init(std::shared_ptr<ConvolutionPartitions const>(spectra, &spectra->tail));
+
+                tailInput.assign(tailSize, 0.0f);
+                jobInput.assign(tailSize, 0.0f);
+                tailOutput[0].assign(tailSize, 0.0f);
+                tailOutput[1].assign(tailSize, 0.0f);
+
+                tailPosition = 0;
+                readIndex = 0;
+                discardResult = false;
+                numOverruns = 0;
+            }
+
+            void process(float const* in, float* out, size_t numSamples)
+            {
+                head.process(in, out, numSamples);
+
+                if (!hasTail)
+                    return;
+
+                if (background)
+                    worker->retryWake();
+
+                for (size_t done = 0; done < numSamples; /* no increment */) {
+                    auto const count = std::min(numSamples - done, tailSize - tailPosition);
+                    auto const* tailOut = tailOutput[readIndex].data() + tailPosition;
+
+                    std::copy_n(in + done, count, tailInput.data() + tailPosition);
+
+                    for (size_t i = 0; i < count; ++i)
+                        out[done + i] += tailOut[i];
+
+                    tailPosition += count;
+                    done += count;
+
+                    if (tailPosition == tailSize) {
+                        tailPosition = 0;
+                        finishTailBlock();
+                    }
+                }
+            }
+
+            void finishTailBlock()
+            {
+                auto const writeIndex = readIndex ^ 1;
+
+                if (!background) {
+                    tail.process(tailInput.data(), tailOutput[writeIndex].data(), tailSize);
+                    readIndex = writeIndex;
+                    return;
+                }
+
+                if (!worker->isIdle()) {
+                    std::fill(tailOutput[readIndex].begin(), tailOutput[readIndex].end(), 0.0f);
+                    discardResult = true;
+                    ++numOverruns;
+                    return;
+                }
+
+                // The worker's output from the last boundary is the next block's tail, and
+                // the buffer we were reading is free for the worker's next result. Swapping
+                // the input vectors only exchanges their storage.
+                readIndex = writeIndex;
+
+                if (discardResult) {
+                    std::fill(tailOutput[readIndex].begin(), tailOutput[readIndex].end(), 0.0f);
+                    discardResult = false;
+                }
+
+                jobOutput = tailOutput[readIndex ^ 1].data();
+                std::swap(tailInput, jobInput);
+
+                worker->trigger();
+            }
+
+            PartitionedConvolver head;
+            PartitionedConvolver tail;
+
+            bool hasTail = false;
+            bool background = false;
+            size_t tailSize = 0;
+
+            std::vector<float> tailInput;
+            std::vector<float> jobInput;
+            std::vector<float> tailOutput[2];
+            float* jobOutput = nullptr;
+
+            size_t tailPosition = 0;
+            size_t readIndex = 0;
+
+            bool discardResult = false;
+            size_t numOverruns = 0;
+
+            // Declared last so that it's destroyed first, and with it any job in progress
+            // finished, before the state that job works on
+            std::unique_ptr<BackgroundWorker> worker;
+        };
+    }
+
+    // Convolves its input with the first channel of the impulse response named by the
+    // `path` property, using a two stage partitioned convolver. The spectra of the impulse
+    // response are computed once per partition layout and shared by every convolve node
+    // using it.
+    //
+    // The `headSize` and `tailSize` properties set the partition sizes of the two stages,
+    // which must be powers of two. The head runs with no added latency at any block size,
+    // and is cheapest when the head size is close to the block size. The tail takes over
+    // after one tail block (or two, in the background) and costs one transform per tail
+    // block, so longer tails mean less work overall but a larger head and a larger spike
+    // of work once every tail block.
+    //
+    // With the `background` property set, and a tail size of at least the block size, tail
+    // blocks are computed on a worker thread rather than on the audio thread, leaving the
+    // audio thread only the head to run. The output is the same either way, unless the
+    // worker falls behind: a tail block that isn't ready in time is left out rather than
+    // waited on, and the node relays a "convolve" event with the number of blocks left out
+    // since the last one. Offline renders, which run faster than real time, should leave
+    // `background` off. Environments without threads fall back to running the tail inline.
+    template <typename FloatType>
+    struct ConvolutionNode : public GraphNode<FloatType> {
+        ConvolutionNode(NodeId id, double sr, int const blockSize)
+            : GraphNode<FloatType>::GraphNode(id, sr, blockSize)
+        {
+            if constexpr (std::is_same_v<FloatType, double>) {
+                scratchIn.resize(blockSize);
+                scratchOut.resize(blockSize);
+            }
+        }
+
+        static constexpr size_t kMinPartitionSize = 16;
+        static constexpr size_t kMaxPartitionSize = 65536;
+
+        int setProperty(std::string const& key, js::Value const& val, SharedResourceMap& resources) override
+        {
+            if (key == "path") {
+                if (!val.isString())
+                    return ReturnCode::InvalidPropertyType();
+
+                if (!resources.has((js::String) val))
+                    return ReturnCode::InvalidPropertyValue();
+
+                path = (js::String) val;
+                convolverDirty = true;
+            }
+
+            if (key == "headSize" || key == "tailSize") {
+                if (!val.isNumber())
+                    return ReturnCode::InvalidPropertyType();
+
+                auto const n = static_cast<size_t>((js::Number) val);
+
+                if (n < kMinPartitionSize || n > kMaxPartitionSize || (n & (n - 1)) != 0)
+                    return ReturnCode::InvalidPropertyValue();
+
+                (key == "headSize" ? headSize : tailSize) = n;
+                convolverDirty = true;
+            }
+
+            if (key == "background") {
+                if (!val.isBool())
+                    return ReturnCode::InvalidPropertyType();
+
+                background = (js::Boolean) val;
+                convolverDirty = true;
+            }
+
+            return GraphNode<FloatType>::setProperty(key, val);
+        }
+
+        // Each of the props above invalidates the convolver, and the frontend sends them
+        // together, so we rebuild once for the whole batch rather than once per prop
+        void commitProperties(SharedResourceMap& resources) override
+        {
+            if (convolverDirty) {
+                convolverDirty = false;
+                updateConvolver(resources);
+            }
+        }
+
+        void updateConvolver(SharedResourceMap& resources)
+        {
+            // Nothing to build until we've seen an impulse response
+            if (path.empty())
+                return;
+
+            auto co = convolverPool.allocate();
+
+            // The worker only gets time between blocks, so a tail block shorter than the
+            // block size is always run inline
+            auto const wantBackground = background && tailSize >= GraphNode<FloatType>::getBlockSize();
+            auto const inBackground = co->prepareWorker(wantBackground);
+            auto const headLength = detail::TwoStageConvolver::getHeadLength(tailSize, inBackground);
+
+            // Every convolver on this impulse response with the same layout shares one copy
+            // of its spectra
+            auto ref = resources.getDerived(path, ConvolutionSpectra::getKey(headSize, tailSize, headLength), [=](SharedResourcePtr const& source) -> SharedResourcePtr {
+                auto bufferView = source->getChannelData(0);
+                return std::make_shared<ConvolutionSpectra>(bufferView.data(), bufferView.size(), headSize, tailSize, headLength);
+            });
+
+            auto spectra = std::dynamic_pointer_cast<ConvolutionSpectra const>(ref);
+
+            if (spectra == nullptr)
+                return;
+
+            co->init(std::move(spectra), inBackground);
+            convolverQueue.push(std::move(co));
+        }
+
+        void process (BlockContext<FloatType> const& ctx) override {
+            auto** inputData = ctx.inputData;
+            auto* outputData = ctx.outputData[0];
+            auto numChannels = ctx.numInputChannels;
+            auto numSamples = ctx.numSamples;
+
+            // First order of business: grab the most recent convolver to use if
+            // there's anything in the queue. This behavior means that changing the convolver
+            // impulse response while playing will cause a discontinuity.
+            while (convolverQueue.size() > 0)
+                convolverQueue.pop(convolver);
+
+            if (numChannels == 0 || convolver == nullptr)
+                return (void) std::fill_n(outputData, numSamples, FloatType(0));
+
+            if constexpr (std::is_same_v<FloatType, float>) {
+                convolver->process(inputData[0], outputData, numSamples);
+            }
+
+            if constexpr (std::is_same_v<FloatType, double>) {
+                auto* scratchDataIn = scratchIn.data();
+                auto* scratchDataOut = scratchOut.data();
+
+                for (size_t start = 0; start < numSamples; start += scratchIn.size()) {
+                    auto const count = std::min(scratchIn.size(), numSamples - start);
+
+                    util::copy_cast_n<double, float>(inputData[0] + start, count, scratchDataIn);
+                    convolver->process(scratchDataIn, scratchDataOut, count);
+                    util::copy_cast_n<float, double>(scratchDataOut, count, outputData + start);
+                }
+            }
+
+            if (convolver->numOverruns > 0) {
+                overruns.fetch_add(convolver->numOverruns, std::memory_order_relaxed);
+                convolver->numOverruns = 0;
+            }
+        }
+
+        void processEvents(std::function<void(std::string const&, js::Value)>& eventHandler) override
+        {
+            auto const n = overruns.exchange(0, std::memory_order_relaxed);
+
+            if (n > 0) {
+                eventHandler("convolve", js::Object({
+                    {"source", GraphNode<FloatType>::getPropertyWithDefault("name", js::Value())},
+                    {"overruns", static_cast<js::Number>(n)},
+                }));
+            }
+        }
+
+        // Props, as seen from the non-realtime thread
+        std::string path;
+        size_t headSize = 512;
+        size_t tailSize = 4096;
+        bool background = false;
+        bool convolverDirty = false;
+
+        RefCountedPool<detail::TwoStageConvolver> convolverPool;
+        SingleWriterSingleReaderQueue<std::shared_ptr<detail::TwoStageConvolver>> convolverQueue;
+        std::shared_ptr<detail::TwoStageConvolver> convolver;
+
+        std::atomic<size_t> overruns = 0;
+
+        std::vector<float> scratchIn;
+        std::vector<float> scratchOut;
+    };
+
+} // namespace elem
@@ -30,6 +30,14 @@ namespace elem
             return active() || !fade.settled();
         }
 
+        void prepare(double sr, size_t bs) override
+        {
+            GraphNode<FloatType>::prepare(sr, bs);
+
+            fade.setFadeInTimeMs(sr, GraphNode<FloatType>::getPropertyWithDefault("fadeInMs", js::Number(20)));
+            fade.setFadeOutTimeMs(sr, GraphNode<FloatType>::getPropertyWithDefault("fadeOutMs", js::Number(20)));
+        }
+
         int setProperty(std::string const& key, js::Value const& val) override
         {
             if (key == "active") {
@@ -0,0 +1,202 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <string>
+
+#include "../GraphNode.h"
+#include "../Subgraph.h"
+
+
+namespace elem
+{
+
+    namespace detail
+    {
+        template <typename FloatType>
+        struct DecimateEngine {
+            SubgraphInstance<FloatType> subgraph;
+            size_t factor = 1;
+
+            // The decimated inputs
+            std::vector<std::vector<FloatType>> inputs;
+            std::vector<FloatType const*> inputPtrs;
+
+            // The last four subgraph outputs of each channel, oldest first, and how far
+            // we are between two of them
+            std::vector<std::array<FloatType, 4>> history;
+            size_t phase = 0;
+        };
+    }
+
+    // A decimating container: renders the subgraph given in its `template` property at
+    // 1/factor of the sample rate, for modulation sources like LFOs, envelopes and
+    // modulation matrices which don't need to run at the audio rate.
+    //
+    //   el.mc.decimate({factor: 16}, el.mul(el.in({channel: 0}), el.cycle(2)), depth)
+    //
+    // The container's children are the subgraph's inputs, which its template reads with
+    // `in` nodes. They're sampled once every `factor` samples, the subgraph runs over
+    // blocks `factor` times shorter with its nodes seeing the reduced sample rate, and each
+    // of its outputs is interpolated back up to the container's outputs.
+    //
+    // The `interpolation` property picks between "linear" interpolation, which delays the
+    // subgraph's output by `factor` samples, and "cubic" (Catmull-Rom), which is smoother
+    // through the corners of the control signal and delays it by 2 * factor samples.
+    template <typename FloatType>
+    struct DecimateNode : public SubgraphContainerNode<FloatType, detail::DecimateEngine<FloatType>> {
+        using Engine = detail::DecimateEngine<FloatType>;
+        using Container = SubgraphContainerNode<FloatType, Engine>;
+        using Container::Container;
+
+        static constexpr size_t kMaxFactor = 256;
+
+        int setProperty(std::string const& key, js::Value const& val, SharedResourceMap& resources) override
+        {
+            if (key == "factor") {
+                if (!val.isNumber())
+                    return ReturnCode::InvalidPropertyType();
+
+                auto const f = static_cast<size_t>((js::Number) val);
+
+                if (f < 1 || f > kMaxFactor)
+                    return ReturnCode::InvalidPropertyValue();
+
+                if (f != factor) {
+                    factor = f;
+
+                    if (auto res = Container::rebuild(resources); res != ReturnCode::Ok())
+                        return res;
+                }
+            }
+
+            if (key == "interpolation") {
+                if (!val.isString())
+                    return ReturnCode::InvalidPropertyType();
+
+                auto const mode = (js::String) val;
+
+                if (mode != "linear" && mode != "cubic")
+                    return ReturnCode::InvalidPropertyValue();
+
+                cubic.store(mode == "cubic");
+            }
+
+            return Container::setProperty(key, val, resources);
+        }
+
+        int buildEngine(Engine& engine, SharedResourceMap& resources) override
+        {
+            // Enough for the most subgraph samples any one block can ask for
+            auto const blockSize = (GraphNode<FloatType>::getBlockSize() + factor - 1) / factor;
+            auto const res = engine.subgraph.build(Container::subgraphTemplate, Container::factory, GraphNode<FloatType>::getSampleRate() / double(factor), static_cast<int>(blockSize), resources);
+
+            if (res != ReturnCode::Ok())
+                return res;
+
+            auto const numInputs = Container::subgraphTemplate.getNumInputs();
+
+            engine.factor = factor;
+            engine.inputs.assign(numInputs, std::vector<FloatType>(blockSize));
+            engine.inputPtrs.resize(numInputs);
+
+            for (size_t c = 0; c < numInputs; ++c)
+                engine.inputPtrs[c] = engine.inputs[c].data();
+
+            engine.history.assign(engine.subgraph.getNumOutputs(), {});
+            engine.phase = 0;
+
+            return ReturnCode::Ok();
+        }
+
+        void forEachSubgraph(Engine& engine, std::function<void(SubgraphInstance<FloatType>&)> const& fn) override
+        {
+            fn(engine.subgraph);
+        }
+
+        void process (BlockContext<FloatType> const& ctx) override {
+            auto** inputData = ctx.inputData;
+            auto** outputData = ctx.outputData;
+            auto numChildren = ctx.numInputChannels;
+            auto numSamples = ctx.numSamples;
+
+            auto* activeEngine = Container::getActiveEngine();
+
+            if (activeEngine == nullptr) {
+                for (size_t j = 0; j < ctx.numOutputChannels; ++j)
+                    std::fill_n(outputData[j], numSamples, FloatType(0));
+
+                return;
+            }
+
+            auto& engine = *activeEngine;
+            auto const N = engine.factor;
+            auto const phase = engine.phase;
+
+            // The subgraph takes a step at every sample where the phase wraps to zero
+            auto const first = (N - phase) % N;
+            auto const numSteps = first < numSamples ? (numSamples - first + N - 1) / N : size_t(0);
+
+            for (size_t c = 0; c < engine.inputs.size(); ++c) {
+                auto* dest = engine.inputs[c].data();
+
+                if (c >= numChildren) {
+                    std::fill_n(dest, numSteps, FloatType(0));
+                    continue;
+                }
+
+                for (size_t k = 0; k < numSteps; ++k)
+                    dest[k] = inputData[c][first + k * N];
+            }
+
+            if (numSteps > 0)
+                engine.subgraph.process(engine.inputPtrs.data(), engine.inputs.size(), numSteps, ctx.userData);
+
+            auto const useCubic = cubic.load();
+            auto const scale = FloatType(1) / FloatType(N);
+
+            for (size_t c = 0; c < ctx.numOutputChannels; ++c) {
+                if (c >= engine.history.size()) {
+                    std::fill_n(outputData[c], numSamples, FloatType(0));
+                    continue;
+                }
+
+                auto const* steps = engine.subgraph.getOutput(c);
+                auto& h = engine.history[c];
+                auto* out = outputData[c];
+                auto p = phase;
+                size_t k = 0;
+
+                for (size_t i = 0; i < numSamples; ++i) {
+                    if (p == 0)
+                        h = {h[1], h[2], h[3], steps[k++]};
+
+                    auto const t = FloatType(p) * scale;
+
+                    if (useCubic) {
+                        // Catmull-Rom, between the two middle points
+                        auto const a = FloatType(0.5) * (h[3] - h[0]) + FloatType(1.5) * (h[1] - h[2]);
+                        auto const b = h[0] - FloatType(2.5) * h[1] + FloatType(2) * h[2] - FloatType(0.5) * h[3];
+                        auto const d = FloatType(0.5) * (h[2] - h[0]);
+
+                        out[i] = ((a * t + b) * t + d) * t + h[1];
+                    } else {
+                        out[i] = h[2] + t * (h[3] - h[2]);
+                    }
+
+                    if (++p == N)
+                        p = 0;
+                }
+            }
+
+            engine.phase = (phase + numSamples) % N;
+        }
+
+        // Props, as seen from the non-realtime thread
+        size_t factor = 1;
+
+        std::atomic<bool> cubic = false;
+    };
+
+} // namespace elem
@@ -53,7 +53,17 @@ namespace elem
         VariableDelayNode(NodeId id, FloatType const sr, int const blockSize)
             : GraphNode<FloatType>::GraphNode(id, sr, blockSize)
         {
-            (void) setProperty("size", js::Value((js::Number) blockSize));
+            allocate(blockSize);
+        }
+
+        // Without a size property of its own, the line defaults to the block size,
+        // which isn't recorded as a property for the runtime to hand back to us
+        void prepare(double sr, size_t bs) override
+        {
+            GraphNode<FloatType>::prepare(sr, bs);
+
+            if (GraphNode<FloatType>::getProperties().count("size") == 0)
+                allocate(static_cast<int>(bs));
         }
 
         int setProperty(std::string const& key, js::Value const& val) override
@@ -62,23 +72,27 @@ namespace elem
                 if (!val.isNumber())
                     return ReturnCode::InvalidPropertyType();
 
-                auto const size = static_cast<int>((js::Number) val);
-                auto data = bufferPool.allocate();
+                allocate(static_cast<int>((js::Number) val));
+            }
 
-                // The buffer that we get from the pool may have been
-                // previously used for a different delay buffer. Need to
-                // resize here and then overwrite below.
-                data->resize(size);
+            return GraphNode<FloatType>::setProperty(key, val);
+        }
 
-                for (size_t i = 0; i < data->size(); ++i)
-                    data->at(i) = FloatType(0);
+        void allocate(int size)
+        {
+            auto data = bufferPool.allocate();
 
-                // Finally, we push our new buffer into the event
-                // queue for the realtime thread.
-                bufferQueue.push(std::move(data));
-            }
+            // The buffer that we get from the pool may have been
+            // previously used for a different delay buffer. Need to
+            // resize here and then overwrite below.
+            data->resize(size);
 
-            return GraphNode<FloatType>::setProperty(key, val);
+            for (size_t i = 0; i < data->size(); ++i)
+                data->at(i) = FloatType(0);
+
+            // Finally, we push our new buffer into the event
+            // queue for the realtime thread.
+            bufferQueue.push(std::move(data));
         }
 
         void process (BlockContext<FloatType> const& ctx) override {
@@ -180,7 +194,18 @@ namespace elem
             : GraphNode<FloatType>::GraphNode(id, sr, bs)
             , blockSize(bs)
         {
-            (void) setProperty("size", js::Value((js::Number) blockSize));
+            allocate(blockSize);
+        }
+
+        // The line is reallocated for the new block size when the runtime hands us our
+        // size property again, or here if we're still on the block size default
+        void prepare(double sr, size_t bs) override
+        {
+            GraphNode<FloatType>::prepare(sr, bs);
+            blockSize = static_cast<int>(bs);
+
+            if (GraphNode<FloatType>::getProperties().count("size") == 0)
+                allocate(blockSize);
         }
 
         int setProperty(std::string const& key, js::Value const& val) override
@@ -189,32 +214,36 @@ namespace elem
                 if (!val.isNumber())
                     return ReturnCode::InvalidPropertyType();
 
-                // Here we make sure that we allocate at least one block size
-                // more than the desired delay length so that we can run our write
-                // pointer freely forward each block, never risking clobbering. Then
-                // we round up to the next power of two for bit masking tricks around
-                // the delay line length.
-                auto const len = static_cast<int>((js::Number) val);
-                auto const size = elem::bitceil(len + blockSize);
-                auto data = bufferPool.allocate();
-
-                // The buffer that we get from the pool may have been
-                // previously used for a different delay buffer. Need to
-                // resize here and then overwrite below.
-                data->resize(size);
-
-                for (size_t i = 0; i < data->size(); ++i)
-                    data->at(i) = FloatType(0);
-
-                // Finally, we push our new buffer into the event
-                // queue for the realtime thread.
-                bufferQueue.push(std::move(data));
-                length.store(len);
+                allocate(static_cast<int>((js::Number) val));
             }
 
             return GraphNode<FloatType>::setProperty(key, val);
         }
 
+        void allocate(int len)
+        {
+            // Here we make sure that we allocate at least one block size
+            // more than the desired delay length so that we can run our write
+            // pointer freely forward each block, never risking clobbering. Then
+            // we round up to the next power of two for bit masking tricks around
+            // the delay line length.
+            auto const size = elem::bitceil(len + blockSize);
+            auto data = bufferPool.allocate();
+
+            // The buffer that we get from the pool may have been
+            // previously used for a different delay buffer. Need to
+            // resize here and then overwrite below.
+            data->resize(size);
+
+            for (size_t i = 0; i < data->size(); ++i)
+                data->at(i) = FloatType(0);
+
+            // Finally, we push our new buffer into the event
+            // queue for the realtime thread.
+            bufferQueue.push(std::move(data));
+            length.store(len);
+        }
+
         void process (BlockContext<FloatType> const& ctx) override {
             auto** inputData = ctx.inputData;
             auto* outputData = ctx.outputData[0];
@@ -271,4 +300,231 @@ namespace elem
         int blockSize = 0;
     };
 
+    // A multi-tap delay line: one input written once into a single ring buffer, and
+    // any number of taps reading from it.
+    //
+    //   el.mc.multitap({size: 44100, times: [4410, 11025], gains: [0.5, 0.25]}, x)
+    //
+    // The tap times, in samples, and gains come either from the `times` and `gains`
+    // properties, or from signals: with children beyond the input, they are read as a
+    // (time, gain) pair per tap and the properties are ignored. Signal tap times may be
+    // fractional, and are read with linear interpolation as in `el.delay`. Tap times are
+    // clamped to the `size` property.
+    //
+    // Each tap is written to its own output channel, or, with the `sum` property set,
+    // every tap is summed into the first output channel.
+    //
+    // Compared to a delay node per tap, the input is only stored once, the ring buffer is
+    // sized to a power of two so that reads wrap with a mask, and each tap reads a run
+    // of contiguous samples per block.
+    template <typename FloatType>
+    struct MultiTapDelayNode : public GraphNode<FloatType> {
+        MultiTapDelayNode(NodeId id, FloatType const sr, int const bs)
+            : GraphNode<FloatType>::GraphNode(id, sr, bs)
+            , blockSize(bs)
+        {
+            allocate(blockSize);
+        }
+
+        // As with sdelay, the size property reallocates the line, and the block size
+        // default is redone here
+        void prepare(double sr, size_t bs) override
+        {
+            GraphNode<FloatType>::prepare(sr, bs);
+            blockSize = static_cast<int>(bs);
+
+            if (GraphNode<FloatType>::getProperties().count("size") == 0)
+                allocate(blockSize);
+        }
+
+        struct Tap {
+            FloatType time = 0;
+            FloatType gain = 1;
+        };
+
+        // The ring travels with the longest delay it was sized for, so the realtime
+        // thread never pairs a buffer with another one's length
+        struct DelayLine {
+            std::vector<FloatType> data;
+            int length = 0;
+        };
+
+        int setProperty(std::string const& key, js::Value const& val) override
+        {
+            if (key == "size") {
+                if (!val.isNumber())
+                    return ReturnCode::InvalidPropertyType();
+
+                auto const len = static_cast<int>((js::Number) val);
+
+                if (len < 0)
+                    return ReturnCode::InvalidPropertyValue();
+
+                allocate(len);
+            }
+
+            if (key == "times" || key == "gains") {
+                if (!val.isArray())
+                    return ReturnCode::InvalidPropertyType();
+
+                auto& arr = val.getArray();
+
+                for (auto const& v : arr) {
+                    if (!v.isNumber())
+                        return ReturnCode::InvalidPropertyType();
+                }
+
+                auto& target = (key == "times" ? times : gains);
+                target.resize(arr.size());
+
+                for (size_t i = 0; i < arr.size(); ++i)
+                    target[i] = FloatType((js::Number) arr[i]);
+
+                auto data = tapPool.allocate();
+
+                // Taps without a gain of their own pass through unchanged
+                data->resize(times.size());
+
+                for (size_t i = 0; i < times.size(); ++i)
+                    data->at(i) = Tap { times[i], i < gains.size() ? gains[i] : FloatType(1) };
+
+                tapQueue.push(std::move(data));
+            }
+
+            if (key == "sum") {
+                if (!val.isBool())
+                    return ReturnCode::InvalidPropertyType();
+
+                sum.store((js::Boolean) val);
+            }
+
+            return GraphNode<FloatType>::setProperty(key, val);
+        }
+
+        void process (BlockContext<FloatType> const& ctx) override {
+            auto** inputData = ctx.inputData;
+            auto** outputData = ctx.outputData;
+            auto numChannels = ctx.numInputChannels;
+            auto numOutChannels = ctx.numOutputChannels;
+            auto numSamples = ctx.numSamples;
+
+            // First order of business: grab the most recent delay buffer and taps to use
+            // if there's anything in the queues
+            while (bufferQueue.size() > 0) {
+                bufferQueue.pop(activeBuffer);
+                writeIndex = 0;
+            }
+
+            while (tapQueue.size() > 0)
+                tapQueue.pop(activeTaps);
+
+            for (size_t j = 0; j < numOutChannels; ++j)
+                std::fill_n(outputData[j], numSamples, FloatType(0));
+
+            // If we don't have the inputs we need, we bail here with the zeroed buffers
+            // hoping to prevent unexpected signals.
+            if (numChannels < 1 || activeBuffer == nullptr || activeBuffer->data.empty())
+                return;
+
+            auto const numSignalTaps = (numChannels - 1) / 2;
+            auto const numTaps = numSignalTaps > 0 ? numSignalTaps : (activeTaps ? activeTaps->size() : size_t(0));
+            auto const summing = sum.load();
+
+            auto const size = static_cast<int>(activeBuffer->data.size());
+            auto const mask = size - 1;
+            auto const len = activeBuffer->length;
+            auto const maxTime = FloatType(len);
+
+            auto* delayData = activeBuffer->data.data();
+
+            // The ring holds a whole block beyond the longest delay, so we can write that
+            // much input before reading. Larger blocks than we were built for go in pieces,
+            // at least one sample at a time.
+            auto const chunkSize = static_cast<size_t>(std::max(size - len, 1));
+
+            for (size_t start = 0; start < numSamples; start += chunkSize) {
+                auto const count = std::min(chunkSize, numSamples - start);
+
+                for (size_t i = 0; i < count; ++i)
+                    delayData[(writeIndex + static_cast<int>(i)) & mask] = inputData[0][start + i];
+
+                for (size_t t = 0; t < numTaps; ++t) {
+                    auto const channel = summing ? size_t(0) : t;
+
+                    if (channel >= numOutChannels)
+                        break;
+
+                    auto* out = outputData[channel] + start;
+
+                    if (numSignalTaps > 0) {
+                        auto const* time = inputData[1 + 2 * t] + start;
+                        auto const* gain = inputData[2 + 2 * t] + start;
+
+                        for (size_t i = 0; i < count; ++i) {
+                            auto const offset = std::clamp(time[i], FloatType(0), maxTime);
+                            auto const readFrac = FloatType(size + writeIndex + static_cast<int>(i)) - offset;
+                            auto const readLeft = static_cast<int>(readFrac);
+                            auto const frac = readFrac - FloatType(readLeft);
+
+                            auto const left = delayData[readLeft & mask];
+                            auto const right = delayData[(readLeft + 1) & mask];
+
+                            out[i] += gain[i] * (left + frac * (right - left));
+                        }
+
+                        continue;
+                    }
+
+                    // Property taps split their time once per block into a whole sample
+                    // offset and the fraction between its neighbours
+                    auto const& tap = activeTaps->at(t);
+                    auto const offset = std::clamp(tap.time, FloatType(0), maxTime);
+                    auto const whole = static_cast<int>(std::ceil(offset));
+                    auto const frac = FloatType(whole) - offset;
+                    auto const readStart = size + writeIndex - whole;
+
+                    for (size_t i = 0; i < count; ++i) {
+                        auto const left = delayData[(readStart + static_cast<int>(i)) & mask];
+                        auto const right = delayData[(readStart + static_cast<int>(i) + 1) & mask];
+
+                        out[i] += tap.gain * (left + frac * (right - left));
+                    }
+                }
+
+                writeIndex = (writeIndex + static_cast<int>(count)) & mask;
+            }
+        }
+
+        void allocate(int len)
+        {
+            // As with sdelay, we allocate at least one block more than the longest
+            // delay so that we can write a whole block ahead of the taps reading it
+            auto const size = elem::bitceil(len + blockSize);
+            auto line = bufferPool.allocate();
+
+            line->data.assign(size, FloatType(0));
+            line->length = len;
+
+            bufferQueue.push(std::move(line));
+        }
+
+        using TapSet = std::vector<Tap>;
+
+        // Props, as seen from the non-realtime thread
+        std::vector<FloatType> times;
+        std::vector<FloatType> gains;
+
+        RefCountedPool<DelayLine> bufferPool;
+        SingleWriterSingleReaderQueue<std::shared_ptr<DelayLine>> bufferQueue;
+        std::shared_ptr<DelayLine> activeBuffer;
+
+        RefCountedPool<TapSet> tapPool;
+        SingleWriterSingleReaderQueue<std::shared_ptr<TapSet>> tapQueue;
+        std::shared_ptr<TapSet> activeTaps;
+
+        std::atomic<bool> sum = false;
+        int writeIndex = 0;
+        int blockSize = 0;
+    };
+
 } // namespace elem
@@ -0,0 +1,339 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <limits>
+
+#include "../GraphNode.h"
+#include "../SingleWriterSingleReaderQueue.h"
+
+#include "helpers/FastMath.h"
+#include "helpers/RefCountedPool.h"
+#include "helpers/SIMD.h"
+
+
+namespace elem
+{
+
+    // A multichannel compressor, limiter and gate.
+    //
+    // The first `channels` children are the signals to process, each written to the
+    // matching output channel. Any children beyond those are a sidechain; without one
+    // the node listens to the signals themselves. In either case the detector follows the
+    // loudest of the channels it listens to, and every channel gets the same gain, which
+    // keeps the stereo (or surround) image steady.
+    //
+    // The detector is a peak follower with `attack` and `release` times in milliseconds.
+    // Its level sets the gain through a static curve in decibels, given by the `mode`,
+    // `threshold`, `ratio` and `knee` properties: "compressor" (the default) turns signals
+    // above the threshold down by the ratio; "limiter" holds them at the threshold; and
+    // "gate" expands signals below the threshold downward by the ratio, with `range`
+    // limiting how far. The knee, in decibels, rounds the curve off quadratically either
+    // side of the threshold.
+    //
+    // The curve is evaluated in SIMD lanes across chunks of the block, and skipped entirely
+    // for chunks which stay on its unity gain side, so a compressor idling below its
+    // threshold computes no logarithms at all.
+    //
+    // With `lookahead` set, in milliseconds, the signals are delayed by that long while the
+    // detector hears them undelayed, so that gain reduction is already in place by the
+    // time a transient comes through.
+    template <typename FloatType>
+    struct DynamicsNode : public GraphNode<FloatType> {
+        DynamicsNode(NodeId id, double sr, int const blockSize)
+            : GraphNode<FloatType>::GraphNode(id, sr, blockSize)
+        {
+            updateCoefficients();
+            updateState();
+        }
+
+        void prepare(double sr, size_t bs) override
+        {
+            GraphNode<FloatType>::prepare(sr, bs);
+
+            updateCoefficients();
+            updateState();
+        }
+
+        using Vec = simd::Vec<FloatType>;
+
+        static constexpr size_t kChunkSize = 64;
+        static constexpr double kMaxLookaheadMs = 1000.0;
+
+        enum class Mode {
+            Compressor = 0,
+            Limiter = 1,
+            Gate = 2,
+        };
+
+        // The lookahead delay lines, one power of two ring per channel
+        struct State {
+            size_t numChannels = 0;
+            size_t lookahead = 0;
+            size_t mask = 0;
+            size_t writePosition = 0;
+            std::vector<std::vector<FloatType>> rings;
+        };
+
+        int setProperty(std::string const& key, js::Value const& val) override
+        {
+            if (key == "mode") {
+                if (!val.isString())
+                    return ReturnCode::InvalidPropertyType();
+
+                auto const m = (js::String) val;
+
+                if (m != "compressor" && m != "limiter" && m != "gate")
+                    return ReturnCode::InvalidPropertyValue();
+
+                _mode.store(m == "limiter" ? Mode::Limiter : (m == "gate" ? Mode::Gate : Mode::Compressor));
+            }
+
+            if (key == "threshold" || key == "ratio" || key == "knee" || key == "range" || key == "attack" || key == "release") {
+                if (!val.isNumber())
+                    return ReturnCode::InvalidPropertyType();
+
+                auto const v = (js::Number) val;
+
+                if (key == "ratio" && v < 1.0)
+                    return ReturnCode::InvalidPropertyValue();
+
+                if ((key == "knee" || key == "attack" || key == "release") && v < 0.0)
+                    return ReturnCode::InvalidPropertyValue();
+
+                if (key == "range" && v > 0.0)
+                    return ReturnCode::InvalidPropertyValue();
+
+                if (key == "threshold") thresholdDb = v;
+                if (key == "ratio") ratio = v;
+                if (key == "knee") kneeDb = v;
+                if (key == "range") rangeDb = v;
+                if (key == "attack") attackMs = v;
+                if (key == "release") releaseMs = v;
+
+                updateCoefficients();
+            }
+
+            if (key == "channels" || key == "lookahead") {
+                if (!val.isNumber())
+                    return ReturnCode::InvalidPropertyType();
+
+                auto const v = (js::Number) val;
+
+                if (key == "channels" && v < 1.0)
+                    return ReturnCode::InvalidPropertyValue();
+
+                if (key == "lookahead" && (v < 0.0 || v > kMaxLookaheadMs))
+                    return ReturnCode::InvalidPropertyValue();
+
+                if (key == "channels") numChannels = static_cast<size_t>(v);
+                if (key == "lookahead") lookaheadMs = v;
+
+                updateState();
+            }
+
+            return GraphNode<FloatType>::setProperty(key, val);
+        }
+
+        void updateCoefficients()
+        {
+            auto const sr = GraphNode<FloatType>::getSampleRate();
+
+            // Time constants of 0 mean the detector follows its input instantly
+            auto const pole = [sr](double ms) {
+                return ms > 0.0 ? std::exp(-1.0 / (0.001 * ms * sr)) : 0.0;
+            };
+
+            _threshold.store(FloatType(thresholdDb));
+            _knee.store(FloatType(kneeDb));
+            _range.store(FloatType(rangeDb));
+            _ratio.store(FloatType(ratio));
+            _attackPole.store(FloatType(pole(attackMs)));
+            _releasePole.store(FloatType(pole(releaseMs)));
+        }
+
+        void updateState()
+        {
+            auto state = statePool.allocate();
+            auto const lookahead = static_cast<size_t>(std::round(0.001 * lookaheadMs * GraphNode<FloatType>::getSampleRate()));
+
+            size_t ringSize = 1;
+
+            while (ringSize < lookahead + kChunkSize)
+                ringSize <<= 1;
+
+            state->numChannels = numChannels;
+            state->lookahead = lookahead;
+            state->mask = ringSize - 1;
+            state->writePosition = 0;
+            state->rings.resize(numChannels);
+
+            for (auto& ring : state->rings)
+                ring.assign(lookahead > 0 ? ringSize : 0, FloatType(0));
+
+            stateQueue.push(std::move(state));
+        }
+
+        // Maps detector levels to gains over one chunk, in place
+        void computeGains(Mode m, FloatType* levels, size_t count)
+        {
+            auto const threshold = _threshold.load();
+            auto const knee = _knee.load();
+            auto const ratio = _ratio.load();
+            auto const halfKnee = FloatType(0.5) * knee;
+
+            // The level beyond which the curve departs from unity gain, where we can tell
+            // without any logarithms whether the chunk needs the curve at all
+            auto const edge = std::pow(FloatType(10), (m == Mode::Gate ? threshold + halfKnee : threshold - halfKnee) / FloatType(20));
+
+            auto const needsCurve = m == Mode::Gate
+                ? *std::min_element(levels, levels + count) < edge
+                : *std::max_element(levels, levels + count) > edge;
+
+            if (!needsCurve)
+                return (void) std::fill_n(levels, count, FloatType(1));
+
+            // The slope of the gain reduction against the level's distance past the
+            // threshold: 1 - 1/ratio for the compressor, all of it for the limiter, and
+            // ratio - 1 below the threshold for the gate
+            auto const slope = m == Mode::Gate ? ratio - FloatType(1) : (m == Mode::Limiter ? FloatType(1) : FloatType(1) - FloatType(1) / ratio);
+            auto const sign = m == Mode::Gate ? FloatType(-1) : FloatType(1);
+
+            auto const zero = Vec::broadcast(FloatType(0));
+            auto const vThreshold = Vec::broadcast(threshold);
+            auto const vHalfKnee = Vec::broadcast(halfKnee);
+            auto const vSlope = Vec::broadcast(slope);
+            auto const vSign = Vec::broadcast(sign);
+            auto const vKneeScale = Vec::broadcast(knee > FloatType(0) ? FloatType(0.5) / knee : FloatType(0));
+            auto const vFloor = Vec::broadcast(m == Mode::Gate ? FloatType(_range.load()) : std::numeric_limits<FloatType>::lowest());
+            auto const vMinLevel = Vec::broadcast(FloatType(1e-9));
+
+            // 20 log10(x) = log(x) * 20 / ln(10), and 10^(y / 20) = exp(y * ln(10) / 20)
+            auto const toDb = Vec::broadcast(FloatType(8.68588963806503655302));
+            auto const fromDb = Vec::broadcast(FloatType(0.11512925464970228420));
+
+            auto const padded = ((count + Vec::size - 1) / Vec::size) * Vec::size;
+
+            for (size_t j = count; j < padded; ++j)
+                levels[j] = FloatType(1);
+
+            for (size_t j = 0; j < padded; j += Vec::size) {
+                auto const level = simd::log(simd::max(Vec::load(levels + j), vMinLevel)) * toDb;
+
+                // Distance past the threshold, positive on the side the curve acts on
+                auto const over = vSign * (level - vThreshold);
+
+                // Inside the knee the reduction grows quadratically, reaching the straight
+                // line's value at its far edge
+                auto const k = over + vHalfKnee;
+                auto const inKnee = vSlope * k * k * vKneeScale;
+                auto const outside = vSlope * over;
+
+                auto const reduction = simd::select(over > vHalfKnee, outside, simd::select(k > zero, inKnee, zero));
+                auto const gainDb = simd::max(zero - reduction, vFloor);
+
+                simd::exp(gainDb * fromDb).store(levels + j);
+            }
+        }
+
+        void process (BlockContext<FloatType> const& ctx) override {
+            auto** inputData = ctx.inputData;
+            auto** outputData = ctx.outputData;
+            auto numSamples = ctx.numSamples;
+
+            while (stateQueue.size() > 0)
+                stateQueue.pop(activeState);
+
+            auto const numActive = activeState
+                ? std::min({ ctx.numInputChannels, ctx.numOutputChannels, activeState->numChannels })
+                : size_t(0);
+
+            for (size_t j = numActive; j < ctx.numOutputChannels; ++j)
+                std::fill_n(outputData[j], numSamples, FloatType(0));
+
+            if (numActive == 0)
+                return;
+
+            auto& state = *activeState;
+            auto const m = _mode.load();
+            auto const ap = _attackPole.load();
+            auto const rp = _releasePole.load();
+
+            // The detector listens to the sidechain if we have one, and to the signals
+            // themselves otherwise
+            auto const firstDetected = ctx.numInputChannels > state.numChannels ? state.numChannels : size_t(0);
+            auto const lastDetected = ctx.numInputChannels > state.numChannels ? ctx.numInputChannels : numActive;
+
+            alignas(32) FloatType gains[kChunkSize];
+
+            for (size_t start = 0; start < numSamples; start += kChunkSize) {
+                auto const count = std::min(kChunkSize, numSamples - start);
+
+                for (size_t i = 0; i < count; ++i) {
+                    FloatType vn = 0;
+
+                    for (size_t ch = firstDetected; ch < lastDetected; ++ch)
+                        vn = std::max(vn, std::abs(inputData[ch][start + i]));
+
+                    z = vn > z ? ap * (z - vn) + vn : rp * (z - vn) + vn;
+                    gains[i] = z;
+                }
+
+                computeGains(m, gains, count);
+
+                for (size_t ch = 0; ch < numActive; ++ch) {
+                    auto const* in = inputData[ch] + start;
+                    auto* out = outputData[ch] + start;
+
+                    if (state.lookahead == 0) {
+                        for (size_t i = 0; i < count; ++i)
+                            out[i] = in[i] * gains[i];
+
+                        continue;
+                    }
+
+                    auto* ring = state.rings[ch].data();
+
+                    for (size_t i = 0; i < count; ++i) {
+                        auto const w = state.writePosition + i;
+
+                        ring[w & state.mask] = in[i];
+                        out[i] = ring[(w - state.lookahead) & state.mask] * gains[i];
+                    }
+                }
+
+                state.writePosition += count;
+            }
+        }
+
+        // Props, as seen from the non-realtime thread
+        double thresholdDb = -12.0;
+        double ratio = 4.0;
+        double kneeDb = 0.0;
+        double rangeDb = -80.0;
+        double attackMs = 10.0;
+        double releaseMs = 100.0;
+        double lookaheadMs = 0.0;
+        size_t numChannels = 1;
+
+        std::atomic<Mode> _mode { Mode::Compressor };
+        static_assert(std::atomic<Mode>::is_always_lock_free);
+
+        static_assert(std::atomic<FloatType>::is_always_lock_free);
+        std::atomic<FloatType> _threshold = 0;
+        std::atomic<FloatType> _knee = 0;
+        std::atomic<FloatType> _range = 0;
+        std::atomic<FloatType> _ratio = 1;
+        std::atomic<FloatType> _attackPole = 0;
+        std::atomic<FloatType> _releasePole = 0;
+
+        RefCountedPool<State> statePool;
+        SingleWriterSingleReaderQueue<std::shared_ptr<State>> stateQueue;
+        std::shared_ptr<State> activeState;
+
+        // Detector state
+        FloatType z = 0;
+    };
+
+} // namespace elem
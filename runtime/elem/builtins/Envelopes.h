@@ -0,0 +1,89 @@
+#pragma once
+
+#include <cmath>
+#include <limits>
+
+#include "../GraphNode.h"
+
+
+namespace elem
+{
+
+    // An exponential ADSR envelope generator.
+    //
+    // Expects five children: the attack time, decay time, sustain level, release time
+    // and gate, with times in seconds. While the gate is high, the envelope heads for 1
+    // for the attack time (counted from the gate's rising edge), and then for the sustain
+    // level; when the gate falls, it heads for 0.
+    //
+    // Each stage is a one pole smoother whose time constant is the stage time divided by
+    // 6.91, so that it gets within 60dB of its target over the stage time, clamped to a
+    // minimum of 0.1ms. This is sample for sample the same curve as the graph the `adsr`
+    // library function used to compose from counter, select, tau2pole and smooth nodes,
+    // but the pole is only recomputed when the stage or its time changes.
+    template <typename FloatType>
+    struct ADSRNode : public GraphNode<FloatType> {
+        using GraphNode<FloatType>::GraphNode;
+
+        void prepare(double sr, size_t bs) override
+        {
+            GraphNode<FloatType>::prepare(sr, bs);
+
+            // The pole counts in samples of the old rate, so it's recomputed on the
+            // next sample whatever the stage time
+            lastT60 = -1;
+        }
+
+        void process (BlockContext<FloatType> const& ctx) override {
+            auto** inputData = ctx.inputData;
+            auto* outputData = ctx.outputData[0];
+            auto numChannels = ctx.numInputChannels;
+            auto numSamples = ctx.numSamples;
+
+            // If we don't have the inputs we need, we bail here and zero the buffer
+            // hoping to prevent unexpected signals.
+            if (numChannels < 5)
+                return (void) std::fill_n(outputData, numSamples, FloatType(0));
+
+            auto const sr = FloatType(GraphNode<FloatType>::getSampleRate());
+            auto const one = FloatType(1);
+
+            auto const* attack = inputData[0];
+            auto const* decay = inputData[1];
+            auto const* sustain = inputData[2];
+            auto const* release = inputData[3];
+            auto const* gate = inputData[4];
+
+            for (size_t i = 0; i < numSamples; ++i) {
+                auto const g = gate[i];
+
+                // Samples since the gate rose, counted as the counter node does
+                auto const high = (one - g) <= std::numeric_limits<FloatType>::epsilon();
+                auto const counted = high ? count : FloatType(0);
+
+                count = high ? count + one : FloatType(0);
+
+                auto const inAttack = counted < attack[i] * sr;
+
+                // Non-binary gates blend between the gated and released stages just as the
+                // select nodes of the composed graph did
+                auto const target = g * (inAttack ? one : sustain[i]);
+                auto const t60 = std::max(FloatType(0.0001), g * (inAttack ? attack[i] : decay[i]) + (one - g) * release[i]);
+
+                if (t60 != lastT60) {
+                    lastT60 = t60;
+                    pole = std::exp(FloatType(-1) / ((t60 / FloatType(6.91)) * sr));
+                }
+
+                z = (one - pole) * target + pole * z;
+                outputData[i] = z;
+            }
+        }
+
+        FloatType count = 0;
+        FloatType lastT60 = -1;
+        FloatType pole = 0;
+        FloatType z = 0;
+    };
+
+} // namespace elem
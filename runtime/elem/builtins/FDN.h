@@ -0,0 +1,369 @@
+#pragma once
+
+#include <atomic>
+#include <cmath>
+
+#include "../GraphNode.h"
+#include "../SingleWriterSingleReaderQueue.h"
+
+#include "helpers/RefCountedPool.h"
+#include "helpers/SIMD.h"
+
+
+namespace elem
+{
+
+    // A feedback delay network reverb.
+    //
+    //   el.mc.fdn({size: 8, decay: 2.5, damping: 0.3, channels: 2}, left, right)
+    //
+    // The network is `size` delay lines, a power of two from 2 to 64, whose outputs are
+    // damped, attenuated and mixed back into their inputs through an orthogonal matrix:
+    // a Hadamard matrix, or with the `matrix` property set to "householder", the
+    // Householder reflection I - 2/N. The lengths of the lines are given in samples by the
+    // `times` property, from 1 sample up to kMaxLineSeconds at the current sample rate;
+    // lines it doesn't cover get a default length, spread between 25ms and 75ms and
+    // rounded to a prime number of samples.
+    //
+    // Every line is attenuated so that the network decays by 60dB over `decay` seconds,
+    // and damped by a one pole lowpass whose pole is the `damping` property, which shortens
+    // the decay of high frequencies. Input channel c feeds lines c, c + M, c + 2M, ... for
+    // M input channels, and output channel c sums lines c, c + K, ... for K output
+    // channels, with alternating signs.
+    //
+    // The feedback is sample accurate. Because no line is shorter than the chunk of
+    // samples we run at a time, each chunk's reads from the lines don't depend on its
+    // writes. So we read a chunk from every line at once, and then damp and mix the lines
+    // a whole chunk at a time, with the matrix running in SIMD lanes across the chunk.
+    template <typename FloatType>
+    struct FDNNode : public GraphNode<FloatType> {
+        FDNNode(NodeId id, double sr, int const blockSize)
+            : GraphNode<FloatType>::GraphNode(id, sr, blockSize)
+        {
+            updateNetwork();
+        }
+
+        void prepare(double sr, size_t bs) override
+        {
+            GraphNode<FloatType>::prepare(sr, bs);
+            updateNetwork();
+        }
+
+        using Vec = simd::Vec<FloatType>;
+
+        static constexpr size_t kChunkSize = 64;
+        static constexpr size_t kMinLines = 2;
+        static constexpr size_t kMaxLines = 64;
+
+        // The longest line the `times` property may ask for
+        static constexpr double kMaxLineSeconds = 5.0;
+
+        struct Network {
+            size_t numLines = 0;
+            size_t chunkSize = 0;
+            size_t writePosition = 0;
+            bool householder = false;
+
+            // Each line's ring is a power of two long, and they sit end to end in `rings`
+            std::vector<size_t> lengths;
+            std::vector<size_t> offsets;
+            std::vector<size_t> masks;
+            std::vector<FloatType> rings;
+
+            std::vector<FloatType> gains;
+            std::vector<FloatType> lowpass;
+
+            // A chunk of every line's output, one row of kChunkSize per line
+            std::vector<FloatType> rows;
+            std::vector<FloatType> sum;
+        };
+
+        int setProperty(std::string const& key, js::Value const& val) override
+        {
+            if (key == "size") {
+                if (!val.isNumber())
+                    return ReturnCode::InvalidPropertyType();
+
+                auto const n = static_cast<size_t>((js::Number) val);
+
+                if (n < kMinLines || n > kMaxLines || (n & (n - 1)) != 0)
+                    return ReturnCode::InvalidPropertyValue();
+
+                numLines = n;
+                updateNetwork();
+            }
+
+            if (key == "times") {
+                if (!val.isArray())
+                    return ReturnCode::InvalidPropertyType();
+
+                auto& arr = val.getArray();
+                auto const maxLength = kMaxLineSeconds * GraphNode<FloatType>::getSampleRate();
+                std::vector<size_t> t(arr.size());
+
+                for (size_t i = 0; i < arr.size(); ++i) {
+                    if (!arr[i].isNumber())
+                        return ReturnCode::InvalidPropertyType();
+
+                    auto const v = (js::Number) arr[i];
+
+                    if (!(v >= 1.0 && v <= maxLength))
+                        return ReturnCode::InvalidPropertyValue();
+
+                    t[i] = static_cast<size_t>(v);
+                }
+
+                times = std::move(t);
+                updateNetwork();
+            }
+
+            if (key == "matrix") {
+                if (!val.isString())
+                    return ReturnCode::InvalidPropertyType();
+
+                auto const m = (js::String) val;
+
+                if (m != "hadamard" && m != "householder")
+                    return ReturnCode::InvalidPropertyValue();
+
+                householder = (m == "householder");
+                updateNetwork();
+            }
+
+            if (key == "decay") {
+                if (!val.isNumber())
+                    return ReturnCode::InvalidPropertyType();
+
+                auto const v = (js::Number) val;
+
+                if (v <= 0.0)
+                    return ReturnCode::InvalidPropertyValue();
+
+                decay.store(FloatType(v));
+            }
+
+            if (key == "damping") {
+                if (!val.isNumber())
+                    return ReturnCode::InvalidPropertyType();
+
+                auto const v = (js::Number) val;
+
+                if (v < 0.0 || v >= 1.0)
+                    return ReturnCode::InvalidPropertyValue();
+
+                damping.store(FloatType(v));
+            }
+
+            return GraphNode<FloatType>::setProperty(key, val);
+        }
+
+        // The default length of line i of n, in samples
+        static size_t getDefaultLength(size_t i, size_t n, double sr)
+        {
+            auto const ms = 25.0 * std::pow(3.0, double(i) / double(n - 1));
+            auto len = static_cast<size_t>(std::round(0.001 * ms * sr));
+
+            auto const isPrime = [](size_t x) {
+                if (x < 2)
+                    return false;
+
+                for (size_t d = 2; d * d <= x; ++d) {
+                    if (x % d == 0)
+                        return false;
+                }
+
+                return true;
+            };
+
+            while (!isPrime(len))
+                ++len;
+
+            return len;
+        }
+
+        void updateNetwork()
+        {
+            auto const sr = GraphNode<FloatType>::getSampleRate();
+            auto net = networkPool.allocate();
+
+            net->numLines = numLines;
+            net->householder = householder;
+            net->writePosition = 0;
+            net->lengths.resize(numLines);
+            net->offsets.resize(numLines);
+            net->masks.resize(numLines);
+
+            size_t total = 0;
+            size_t shortest = kChunkSize;
+
+            for (size_t j = 0; j < numLines; ++j) {
+                auto const len = j < times.size() ? times[j] : getDefaultLength(j, numLines, sr);
+                size_t size = 1;
+
+                while (size < len + 1)
+                    size <<= 1;
+
+                net->lengths[j] = len;
+                net->offsets[j] = total;
+                net->masks[j] = size - 1;
+
+                total += size;
+                shortest = std::min(shortest, len);
+            }
+
+            net->chunkSize = shortest;
+            net->rings.assign(total, FloatType(0));
+            net->gains.assign(numLines, FloatType(0));
+            net->lowpass.assign(numLines, FloatType(0));
+            net->rows.assign(numLines * kChunkSize, FloatType(0));
+            net->sum.assign(kChunkSize, FloatType(0));
+
+            networkQueue.push(std::move(net));
+        }
+
+        // Mixes the rows of the current chunk through the feedback matrix, in place
+        static void mix(Network& net, size_t count)
+        {
+            auto const n = net.numLines;
+            auto* rows = net.rows.data();
+            auto const padded = ((count + Vec::size - 1) / Vec::size) * Vec::size;
+
+            if (net.householder) {
+                auto* sum = net.sum.data();
+                auto const scale = Vec::broadcast(FloatType(2) / FloatType(n));
+
+                std::fill_n(sum, padded, FloatType(0));
+
+                for (size_t j = 0; j < n; ++j) {
+                    for (size_t i = 0; i < padded; i += Vec::size)
+                        (Vec::load(sum + i) + Vec::load(rows + j * kChunkSize + i)).store(sum + i);
+                }
+
+                for (size_t j = 0; j < n; ++j) {
+                    for (size_t i = 0; i < padded; i += Vec::size) {
+                        auto* row = rows + j * kChunkSize + i;
+                        (Vec::load(row) - scale * Vec::load(sum + i)).store(row);
+                    }
+                }
+
+                return;
+            }
+
+            // The fast Walsh-Hadamard transform, in butterflies between whole rows. The
+            // 1/sqrt(n) normalization is folded into the line gains.
+            for (size_t h = 1; h < n; h <<= 1) {
+                for (size_t j = 0; j < n; j += 2 * h) {
+                    for (size_t k = j; k < j + h; ++k) {
+                        auto* a = rows + k * kChunkSize;
+                        auto* b = rows + (k + h) * kChunkSize;
+
+                        for (size_t i = 0; i < padded; i += Vec::size) {
+                            auto const x = Vec::load(a + i);
+                            auto const y = Vec::load(b + i);
+
+                            (x + y).store(a + i);
+                            (x - y).store(b + i);
+                        }
+                    }
+                }
+            }
+        }
+
+        void process (BlockContext<FloatType> const& ctx) override {
+            auto** inputData = ctx.inputData;
+            auto** outputData = ctx.outputData;
+            auto numInputs = ctx.numInputChannels;
+            auto numOutputs = ctx.numOutputChannels;
+            auto numSamples = ctx.numSamples;
+
+            while (networkQueue.size() > 0)
+                networkQueue.pop(network);
+
+            for (size_t j = 0; j < numOutputs; ++j)
+                std::fill_n(outputData[j], numSamples, FloatType(0));
+
+            if (network == nullptr || numOutputs == 0)
+                return;
+
+            auto& net = *network;
+            auto const n = net.numLines;
+            auto const sr = FloatType(GraphNode<FloatType>::getSampleRate());
+            auto const t60 = decay.load();
+            auto const d = damping.load();
+
+            // Each line loses 60dB over the decay time, and the Hadamard matrix needs
+            // normalizing
+            auto const norm = net.householder ? FloatType(1) : FloatType(1) / std::sqrt(FloatType(n));
+
+            for (size_t j = 0; j < n; ++j)
+                net.gains[j] = norm * std::pow(FloatType(0.001), FloatType(net.lengths[j]) / (t60 * sr));
+
+            // Lines are summed into the outputs with alternating signs, and scaled for the
+            // number of lines in each
+            auto const outScale = std::sqrt(FloatType(numOutputs) / FloatType(n));
+
+            for (size_t start = 0; start < numSamples; start += net.chunkSize) {
+                auto const count = std::min(net.chunkSize, numSamples - start);
+                auto const w = net.writePosition;
+
+                for (size_t j = 0; j < n; ++j) {
+                    auto const* ring = net.rings.data() + net.offsets[j];
+                    auto const mask = net.masks[j];
+                    auto const readStart = w + (mask + 1) - net.lengths[j];
+                    auto* row = net.rows.data() + j * kChunkSize;
+                    auto* out = outputData[j % numOutputs] + start;
+                    auto const sign = ((j / numOutputs) & 1) ? -outScale : outScale;
+
+                    // Read the chunk, tap it to the output, then damp and attenuate it
+                    // ahead of the mix
+                    auto const g = net.gains[j];
+                    auto s = net.lowpass[j];
+
+                    for (size_t i = 0; i < count; ++i) {
+                        auto const x = ring[(readStart + i) & mask];
+
+                        out[i] += sign * x;
+                        s = x + d * (s - x);
+                        row[i] = g * s;
+                    }
+
+                    net.lowpass[j] = s;
+                }
+
+                mix(net, count);
+
+                for (size_t j = 0; j < n; ++j) {
+                    auto* ring = net.rings.data() + net.offsets[j];
+                    auto const mask = net.masks[j];
+                    auto const* row = net.rows.data() + j * kChunkSize;
+
+                    if (numInputs > 0) {
+                        auto const* in = inputData[j % numInputs] + start;
+
+                        for (size_t i = 0; i < count; ++i)
+                            ring[(w + i) & mask] = row[i] + in[i];
+                    } else {
+                        for (size_t i = 0; i < count; ++i)
+                            ring[(w + i) & mask] = row[i];
+                    }
+                }
+
+                net.writePosition = w + count;
+            }
+        }
+
+        // Props, as seen from the non-realtime thread
+        size_t numLines = 8;
+        bool householder = false;
+        std::vector<size_t> times;
+
+        std::atomic<FloatType> decay = 2;
+        std::atomic<FloatType> damping = 0;
+        static_assert(std::atomic<FloatType>::is_always_lock_free);
+
+        RefCountedPool<Network> networkPool;
+        SingleWriterSingleReaderQueue<std::shared_ptr<Network>> networkQueue;
+        std::shared_ptr<Network> network;
+    };
+
+} // namespace elem
@@ -7,12 +7,32 @@
 #include "../SingleWriterSingleReaderQueue.h"
 
 #include "helpers/RefCountedPool.h"
-#include "helpers/BufferUtils.h"
 
 
 namespace elem
 {
 
+    namespace detail
+    {
+        // Looks up the named tap line, creating it on first use. A line left over from
+        // before the runtime was prepared for a larger block size is replaced, and the old
+        // one retired in the map until neither tap node holds it any more.
+        template <typename FloatType>
+        SharedResourcePtr getTapBuffer(SharedResourceMap& resources, std::string const& name, size_t blockSize)
+        {
+            auto makeBuffer = [=]() -> SharedResourcePtr {
+                return std::make_shared<BasicAudioBufferResource<FloatType>>(1, blockSize);
+            };
+
+            auto ref = resources.getTapResource(name, makeBuffer);
+
+            if (ref && ref->numSamples() < blockSize && resources.update(name, makeBuffer()))
+                return resources.get(name);
+
+            return ref;
+        }
+    }
+
     // A special graph node type for receiving feedback from within the graph.
     //
     // Will attempt to feed input from a shared mutable resource to its output. If
@@ -27,9 +47,7 @@ namespace elem
                 if (!val.isString())
                     return ReturnCode::InvalidPropertyType();
 
-                auto ref = resources.getTapResource((js::String) val, [=]() {
-                    return std::make_shared<AudioBufferResource>(1, GraphNode<FloatType>::getBlockSize());
-                });
+                auto ref = detail::getTapBuffer<FloatType>(resources, (js::String) val, GraphNode<FloatType>::getBlockSize());
 
                 bufferQueue.push(std::move(ref));
             }
@@ -48,8 +66,13 @@ namespace elem
             if (!activeBuffer)
                 return (void) std::fill_n(outputData, numSamples, FloatType(0));
 
-            auto bufferView = activeBuffer->getChannelData(0);
-            elem::util::copy_cast_n(bufferView.data(), numSamples, outputData);
+            // Tap buffers are allocated in our own sample format, so this is a straight copy
+            auto bufferView = activeBuffer->template getChannelDataAs<FloatType>(0);
+
+            if (bufferView.size() < numSamples)
+                return (void) std::fill_n(outputData, numSamples, FloatType(0));
+
+            std::copy_n(bufferView.data(), numSamples, outputData);
         }
 
         SingleWriterSingleReaderQueue<SharedResourcePtr> bufferQueue;
@@ -71,15 +94,19 @@ namespace elem
             std::fill_n(delayBuffer.data(), blockSize, FloatType(0));
         }
 
+        void prepare(double sr, size_t bs) override
+        {
+            GraphNode<FloatType>::prepare(sr, bs);
+            delayBuffer.assign(bs, FloatType(0));
+        }
+
         int setProperty(std::string const& key, js::Value const& val, SharedResourceMap& resources) override
         {
             if (key == "name") {
                 if (!val.isString())
                     return ReturnCode::InvalidPropertyType();
 
-                auto ref = resources.getTapResource((js::String) val, [=]() {
-                    return std::make_shared<AudioBufferResource>(1, GraphNode<FloatType>::getBlockSize());
-                });
+                auto ref = detail::getTapBuffer<FloatType>(resources, (js::String) val, GraphNode<FloatType>::getBlockSize());
 
                 tapBufferQueue.push(std::move(ref));
             }
@@ -104,8 +131,10 @@ namespace elem
                 return;
 
             // Here, we're good to go draining the buffered delay data into the tap line
-            auto bufferView = activeTapBuffer->getChannelData(0);
-            std::copy_n(delayBuffer.data(), numSamples, bufferView.data());
+            auto bufferView = activeTapBuffer->template getChannelDataAs<FloatType>(0);
+
+            if (bufferView.size() >= numSamples)
+                std::copy_n(delayBuffer.data(), numSamples, bufferView.data());
         }
 
         void process (BlockContext<FloatType> const& ctx) override {
@@ -121,11 +150,11 @@ namespace elem
             // Else, we write to our delay line and pass through our input
             auto* delayData = delayBuffer.data();
 
-            elem::util::copy_cast_n(inputData[0], numSamples, delayData);
+            std::copy_n(inputData[0], numSamples, delayData);
             std::copy_n(inputData[0], numSamples, outputData);
         }
 
-        std::vector<float> delayBuffer;
+        std::vector<FloatType> delayBuffer;
         SingleWriterSingleReaderQueue<SharedResourcePtr> tapBufferQueue;
         SharedResourcePtr activeTapBuffer;
     };
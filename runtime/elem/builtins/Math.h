@@ -2,14 +2,41 @@
 
 #include "../GraphNode.h"
 
+#include "helpers/FastMath.h"
+
 
 namespace elem
 {
 
-    template <typename FloatType, FloatType op(FloatType)>
+    // UnaryOperationNode applies `op` to each sample of its first input.
+    //
+    // Where a VectorOp is given, the node also accepts an `accuracy` property: "exact", the
+    // default, calls `op` per sample, typically the libm function, while "fast" runs the
+    // SIMD polynomial kernel in VectorOp across the block instead. The fast kernels trade
+    // a few ulps of accuracy and libm's handling of non-finite inputs for throughput.
+    template <typename FloatType, FloatType op(FloatType), typename VectorOp = void>
     struct UnaryOperationNode : public GraphNode<FloatType> {
         using GraphNode<FloatType>::GraphNode;
 
+        int setProperty(std::string const& key, js::Value const& val) override
+        {
+            if constexpr (!std::is_void_v<VectorOp>) {
+                if (key == "accuracy") {
+                    if (!val.isString())
+                        return ReturnCode::InvalidPropertyType();
+
+                    auto const accuracy = (js::String) val;
+
+                    if (accuracy != "exact" && accuracy != "fast")
+                        return ReturnCode::InvalidPropertyValue();
+
+                    useFastKernel.store(accuracy == "fast");
+                }
+            }
+
+            return GraphNode<FloatType>::setProperty(key, val);
+        }
+
         void process (BlockContext<FloatType> const& ctx) override {
             auto** inputData = ctx.inputData;
             auto* outputData = ctx.outputData[0];
@@ -21,10 +48,17 @@ namespace elem
             if (numChannels < 1)
                 return (void) std::fill_n(outputData, numSamples, FloatType(0));
 
+            if constexpr (!std::is_void_v<VectorOp>) {
+                if (useFastKernel.load())
+                    return simd::transform(inputData[0], outputData, numSamples, VectorOp{});
+            }
+
             for (size_t i = 0; i < numSamples; ++i) {
                 outputData[i] = op(inputData[0][i]);
             }
         }
+
+        std::atomic<bool> useFastKernel = false;
     };
 
     template <typename FloatType, typename BinaryOp>
@@ -56,7 +90,14 @@ namespace elem
         BinaryOp op;
     };
 
-    template <typename FloatType, typename BinaryOp>
+    // BinaryReducingNode folds all of its inputs into one signal with BinaryOp.
+    //
+    // Where a VectorOp is given, the fold is done in a single pass over the output: each
+    // tile of a few SIMD vectors is accumulated in registers across every input before
+    // being stored once, rather than reading and writing the whole output buffer once per
+    // input. Inputs are still combined left to right, so the result is identical to the
+    // scalar path.
+    template <typename FloatType, typename BinaryOp, typename VectorOp = void>
     struct BinaryReducingNode : public GraphNode<FloatType> {
         using GraphNode<FloatType>::GraphNode;
 
@@ -71,6 +112,10 @@ namespace elem
             if (numChannels < 1)
                 return (void) std::fill_n(outputData, numSamples, FloatType(0));
 
+            if constexpr (!std::is_void_v<VectorOp>) {
+                return reduceTiled(inputData, outputData, numChannels, numSamples);
+            }
+
             // Copy the first input to the output buffer
             for (size_t i = 0; i < numSamples; ++i) {
                 outputData[i] = inputData[0][i];
@@ -85,6 +130,43 @@ namespace elem
             }
         }
 
+        void reduceTiled(FloatType const** inputData, FloatType* outputData, size_t numChannels, size_t numSamples) {
+            using Vec = simd::Vec<FloatType>;
+
+            constexpr size_t kVectorsPerTile = 4;
+            constexpr size_t kTileSize = kVectorsPerTile * Vec::size;
+
+            VectorOp vop;
+            size_t i = 0;
+
+            for (; i + kTileSize <= numSamples; i += kTileSize) {
+                Vec acc[kVectorsPerTile];
+
+                for (size_t k = 0; k < kVectorsPerTile; ++k)
+                    acc[k] = Vec::load(inputData[0] + i + k * Vec::size);
+
+                for (size_t j = 1; j < numChannels; ++j) {
+                    auto const* in = inputData[j] + i;
+
+                    for (size_t k = 0; k < kVectorsPerTile; ++k)
+                        acc[k] = vop(acc[k], Vec::load(in + k * Vec::size));
+                }
+
+                for (size_t k = 0; k < kVectorsPerTile; ++k)
+                    acc[k].store(outputData + i + k * Vec::size);
+            }
+
+            // The remainder, still in a single pass
+            for (; i < numSamples; ++i) {
+                auto acc = inputData[0][i];
+
+                for (size_t j = 1; j < numChannels; ++j)
+                    acc = op(acc, inputData[j][i]);
+
+                outputData[i] = acc;
+            }
+        }
+
         BinaryOp op;
     };
 
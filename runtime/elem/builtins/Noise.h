@@ -1,6 +1,14 @@
 #pragma once
 
 #include "../GraphNode.h"
+#include "../SingleWriterSingleReaderQueue.h"
+
+#include "helpers/FastMath.h"
+#include "helpers/RefCountedPool.h"
+#include "helpers/SIMD.h"
+
+#include <atomic>
+#include <cstring>
 
 
 namespace elem
@@ -42,4 +50,263 @@ namespace elem
         uint32_t seed = static_cast<uint32_t>(std::rand());
     };
 
+    namespace detail
+    {
+        constexpr uint64_t kGoldenGamma = 0x9e3779b97f4a7c15ULL;
+
+        // The output function of SplitMix64, a bijective mix of 64 bits
+        inline uint64_t splitMix64(uint64_t x)
+        {
+            x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+            x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+            return x ^ (x >> 31);
+        }
+
+        // Chris Wellons' "lowbias32", a bijective mix of 32 bits.
+        // See https://nullprogram.com/blog/2018/07/31/
+        inline uint32_t lowbias32(uint32_t x)
+        {
+            x ^= x >> 16;
+            x *= 0x7feb352dU;
+            x ^= x >> 15;
+            x *= 0x846ca68bU;
+            return x ^ (x >> 16);
+        }
+
+        // Fills `out` with values uniformly distributed on [0, 1), taking sample i from
+        // position `counter + i * stride` of the stream identified by `key`.
+        //
+        // Each value is a hash of its position, with no state carried from one sample to
+        // the next, so these loops vectorize. Random bits are written straight into the
+        // mantissa of a number in [1, 2), which keeps every mantissa bit random and avoids
+        // an integer to float conversion. Float takes its 23 bits from a 32-bit hash,
+        // which vector units multiply natively, keyed afresh every 2^32 samples; double
+        // takes its 52 bits from SplitMix64.
+        inline void fillUniform(float* out, size_t numSamples, uint64_t key, uint64_t counter, uint32_t stride)
+        {
+            auto const k = splitMix64(key + (counter >> 32) * kGoldenGamma);
+            auto const mul = static_cast<uint32_t>(k) | 1U;
+            auto const add = static_cast<uint32_t>(k >> 32);
+            auto const base = static_cast<uint32_t>(counter);
+
+            for (size_t i = 0; i < numSamples; ++i) {
+                auto const m = (lowbias32((base + static_cast<uint32_t>(i) * stride) * mul + add) >> 9) | 0x3f800000U;
+
+                float f;
+                std::memcpy(&f, &m, sizeof(f));
+                out[i] = f - 1.0f;
+            }
+        }
+
+        inline void fillUniform(double* out, size_t numSamples, uint64_t key, uint64_t counter, uint32_t stride)
+        {
+            for (size_t i = 0; i < numSamples; ++i) {
+                auto const m = (splitMix64(key + (counter + i * stride) * kGoldenGamma) >> 12) | 0x3ff0000000000000ULL;
+
+                double d;
+                std::memcpy(&d, &m, sizeof(d));
+                out[i] = d - 1.0;
+            }
+        }
+    }
+
+    // A noise generator with a choice of distributions.
+    //
+    // Each output channel is an independent counter-based stream, keyed from the `seed`
+    // property and the channel index. Setting the seed restarts every stream, such that
+    // the same seed always renders the same noise. The `channels` property sets how many
+    // channels hold pink filter state, and is expected to match the number of outputs
+    // in use.
+    //
+    // The `distribution` property selects between:
+    //  * "uniform" (the default), uniformly distributed on [-1, 1)
+    //  * "gaussian", normally distributed with zero mean and unit variance, by Box-Muller
+    //  * "pink", white noise through Paul Kellet's refined pinking filter, with a -3dB/octave
+    //    slope to within about 0.05dB above 10Hz at 44.1kHz and peaks near [-1, 1]
+    template <typename FloatType>
+    struct NoiseNode : public GraphNode<FloatType> {
+        using Vec = simd::Vec<FloatType>;
+
+        NoiseNode(NodeId id, FloatType const sr, int const blockSize)
+            : GraphNode<FloatType>::GraphNode(id, sr, blockSize)
+        {
+            // The initial filter state comes from the pool like any later one, so that
+            // the realtime thread never drops the last reference when swapping it out
+            activePink = pinkPool.allocate();
+            activePink->assign(1, PinkState {});
+        }
+
+        enum class Distribution {
+            Uniform = 0,
+            Gaussian = 1,
+            Pink = 2,
+        };
+
+        // Samples generated per pass, sized for scratch space on the stack
+        static constexpr size_t kChunkSize = 64;
+        static_assert(kChunkSize % Vec::size == 0);
+
+        int setProperty(std::string const& key, js::Value const& val) override
+        {
+            if (key == "seed") {
+                if (!val.isNumber())
+                    return ReturnCode::InvalidPropertyType();
+
+                seed.store(static_cast<uint64_t>(static_cast<int64_t>((js::Number) val)));
+            }
+
+            if (key == "channels") {
+                if (!val.isNumber())
+                    return ReturnCode::InvalidPropertyType();
+
+                auto const n = (js::Number) val;
+
+                if (n < 1)
+                    return ReturnCode::InvalidPropertyValue();
+
+                auto state = pinkPool.allocate();
+                state->assign(static_cast<size_t>(n), PinkState {});
+                pinkQueue.push(std::move(state));
+            }
+
+            if (key == "distribution") {
+                if (!val.isString())
+                    return ReturnCode::InvalidPropertyType();
+
+                auto const d = (js::String) val;
+
+                if (d == "uniform") {
+                    distribution.store(Distribution::Uniform);
+                } else if (d == "gaussian") {
+                    distribution.store(Distribution::Gaussian);
+                } else if (d == "pink") {
+                    distribution.store(Distribution::Pink);
+                } else {
+                    return ReturnCode::InvalidPropertyValue();
+                }
+            }
+
+            return GraphNode<FloatType>::setProperty(key, val);
+        }
+
+        void process (BlockContext<FloatType> const& ctx) override {
+            auto** outputData = ctx.outputData;
+            auto numChannels = ctx.numOutputChannels;
+            auto numSamples = ctx.numSamples;
+
+            while (pinkQueue.size() > 0) {
+                std::shared_ptr<std::vector<PinkState>> next;
+                pinkQueue.pop(next);
+
+                auto const n = std::min(next->size(), activePink->size());
+                std::copy_n(activePink->begin(), n, next->begin());
+
+                activePink = std::move(next);
+            }
+
+            auto& pink = *activePink;
+
+            // Restart the streams if the seed has changed since the last block
+            auto const s = seed.load();
+
+            if (s != activeSeed) {
+                activeSeed = s;
+                position = 0;
+
+                std::fill(pink.begin(), pink.end(), PinkState {});
+            }
+
+            auto const dist = distribution.load();
+
+            for (size_t ch = 0; ch < numChannels; ++ch) {
+                auto* out = outputData[ch];
+
+                auto const key = detail::splitMix64(activeSeed + ch * detail::kGoldenGamma);
+
+                for (size_t start = 0; start < numSamples; start += kChunkSize) {
+                    auto const n = std::min(kChunkSize, numSamples - start);
+
+                    if (dist == Distribution::Gaussian) {
+                        generateGaussian(out + start, n, key, position + start);
+                        continue;
+                    }
+
+                    detail::fillUniform(out + start, n, key, position + start, 1);
+
+                    for (size_t i = 0; i < n; ++i)
+                        out[start + i] = FloatType(2) * out[start + i] - FloatType(1);
+
+                    if (dist == Distribution::Pink && ch < pink.size())
+                        pink[ch].process(out + start, n);
+                }
+            }
+
+            position += numSamples;
+        }
+
+        // Box-Muller, taking the two uniform samples for output sample j from stream
+        // positions 2j and 2j + 1 such that the result doesn't depend on the block size
+        static void generateGaussian(FloatType* out, size_t numSamples, uint64_t key, uint64_t position)
+        {
+            alignas(32) FloatType u1[kChunkSize];
+            alignas(32) FloatType u2[kChunkSize];
+
+            // Round up to whole vectors; the extra lanes are computed and dropped
+            auto const numVectors = (numSamples + Vec::size - 1) / Vec::size;
+            auto const padded = numVectors * Vec::size;
+
+            detail::fillUniform(u1, padded, key, 2 * position, 2);
+            detail::fillUniform(u2, padded, key, 2 * position + 1, 2);
+
+            auto const one = Vec::broadcast(FloatType(1));
+            auto const minusTwo = Vec::broadcast(FloatType(-2));
+            auto const twoPi = Vec::broadcast(FloatType(6.28318530717958647692));
+
+            for (size_t i = 0; i < padded; i += Vec::size) {
+                // Taking 1 - u moves the first uniform to (0, 1] to keep clear of log(0)
+                auto const r = simd::sqrt(minusTwo * simd::log(one - Vec::load(u1 + i)));
+                (r * simd::cos(twoPi * Vec::load(u2 + i))).store(u1 + i);
+            }
+
+            std::copy_n(u1, numSamples, out);
+        }
+
+        // Paul Kellet's refined pinking filter, a weighted sum of one-pole lowpass filters.
+        // See https://www.firstpr.com.au/dsp/pink-noise/
+        struct PinkState {
+            FloatType b0 = 0, b1 = 0, b2 = 0, b3 = 0, b4 = 0, b5 = 0, b6 = 0;
+
+            void process(FloatType* data, size_t numSamples)
+            {
+                for (size_t i = 0; i < numSamples; ++i) {
+                    auto const white = data[i];
+
+                    b0 = FloatType(0.99886) * b0 + white * FloatType(0.0555179);
+                    b1 = FloatType(0.99332) * b1 + white * FloatType(0.0750759);
+                    b2 = FloatType(0.96900) * b2 + white * FloatType(0.1538520);
+                    b3 = FloatType(0.86650) * b3 + white * FloatType(0.3104856);
+                    b4 = FloatType(0.55000) * b4 + white * FloatType(0.5329522);
+                    b5 = FloatType(-0.7616) * b5 - white * FloatType(0.0168980);
+
+                    // The filter has a gain of roughly 9 across the band, which we take
+                    // back out to land near unit peaks
+                    data[i] = FloatType(0.11) * (b0 + b1 + b2 + b3 + b4 + b5 + b6 + white * FloatType(0.5362));
+                    b6 = white * FloatType(0.115926);
+                }
+            }
+        };
+
+        std::atomic<uint64_t> seed { static_cast<uint64_t>(std::rand()) };
+        std::atomic<Distribution> distribution { Distribution::Uniform };
+        static_assert(std::atomic<Distribution>::is_always_lock_free);
+
+        // Start from the seed drawn above rather than restarting on the first block
+        uint64_t activeSeed = seed.load();
+        uint64_t position = 0;
+
+        RefCountedPool<std::vector<PinkState>> pinkPool;
+        SingleWriterSingleReaderQueue<std::shared_ptr<std::vector<PinkState>>> pinkQueue;
+        std::shared_ptr<std::vector<PinkState>> activePink;
+    };
+
 } // namespace elem
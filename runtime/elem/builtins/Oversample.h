@@ -0,0 +1,200 @@
+#pragma once
+
+#include <algorithm>
+#include <utility>
+
+#include "../GraphNode.h"
+#include "../Subgraph.h"
+
+#include "helpers/Halfband.h"
+
+
+namespace elem
+{
+
+    namespace detail
+    {
+        template <typename FloatType>
+        struct OversampleEngine {
+            size_t numStages = 0;
+            SubgraphInstance<FloatType> subgraph;
+
+            // One chain of resampling stages per input and per output, from the base rate
+            // upwards
+            std::vector<std::vector<HalfbandUpsampler<FloatType>>> up;
+            std::vector<std::vector<HalfbandDownsampler<FloatType>>> down;
+
+            // The upsampled inputs, and room for the stages between
+            std::vector<std::vector<FloatType>> inputs;
+            std::vector<FloatType const*> inputPtrs;
+            std::vector<FloatType> scratch[2];
+        };
+    }
+
+    // An oversampling container: renders the subgraph given in its `template` property
+    // at `factor` times the sample rate, for nonlinear stages which would otherwise alias.
+    //
+    //   el.mc.oversample({factor: 4}, el.tanh(el.mul(8, el.in({channel: 0}))), x)
+    //
+    // The container's children are the subgraph's inputs, which its template reads with
+    // `in` nodes. Every input the template reads is upsampled, the subgraph runs over the
+    // correspondingly longer block with its nodes seeing the raised sample rate, and each
+    // of its outputs is filtered and downsampled back to the container's outputs.
+    //
+    // The factor is 1, 2, 4 or 8, and resampling runs in polyphase halfband stages of 2x
+    // each. The first stage does the real work, rejecting everything between 20kHz and
+    // the Nyquist frequency at 44.1kHz by 90dB; the later stages only have to clear what
+    // lies above the first stage's passband, and get away with far fewer taps. Together
+    // the stages delay the signal by 63 samples at 2x, 70.5 at 4x and 72.25 at 8x.
+    template <typename FloatType>
+    struct OversampleNode : public SubgraphContainerNode<FloatType, detail::OversampleEngine<FloatType>> {
+        using Engine = detail::OversampleEngine<FloatType>;
+        using Container = SubgraphContainerNode<FloatType, Engine>;
+        using Container::Container;
+
+        static constexpr size_t kMaxFactor = 8;
+
+        // Taps per phase and Kaiser beta of each 2x stage, from the base rate upwards
+        static constexpr std::pair<size_t, double> kStages[] = {{32, 9.0}, {8, 8.0}, {4, 7.0}};
+
+        int setProperty(std::string const& key, js::Value const& val, SharedResourceMap& resources) override
+        {
+            if (key == "factor") {
+                if (!val.isNumber())
+                    return ReturnCode::InvalidPropertyType();
+
+                auto const f = static_cast<size_t>((js::Number) val);
+
+                if (f < 1 || f > kMaxFactor || (f & (f - 1)) != 0)
+                    return ReturnCode::InvalidPropertyValue();
+
+                if (f != factor) {
+                    factor = f;
+
+                    if (auto res = Container::rebuild(resources); res != ReturnCode::Ok())
+                        return res;
+                }
+            }
+
+            return Container::setProperty(key, val, resources);
+        }
+
+        int buildEngine(Engine& engine, SharedResourceMap& resources) override
+        {
+            auto const blockSize = GraphNode<FloatType>::getBlockSize();
+            auto const res = engine.subgraph.build(Container::subgraphTemplate, Container::factory, GraphNode<FloatType>::getSampleRate() * double(factor), static_cast<int>(blockSize * factor), resources);
+
+            if (res != ReturnCode::Ok())
+                return res;
+
+            size_t numStages = 0;
+
+            while ((size_t(1) << numStages) < factor)
+                ++numStages;
+
+            auto const numInputs = Container::subgraphTemplate.getNumInputs();
+            auto const numOutputs = engine.subgraph.getNumOutputs();
+
+            engine.numStages = numStages;
+            engine.up.assign(numInputs, {});
+            engine.down.assign(numOutputs, {});
+
+            for (size_t s = 0; s < numStages; ++s) {
+                auto const [numTaps, beta] = kStages[s];
+
+                for (auto& chain : engine.up)
+                    chain.emplace_back(numTaps, beta, blockSize << s);
+
+                for (auto& chain : engine.down)
+                    chain.emplace_back(numTaps, beta, blockSize << s);
+            }
+
+            engine.inputs.assign(numInputs, std::vector<FloatType>(blockSize * factor));
+            engine.inputPtrs.resize(numInputs);
+
+            for (size_t c = 0; c < numInputs; ++c)
+                engine.inputPtrs[c] = engine.inputs[c].data();
+
+            engine.scratch[0].assign(blockSize * factor, FloatType(0));
+            engine.scratch[1].assign(blockSize * factor, FloatType(0));
+
+            return ReturnCode::Ok();
+        }
+
+        void forEachSubgraph(Engine& engine, std::function<void(SubgraphInstance<FloatType>&)> const& fn) override
+        {
+            fn(engine.subgraph);
+        }
+
+        void process (BlockContext<FloatType> const& ctx) override {
+            auto** inputData = ctx.inputData;
+            auto** outputData = ctx.outputData;
+            auto numChildren = ctx.numInputChannels;
+            auto numSamples = ctx.numSamples;
+
+            auto* activeEngine = Container::getActiveEngine();
+
+            if (activeEngine == nullptr) {
+                for (size_t j = 0; j < ctx.numOutputChannels; ++j)
+                    std::fill_n(outputData[j], numSamples, FloatType(0));
+
+                return;
+            }
+
+            auto& engine = *activeEngine;
+            auto const numStages = engine.numStages;
+
+            // Up through every stage, alternating between the scratch buffers
+            for (size_t c = 0; c < engine.inputs.size(); ++c) {
+                auto* dest = engine.inputs[c].data();
+
+                if (c >= numChildren) {
+                    std::fill_n(dest, numSamples << numStages, FloatType(0));
+                    continue;
+                }
+
+                if (numStages == 0) {
+                    std::copy_n(inputData[c], numSamples, dest);
+                    continue;
+                }
+
+                auto const* source = inputData[c];
+
+                for (size_t s = 0; s < numStages; ++s) {
+                    auto* out = (s + 1 == numStages) ? dest : engine.scratch[s & 1].data();
+
+                    engine.up[c][s].process(source, out, numSamples << s);
+                    source = out;
+                }
+            }
+
+            engine.subgraph.process(engine.inputPtrs.data(), engine.inputs.size(), numSamples << numStages, ctx.userData);
+
+            // And back down
+            for (size_t c = 0; c < ctx.numOutputChannels; ++c) {
+                if (c >= engine.subgraph.getNumOutputs()) {
+                    std::fill_n(outputData[c], numSamples, FloatType(0));
+                    continue;
+                }
+
+                if (numStages == 0) {
+                    std::copy_n(engine.subgraph.getOutput(c), numSamples, outputData[c]);
+                    continue;
+                }
+
+                auto const* source = engine.subgraph.getOutput(c);
+
+                for (size_t s = numStages; s-- > 0;) {
+                    auto* out = (s == 0) ? outputData[c] : engine.scratch[s & 1].data();
+
+                    engine.down[c][s].process(source, out, numSamples << s);
+                    source = out;
+                }
+            }
+        }
+
+        // Props, as seen from the non-realtime thread
+        size_t factor = 2;
+    };
+
+} // namespace elem
@@ -0,0 +1,396 @@
+#pragma once
+
+#include <cmath>
+
+#include "../GraphNode.h"
+#include "../SingleWriterSingleReaderQueue.h"
+
+#include "helpers/FFT.h"
+#include "helpers/RefCountedPool.h"
+
+
+namespace elem
+{
+
+    namespace detail
+    {
+        // The framing shared by the analysis and resynthesis nodes: frames of `size`
+        // samples taken every `hop` samples, weighted by the named window.
+        //
+        // Both sizes are powers of two, with at least two frames overlapping any sample.
+        // Properties may arrive in any order, so a combination which doesn't satisfy that
+        // is held rather than rejected, and takes effect once the other property catches up.
+        struct STFTFraming {
+            size_t size = 1024;
+            size_t hop = 256;
+            std::string window = "hann";
+
+            static constexpr size_t kMinSize = 16;
+            static constexpr size_t kMaxSize = 65536;
+
+            int setProperty(std::string const& key, js::Value const& val)
+            {
+                if (key == "size" || key == "hop") {
+                    if (!val.isNumber())
+                        return ReturnCode::InvalidPropertyType();
+
+                    auto const n = static_cast<size_t>((js::Number) val);
+
+                    if (n < 1 || n > kMaxSize || (n & (n - 1)) != 0)
+                        return ReturnCode::InvalidPropertyValue();
+
+                    if (key == "size" && n < kMinSize)
+                        return ReturnCode::InvalidPropertyValue();
+
+                    (key == "size" ? size : hop) = n;
+                }
+
+                if (key == "window") {
+                    if (!val.isString())
+                        return ReturnCode::InvalidPropertyType();
+
+                    auto const w = (js::String) val;
+
+                    if (w != "hann" && w != "hamming" && w != "blackman" && w != "rect")
+                        return ReturnCode::InvalidPropertyValue();
+
+                    window = w;
+                }
+
+                return ReturnCode::Ok();
+            }
+
+            bool isValid() const
+            {
+                return hop <= size / 2;
+            }
+
+            // The number of spectral channels carrying each frame: size / 2 complex bins
+            // spread over hop samples, as real and imaginary parts
+            size_t getNumSpectralChannels() const
+            {
+                return size / hop;
+            }
+
+            // The periodic form of the window, so that overlapping frames sum evenly
+            template <typename FloatType>
+            std::vector<FloatType> makeWindow() const
+            {
+                constexpr double pi = 3.14159265358979323846;
+                std::vector<FloatType> w(size);
+
+                for (size_t i = 0; i < size; ++i) {
+                    auto const x = 2.0 * pi * static_cast<double>(i) / static_cast<double>(size);
+
+                    if (window == "hann")
+                        w[i] = FloatType(0.5 - 0.5 * std::cos(x));
+                    else if (window == "hamming")
+                        w[i] = FloatType(0.54 - 0.46 * std::cos(x));
+                    else if (window == "blackman")
+                        w[i] = FloatType(0.42 - 0.5 * std::cos(x) + 0.08 * std::cos(2.0 * x));
+                    else
+                        w[i] = FloatType(1);
+                }
+
+                return w;
+            }
+        };
+    }
+
+    // Short-time Fourier analysis, streaming the spectrum of its input at audio rate.
+    //
+    // Every `hop` samples, the node takes the last `size` samples of its input, applies the
+    // window, and transforms them. The resulting size / 2 bins are then written out over
+    // the following hop samples, spread across size / hop channels in pairs of real and
+    // imaginary parts: at sample j of the hop, channels 2c and 2c + 1 carry bin c * hop + j.
+    // One more channel may follow, carrying j itself, from which graphs can work out which
+    // bins they're looking at.
+    //
+    // The bins are in RealFFT's packed layout, with the purely real Nyquist bin carried in
+    // the imaginary part of bin 0. Anything treating the bins with real-valued gains, as
+    // most spectral effects do, needs no special case for it.
+    //
+    // Since a frame is only streamed out once it's complete, the spectrum trails the input
+    // by one hop.
+    template <typename FloatType>
+    struct STFTNode : public GraphNode<FloatType> {
+        STFTNode(NodeId id, double sr, int const blockSize)
+            : GraphNode<FloatType>::GraphNode(id, sr, blockSize)
+        {
+            updateState();
+        }
+
+        struct State {
+            detail::STFTFraming framing;
+            RealFFT<FloatType> fft;
+
+            std::vector<FloatType> window;
+            std::vector<FloatType> history;
+            std::vector<FloatType> frame;
+            std::vector<FloatType> re, im;
+
+            size_t writePosition = 0;
+            size_t hopPosition = 0;
+        };
+
+        int setProperty(std::string const& key, js::Value const& val) override
+        {
+            if (key == "size" || key == "hop" || key == "window") {
+                if (auto const err = framing.setProperty(key, val); err != ReturnCode::Ok())
+                    return err;
+
+                updateState();
+            }
+
+            return GraphNode<FloatType>::setProperty(key, val);
+        }
+
+        void updateState()
+        {
+            if (!framing.isValid())
+                return;
+
+            auto state = statePool.allocate();
+
+            state->framing = framing;
+            state->fft.resize(framing.size);
+            state->window = framing.makeWindow<FloatType>();
+            state->history.assign(framing.size, FloatType(0));
+            state->frame.assign(framing.size, FloatType(0));
+            state->re.assign(framing.size / 2, FloatType(0));
+            state->im.assign(framing.size / 2, FloatType(0));
+            state->writePosition = 0;
+            state->hopPosition = 0;
+
+            stateQueue.push(std::move(state));
+        }
+
+        // Transforms the last `size` samples of input into the next frame's bins
+        void analyze(State& state)
+        {
+            auto const size = state.framing.size;
+
+            // The history is a ring whose oldest sample sits at the write position
+            for (size_t i = 0; i < size; ++i) {
+                auto const k = (state.writePosition + i) & (size - 1);
+                state.frame[i] = state.history[k] * state.window[i];
+            }
+
+            state.fft.forward(state.frame.data(), state.re.data(), state.im.data());
+        }
+
+        void process (BlockContext<FloatType> const& ctx) override {
+            auto** outputData = ctx.outputData;
+            auto numSamples = ctx.numSamples;
+
+            while (stateQueue.size() > 0)
+                stateQueue.pop(activeState);
+
+            auto const numSpectralChannels = activeState ? activeState->framing.getNumSpectralChannels() : 0;
+
+            if (ctx.numInputChannels == 0 || activeState == nullptr || ctx.numOutputChannels < numSpectralChannels) {
+                for (size_t j = 0; j < ctx.numOutputChannels; ++j)
+                    std::fill_n(outputData[j], numSamples, FloatType(0));
+
+                return;
+            }
+
+            auto& state = *activeState;
+            auto const* input = ctx.inputData[0];
+            auto const size = state.framing.size;
+            auto const hop = state.framing.hop;
+
+            for (size_t done = 0; done < numSamples; /* no increment */) {
+                auto const count = std::min(numSamples - done, hop - state.hopPosition);
+
+                // Each channel pair carries a contiguous run of bins over the hop
+                for (size_t c = 0; c < numSpectralChannels / 2; ++c) {
+                    auto const bin = c * hop + state.hopPosition;
+
+                    std::copy_n(state.re.data() + bin, count, outputData[2 * c] + done);
+                    std::copy_n(state.im.data() + bin, count, outputData[2 * c + 1] + done);
+                }
+
+                if (ctx.numOutputChannels > numSpectralChannels) {
+                    for (size_t i = 0; i < count; ++i)
+                        outputData[numSpectralChannels][done + i] = FloatType(state.hopPosition + i);
+                }
+
+                for (size_t i = 0; i < count; ++i) {
+                    state.history[state.writePosition] = input[done + i];
+                    state.writePosition = (state.writePosition + 1) & (size - 1);
+                }
+
+                state.hopPosition += count;
+                done += count;
+
+                if (state.hopPosition == hop) {
+                    analyze(state);
+                    state.hopPosition = 0;
+                }
+            }
+
+            for (size_t j = numSpectralChannels + 1; j < ctx.numOutputChannels; ++j)
+                std::fill_n(outputData[j], numSamples, FloatType(0));
+        }
+
+        // Props, as seen from the non-realtime thread
+        detail::STFTFraming framing;
+
+        RefCountedPool<State> statePool;
+        SingleWriterSingleReaderQueue<std::shared_ptr<State>> stateQueue;
+        std::shared_ptr<State> activeState;
+    };
+
+    // Short-time Fourier resynthesis, the inverse of STFTNode.
+    //
+    // The node takes the spectral channels STFTNode produces, with the same `size`, `hop`
+    // and `window` properties, as its children. If the trailing bin index channel is given
+    // too, the node follows it to stay in step with the analysis, which otherwise relies on
+    // both nodes having started together. Once it has collected a whole frame it
+    // transforms it back, applies the window again, and overlap-adds it into its output,
+    // normalized by the sum of the squared window over the overlapping frames. An
+    // unmodified spectrum therefore comes back out as the original input, with any window.
+    //
+    // Output trails the spectrum by `size` samples, so an analysis and resynthesis pair
+    // delays its input by size + hop samples overall.
+    template <typename FloatType>
+    struct ISTFTNode : public GraphNode<FloatType> {
+        ISTFTNode(NodeId id, double sr, int const blockSize)
+            : GraphNode<FloatType>::GraphNode(id, sr, blockSize)
+        {
+            updateState();
+        }
+
+        struct State {
+            detail::STFTFraming framing;
+            RealFFT<FloatType> fft;
+
+            std::vector<FloatType> window;
+            std::vector<FloatType> normalization;
+            std::vector<FloatType> re, im;
+            std::vector<FloatType> frame;
+            std::vector<FloatType> overlap;
+            std::vector<FloatType> ready;
+
+            size_t hopPosition = 0;
+        };
+
+        int setProperty(std::string const& key, js::Value const& val) override
+        {
+            if (key == "size" || key == "hop" || key == "window") {
+                if (auto const err = framing.setProperty(key, val); err != ReturnCode::Ok())
+                    return err;
+
+                updateState();
+            }
+
+            return GraphNode<FloatType>::setProperty(key, val);
+        }
+
+        void updateState()
+        {
+            if (!framing.isValid())
+                return;
+
+            auto state = statePool.allocate();
+            auto const size = framing.size;
+            auto const hop = framing.hop;
+
+            state->framing = framing;
+            state->fft.resize(size);
+            state->window = framing.makeWindow<FloatType>();
+            state->normalization.assign(hop, FloatType(0));
+
+            for (size_t j = 0; j < hop; ++j) {
+                FloatType sum = 0;
+
+                for (size_t k = j; k < size; k += hop)
+                    sum += state->window[k] * state->window[k];
+
+                state->normalization[j] = sum > FloatType(1e-6) ? FloatType(1) / sum : FloatType(0);
+            }
+
+            state->re.assign(size / 2, FloatType(0));
+            state->im.assign(size / 2, FloatType(0));
+            state->frame.assign(size, FloatType(0));
+            state->overlap.assign(size, FloatType(0));
+            state->ready.assign(hop, FloatType(0));
+            state->hopPosition = 0;
+
+            stateQueue.push(std::move(state));
+        }
+
+        // Transforms the collected frame back and overlap-adds it, leaving the next hop of
+        // finished output in `ready`
+        void synthesize(State& state)
+        {
+            auto const size = state.framing.size;
+            auto const hop = state.framing.hop;
+
+            state.fft.inverse(state.re.data(), state.im.data(), state.frame.data());
+
+            for (size_t i = 0; i < size; ++i)
+                state.overlap[i] += state.frame[i] * state.window[i];
+
+            for (size_t j = 0; j < hop; ++j)
+                state.ready[j] = state.overlap[j] * state.normalization[j];
+
+            std::copy(state.overlap.begin() + hop, state.overlap.end(), state.overlap.begin());
+            std::fill(state.overlap.end() - hop, state.overlap.end(), FloatType(0));
+        }
+
+        void process (BlockContext<FloatType> const& ctx) override {
+            auto** inputData = ctx.inputData;
+            auto* outputData = ctx.outputData[0];
+            auto numSamples = ctx.numSamples;
+
+            while (stateQueue.size() > 0)
+                stateQueue.pop(activeState);
+
+            if (activeState == nullptr || ctx.numInputChannels < activeState->framing.getNumSpectralChannels())
+                return (void) std::fill_n(outputData, numSamples, FloatType(0));
+
+            auto& state = *activeState;
+            auto const hop = state.framing.hop;
+            auto const numSpectralChannels = state.framing.getNumSpectralChannels();
+            auto const numPairs = numSpectralChannels / 2;
+
+            if (ctx.numInputChannels > numSpectralChannels && numSamples > 0) {
+                auto const index = inputData[numSpectralChannels][0];
+
+                if (index >= FloatType(0) && index < FloatType(hop))
+                    state.hopPosition = static_cast<size_t>(index);
+            }
+
+            for (size_t done = 0; done < numSamples; /* no increment */) {
+                auto const count = std::min(numSamples - done, hop - state.hopPosition);
+
+                for (size_t c = 0; c < numPairs; ++c) {
+                    auto const bin = c * hop + state.hopPosition;
+
+                    std::copy_n(inputData[2 * c] + done, count, state.re.data() + bin);
+                    std::copy_n(inputData[2 * c + 1] + done, count, state.im.data() + bin);
+                }
+
+                std::copy_n(state.ready.data() + state.hopPosition, count, outputData + done);
+
+                state.hopPosition += count;
+                done += count;
+
+                if (state.hopPosition == hop) {
+                    synthesize(state);
+                    state.hopPosition = 0;
+                }
+            }
+        }
+
+        // Props, as seen from the non-realtime thread
+        detail::STFTFraming framing;
+
+        RefCountedPool<State> statePool;
+        SingleWriterSingleReaderQueue<std::shared_ptr<State>> stateQueue;
+        std::shared_ptr<State> activeState;
+    };
+
+} // namespace elem
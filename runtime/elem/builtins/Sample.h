@@ -5,6 +5,8 @@
 #include "../Types.h"
 
 #include "./helpers/Change.h"
+#include "./helpers/Interpolation.h"
+#include "./helpers/RateMatchedResource.h"
 
 
 namespace elem
@@ -18,7 +20,15 @@ namespace elem
     // The sample file is loaded from disk or from virtual memory with a path set by the `path` property.
     // The sample is then triggered on the rising edge of an incoming pulse train, so
     // this node expects a single child node delivering that train.
-    template <typename FloatType, typename ReaderType = VariablePitchLerpReader<float>>
+    //
+    // The `interpolation` property selects between "linear" (the default), "hermite"
+    // and "sinc" reads when playing back at a rate given by an optional second child.
+    //
+    // `startOffset` and `stopOffset` count samples of the resource as it was recorded. A
+    // resource recorded at another sample rate is converted to ours the first time a node
+    // refers to it, during that render; `Runtime::loadSharedResourceAsync` does the same
+    // conversion on its background thread as part of the load.
+    template <typename FloatType, typename ReaderType = VariablePitchLerpReader<FloatType>>
     struct SampleNode : public GraphNode<FloatType> {
         using GraphNode<FloatType>::GraphNode;
 
@@ -31,8 +41,16 @@ namespace elem
                 if (!resources.has((js::String) val))
                     return ReturnCode::InvalidPropertyValue();
 
-                auto ref = resources.get((js::String) val);
+                // Resources recorded at a different rate are swapped for a copy converted
+                // to our sample rate, so that nominal pitch needs no interpolation
+                auto ref = getRateMatchedResource<FloatType>(resources, (js::String) val, GraphNode<FloatType>::getSampleRate());
                 bufferQueue.push(std::move(ref));
+
+                // The offsets count samples of the resource as recorded, so they follow it
+                // into the converted copy
+                offsetRatio = getRateMatchRatio(resources, (js::String) val, GraphNode<FloatType>::getSampleRate());
+                startOffset.store(toPlaybackSamples(GraphNode<FloatType>::getPropertyWithDefault("startOffset", js::Number(0))));
+                stopOffset.store(toPlaybackSamples(GraphNode<FloatType>::getPropertyWithDefault("stopOffset", js::Number(0))));
             }
 
             if (key == "mode") {
@@ -56,7 +74,7 @@ namespace elem
                 if (vi < 0)
                     return ReturnCode::InvalidPropertyValue();
 
-                startOffset.store(static_cast<size_t>(vi));
+                startOffset.store(toPlaybackSamples(vi));
             }
 
             if (key == "stopOffset") {
@@ -69,12 +87,34 @@ namespace elem
                 if (vi < 0)
                     return ReturnCode::InvalidPropertyValue();
 
-                stopOffset.store(static_cast<size_t>(vi));
+                stopOffset.store(toPlaybackSamples(vi));
+            }
+
+            if (key == "interpolation") {
+                if (!val.isString())
+                    return ReturnCode::InvalidPropertyType();
+
+                InterpolationMode m;
+
+                if (!parseInterpolationMode((js::String) val, m))
+                    return ReturnCode::InvalidPropertyValue();
+
+                // Make sure the sinc kernel is built here rather than on the realtime thread
+                if (m == InterpolationMode::Sinc)
+                    detail::SincKernel<FloatType>::get();
+
+                interpolation.store(m);
             }
 
             return GraphNode<FloatType>::setProperty(key, val);
         }
 
+        // Converts an offset into the resource as recorded to one into the copy we play
+        size_t toPlaybackSamples(js::Number v) const
+        {
+            return static_cast<size_t>(std::round(static_cast<double>(static_cast<int>(v)) * offsetRatio));
+        }
+
         void reset() override {
             readers[0].noteOff();
             readers[1].noteOff();
@@ -110,27 +150,51 @@ namespace elem
             auto const ostart = startOffset.load();
             auto const ostop = stopOffset.load();
 
+            auto const interp = interpolation.load();
+
             // Optionally accept a second input signal specifying the playback rate
             auto const hasPlaybackRateSignal = numChannels >= 2;
 
+            // Renders both readers over a run of samples between trigger edges. Without a
+            // playback rate signal every read happens at unity rate, so we can use the
+            // readers' block copy path rather than interpolating sample by sample.
+            auto const readRun = [&](size_t runStart, size_t runEnd) {
+                for (auto& reader : readers) {
+                    if (hasPlaybackRateSignal) {
+                        reader.readVariableRate(outputData + runStart, inputData[1] + runStart, runEnd - runStart, ostart, ostop, wantsLoop, interp);
+                    } else {
+                        reader.readUnityRate(outputData + runStart, runEnd - runStart, ostart, ostop, wantsLoop);
+                    }
+                }
+            };
+
+            std::fill_n(outputData, numSamples, FloatType(0));
+
+            size_t runStart = 0;
+
             for (size_t i = 0; i < numSamples; ++i) {
                 auto cv = change(inputData[0][i]);
-                auto const rate = hasPlaybackRateSignal ? inputData[1][i] : FloatType(1);
 
-                // Rising edge
-                if (cv > FloatType(0.5)) {
+                // If we're in trigger mode then we can ignore falling edges
+                auto const rising = cv > FloatType(0.5);
+                auto const falling = cv < FloatType(-0.5) && playbackMode != Mode::Trigger;
+
+                if (rising || falling) {
+                    readRun(runStart, i);
+                    runStart = i;
+                }
+
+                if (rising) {
                     readers[currentReader & 1].noteOff();
                     readers[++currentReader & 1].noteOn(ostart);
                 }
 
-                // If we're in trigger mode then we can ignore falling edges
-                if (cv < FloatType(-0.5) && playbackMode != Mode::Trigger) {
+                if (falling) {
                     readers[currentReader & 1].noteOff();
                 }
-
-                // Process both readers for the current sample
-                outputData[i] = readers[0].tick(ostart, ostop, rate, wantsLoop) + readers[1].tick(ostart, ostop, rate, wantsLoop);
             }
+
+            readRun(runStart, numSamples);
         }
 
         SingleWriterSingleReaderQueue<SharedResourcePtr> bufferQueue;
@@ -150,10 +214,12 @@ namespace elem
         std::atomic<Mode> mode = Mode::Trigger;
         std::atomic<size_t> startOffset = 0;
         std::atomic<size_t> stopOffset = 0;
+        double offsetRatio = 1.0;
+        std::atomic<InterpolationMode> interpolation = InterpolationMode::Linear;
     };
 
-    // A helper struct for reading from sample data with variable rate using
-    // linear interpolation.
+    // A helper struct for reading from sample data with variable rate, by linear
+    // interpolation sample by sample or by any InterpolationMode a block at a time.
     template <typename FloatType>
     struct VariablePitchLerpReader
     {
@@ -178,10 +244,52 @@ namespace elem
 
         FloatType tick (size_t const startOffset, size_t const stopOffset, FloatType const stepSize, bool const wantsLoop)
         {
-            if (sourceBuffer == nullptr || pos < 0.0 || (gain == FloatType(0) && targetGain == FloatType(0)))
+            if (sourceBuffer == nullptr)
+                return FloatType(0);
+
+            return visitChannelData<FloatType>(*sourceBuffer, 0, [&](auto const& bufferView) {
+                return tickFrom(bufferView, startOffset, stopOffset, stepSize, wantsLoop);
+            });
+        }
+
+        // Sums numSamples of unity rate playback into the given output buffer.
+        //
+        // This produces the same result as calling `tick` with a step size of 1 for each
+        // sample, but while the gain is settled and the read position sits on a whole
+        // sample, runs of the source are copied straight across without interpolation.
+        template <typename OutputType>
+        void readUnityRate(OutputType* outputData, size_t numSamples, size_t const startOffset, size_t const stopOffset, bool const wantsLoop)
+        {
+            if (sourceBuffer == nullptr)
+                return;
+
+            visitChannelData<FloatType>(*sourceBuffer, 0, [&](auto const& bufferView) {
+                readUnityRateFrom(bufferView, outputData, numSamples, startOffset, stopOffset, wantsLoop);
+            });
+        }
+
+        // Sums numSamples of playback at the rates given by `stepSizes` into the given
+        // output buffer.
+        //
+        // With linear interpolation this produces the same result as calling `tick` for
+        // each sample. We first step through the block resolving read positions and gains,
+        // then interpolate every read at once with the shared kernel.
+        void readVariableRate(FloatType* outputData, FloatType const* stepSizes, size_t numSamples, size_t const startOffset, size_t const stopOffset, bool const wantsLoop, InterpolationMode mode)
+        {
+            if (sourceBuffer == nullptr)
+                return;
+
+            visitChannelData<FloatType>(*sourceBuffer, 0, [&](auto const& bufferView) {
+                readVariableRateFrom(bufferView, outputData, stepSizes, numSamples, startOffset, stopOffset, wantsLoop, mode);
+            });
+        }
+
+        template <typename SampleType>
+        FloatType tickFrom (BufferView<SampleType> const& bufferView, size_t const startOffset, size_t const stopOffset, FloatType const stepSize, bool const wantsLoop)
+        {
+            if (pos < 0.0 || (gain == FloatType(0) && targetGain == FloatType(0)))
                 return FloatType(0);
 
-            auto bufferView = sourceBuffer->getChannelData(0);
             auto* sourceData = bufferView.data();
             size_t const sourceLength = bufferView.size();
 
@@ -204,8 +312,8 @@ namespace elem
             if (readRight >= sourceLength)
                 readRight -= sourceLength;
 
-            auto const left = sourceData[readLeft];
-            auto const right = sourceData[readRight];
+            auto const left = FloatType(sourceData[readLeft]);
+            auto const right = FloatType(sourceData[readRight]);
 
             // Now we can read the next sample out of the buffer with linear
             // interpolation for sub-sample reads.
@@ -221,6 +329,109 @@ namespace elem
             return out;
         }
 
+        template <typename SampleType, typename OutputType>
+        void readUnityRateFrom(BufferView<SampleType> const& bufferView, OutputType* outputData, size_t numSamples, size_t const startOffset, size_t const stopOffset, bool const wantsLoop)
+        {
+            auto* sourceData = bufferView.data();
+            size_t const sourceLength = bufferView.size();
+
+            size_t i = 0;
+
+            while (i < numSamples) {
+                if (pos < 0.0 || (gain == FloatType(0) && targetGain == FloatType(0)))
+                    return;
+
+                auto const canCopy = gain == targetGain
+                    && pos == std::floor(pos)
+                    && stopOffset < sourceLength
+                    && startOffset < sourceLength - stopOffset;
+
+                if (!canCopy) {
+                    outputData[i++] += static_cast<OutputType>(tickFrom(bufferView, startOffset, stopOffset, FloatType(1), wantsLoop));
+                    continue;
+                }
+
+                auto const readEnd = sourceLength - stopOffset;
+
+                if (pos >= (double) readEnd) {
+                    if (!wantsLoop)
+                        return;
+
+                    pos = (double) startOffset;
+                }
+
+                auto const readStart = static_cast<size_t>(pos);
+                auto const numToCopy = std::min(numSamples - i, readEnd - readStart);
+
+                for (size_t j = 0; j < numToCopy; ++j) {
+                    outputData[i + j] += static_cast<OutputType>(gain * FloatType(sourceData[readStart + j]));
+                }
+
+                pos += (double) numToCopy;
+                i += numToCopy;
+            }
+        }
+
+        template <typename SampleType>
+        void readVariableRateFrom(BufferView<SampleType> const& bufferView, FloatType* outputData, FloatType const* stepSizes, size_t numSamples, size_t const startOffset, size_t const stopOffset, bool const wantsLoop, InterpolationMode mode)
+        {
+            constexpr size_t kChunkSize = 64;
+
+            size_t index[kChunkSize];
+            FloatType frac[kChunkSize];
+            FloatType gains[kChunkSize];
+            FloatType reads[kChunkSize];
+
+            size_t const sourceLength = bufferView.size();
+
+            for (size_t start = 0; start < numSamples; start += kChunkSize) {
+                auto const chunkSize = std::min(kChunkSize, numSamples - start);
+                size_t count = 0;
+
+                // This mirrors tickFrom, except that where tickFrom would return silence
+                // without touching our state, it would do so for every remaining sample in
+                // the run too, so we can stop there
+                bool finished = false;
+
+                for (; count < chunkSize; ++count) {
+                    if (pos < 0.0 || (gain == FloatType(0) && targetGain == FloatType(0))) {
+                        finished = true;
+                        break;
+                    }
+
+                    if (pos >= (double) (sourceLength - stopOffset)) {
+                        if (!wantsLoop) {
+                            finished = true;
+                            break;
+                        }
+
+                        pos = (double) startOffset;
+                    }
+
+                    auto const readLeft = static_cast<size_t>(pos);
+
+                    index[count] = readLeft;
+                    frac[count] = FloatType(pos - (double) readLeft);
+                    gains[count] = gain;
+
+                    auto const gainSettled = std::abs(targetGain - gain) <= std::numeric_limits<FloatType>::epsilon();
+
+                    pos = pos + (double) stepSizes[start + count];
+                    gain = gainSettled ? targetGain : gain + gainSmoothAlpha * (targetGain - gain);
+                    gain = std::clamp(gain, FloatType(0), FloatType(1));
+                }
+
+                interpolate(mode, InterpolationEdge::Wrap, bufferView.data(), sourceLength, index, frac, reads, count);
+
+                for (size_t i = 0; i < count; ++i) {
+                    outputData[start + i] += gains[i] * reads[i];
+                }
+
+                if (finished)
+                    return;
+            }
+        }
+
         SharedResourcePtr sourceBuffer;
 
         FloatType sampleRate = 0;
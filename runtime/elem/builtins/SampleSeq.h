@@ -5,6 +5,7 @@
 #include "../Types.h"
 
 #include "helpers/RefCountedPool.h"
+#include "helpers/RenderAhead.h"
 #include "../third-party/signalsmith-stretch/signalsmith-stretch.h"
 
 #include <map>
@@ -166,6 +167,10 @@ namespace elem
         };
     }
 
+    // With the `background` property set, the stretching variant renders ahead of the
+    // realtime thread on a worker thread, leaving the realtime thread only to copy out
+    // the pre-rendered audio. See detail::RenderAhead for how it follows the time input.
+    // Environments without threads fall back to stretching inline.
     template <typename FloatType, bool WithStretch = false>
     struct SampleSeqNode : public GraphNode<FloatType> {
         SampleSeqNode(NodeId id, FloatType const sr, int const blockSize)
@@ -177,6 +182,33 @@ namespace elem
             }
         }
 
+        using Sequence = std::map<double, FloatType, std::less<double>>;
+        using Ahead = detail::RenderAhead<FloatType, Sequence>;
+
+        // How far ahead the background worker renders, in samples
+        static constexpr size_t kLookahead = 2048;
+
+        void prepare(double sr, size_t bs) override
+        {
+            GraphNode<FloatType>::prepare(sr, bs);
+
+            if constexpr (WithStretch) {
+                // The worker renders in chunks of one block, from this node's stretcher, so
+                // we stop it before touching either. Dropping the last reference joins its
+                // thread, and the background property starts a new one at the new size when
+                // the runtime hands it back to us.
+                while (aheadQueue.size() > 0)
+                    aheadQueue.pop(activeAhead);
+
+                activeAhead = nullptr;
+                ahead = nullptr;
+                rtBackground = false;
+
+                stretch.presetDefault(1, sr);
+                scratchBuffer.assign(bs * 4, FloatType(0));
+            }
+        }
+
 
         int setProperty(std::string const& key, js::Value const& val, SharedResourceMap& resources) override
         {
@@ -185,8 +217,7 @@ namespace elem
                     if (!val.isNumber())
                         return ReturnCode::InvalidPropertyType();
 
-                    auto shift = (js::Number) val;
-                    stretch.setTransposeSemitones(shift);
+                    shiftSemitones.store((js::Number) val);
                 }
 
                 if (key == "stretch") {
@@ -200,6 +231,25 @@ namespace elem
 
                     stretchFactor.store(_stretchFactor);
                 }
+
+                if (key == "background") {
+                    if (!val.isBool())
+                        return ReturnCode::InvalidPropertyType();
+
+                    // The worker is started the first time it's asked for, and kept until
+                    // the node goes away or is prepared again. Without thread support we
+                    // simply stretch inline.
+                    if ((js::Boolean) val && ahead == nullptr) {
+                        auto a = std::make_shared<Ahead>(1, GraphNode<FloatType>::getBlockSize(), kLookahead);
+
+                        if (a->startWorker([this, p = a.get()]() { p->renderAhead(*this); })) {
+                            ahead = a;
+                            aheadQueue.push(std::move(a));
+                        }
+                    }
+
+                    background.store((js::Boolean) val);
+                }
             }
 
             if (key == "duration") {
@@ -280,12 +330,104 @@ namespace elem
             }
         }
 
+        // Takes a new sequence or sample, on whichever thread is rendering
+        void update(std::shared_ptr<Sequence> const& seq, SharedResourcePtr const& buffer)
+        {
+            if (buffer != activeBuffer) {
+                activeBuffer = buffer;
+
+                readers[0].reset(sampleDuration.load());
+                readers[1].reset(sampleDuration.load());
+            }
+
+            // New sequence means we'll have to find our new event boundaries given
+            // the current input time
+            if (seq != nullptr && seq != activeSeq) {
+                activeSeq = seq;
+
+                prevEvent = activeSeq->end();
+                nextEvent = activeSeq->end();
+            }
+        }
+
+        // Starts playback over from wherever the next render call's time lands
+        void seek()
+        {
+            rtSampleDuration = sampleDuration.load();
+
+            readers[0].reset(rtSampleDuration);
+            readers[1].reset(rtSampleDuration);
+
+            if (activeSeq != nullptr) {
+                prevEvent = activeSeq->end();
+                nextEvent = activeSeq->end();
+            }
+
+            if constexpr (WithStretch) {
+                stretch.reset();
+                accFracSamples = 0;
+            }
+        }
+
         void process (BlockContext<FloatType> const& ctx) override {
             auto** inputData = ctx.inputData;
             auto* outputData = ctx.outputData[0];
             auto numChannels = ctx.numInputChannels;
             auto numSamples = ctx.numSamples;
 
+            // Pull newest buffer and seq from their queues
+            while (bufferQueue.size() > 0)
+                bufferQueue.pop(latestBuffer);
+
+            while (seqQueue.size() > 0)
+                seqQueue.pop(latestSeq);
+
+            if (numChannels < 1)
+                return (void) std::fill_n(outputData, numSamples, FloatType(0));
+
+            // Downsampling from a-rate to k-rate
+            auto const t = static_cast<double>(inputData[0][0]);
+
+            if constexpr (WithStretch) {
+                while (aheadQueue.size() > 0)
+                    aheadQueue.pop(activeAhead);
+
+                auto const inBackground = activeAhead != nullptr && background.load();
+
+                if (inBackground != rtBackground) {
+                    // The worker may still be running a job on our state, in which case we
+                    // wait it out before rendering inline again
+                    if (!inBackground && !activeAhead->isIdle())
+                        return (void) std::fill_n(outputData, numSamples, FloatType(0));
+
+                    // Either way, playback picks up again from the current time. The
+                    // worker had rendered ahead of it.
+                    if (inBackground) {
+                        activeAhead->restart();
+                    } else {
+                        seek();
+                    }
+
+                    rtBackground = inBackground;
+                }
+
+                if (rtBackground) {
+                    activeAhead->process(t, { 0, 0, 0, stretchFactor.load(), shiftSemitones.load(), latestSeq, latestBuffer }, ctx.outputData, 1, numSamples);
+                    return;
+                }
+
+                update(latestSeq, latestBuffer);
+                render(t, stretchFactor.load(), shiftSemitones.load(), ctx.outputData, 1, numSamples);
+            } else {
+                update(latestSeq, latestBuffer);
+                render(t, 1.0, 0.0, ctx.outputData, 1, numSamples);
+            }
+        }
+
+        void render(double t, double factor, double shift, FloatType** outputs, size_t /* numOutputChannels */, size_t numSamples)
+        {
+            auto* outputData = outputs[0];
+
             // Load sample duration
             auto const sampleDur = sampleDuration.load();
 
@@ -295,29 +437,9 @@ namespace elem
                 rtSampleDuration = sampleDur;
             }
 
-            // Pull newest buffer from queue
-            while (bufferQueue.size() > 0) {
-                bufferQueue.pop(activeBuffer);
-
-                readers[0].reset(sampleDur);
-                readers[1].reset(sampleDur);
-            }
-
-            // Pull newest seq from queue
-            if (seqQueue.size() > 0) {
-                while (seqQueue.size() > 0) {
-                    seqQueue.pop(activeSeq);
-                }
-
-                // New sequence means we'll have to find our new event boundaries given
-                // the current input time
-                prevEvent = activeSeq->end();
-                nextEvent = activeSeq->end();
-            }
-
             // Next, if we don't have the inputs we need, we bail here and zero the buffer
             // hoping to prevent unexpected signals.
-            if (numChannels < 1 || activeSeq == nullptr || activeSeq->size() == 0 || activeBuffer == nullptr || sampleDur <= 0.0)
+            if (activeSeq == nullptr || activeSeq->size() == 0 || activeBuffer == nullptr || sampleDur <= 0.0)
                 return (void) std::fill_n(outputData, numSamples, FloatType(0));
 
             // We reference this a lot
@@ -328,9 +450,6 @@ namespace elem
             auto const before = [](double t1, double t2) { return t1 <= (t2 + 1e-6); };
             auto const after = [](double t1, double t2) { return t1 >= (t2 - 1e-6); };
 
-            // Downsampling from a-rate to k-rate
-            auto const t = static_cast<double>(inputData[0][0]);
-
             // We update our event boundaries if we just took a new sequence, if we've stepped
             // forwards or backwards over the next event time, or if the incoming time step differs
             // excessively from what we expected
@@ -346,11 +465,16 @@ namespace elem
             }
 
             if constexpr (WithStretch) {
+                if (shift != rtShift) {
+                    stretch.setTransposeSemitones(shift);
+                    rtShift = shift;
+                }
+
                 // Some fractional sample counting here. Every time we calculate the number of
                 // source samples, we inevitably leave a little rounding error. To ensure we
                 // average out correctly over time, we accumulate that rounding error and nudge
                 // our numSourceSamples once the accumulated error exceeds a full sample.
-                double const trueSourceSamples = (double) numSamples / stretchFactor.load();
+                double const trueSourceSamples = (double) numSamples / factor;
                 size_t numSourceSamples = static_cast<size_t>(trueSourceSamples);
 
                 accFracSamples += (trueSourceSamples - (double) numSourceSamples);
@@ -378,8 +502,6 @@ namespace elem
             }
         }
 
-        using Sequence = std::map<double, FloatType, std::less<double>>;
-
         RefCountedPool<Sequence> seqPool;
         SingleWriterSingleReaderQueue<std::shared_ptr<Sequence>> seqQueue;
         std::shared_ptr<Sequence> activeSeq;
@@ -390,6 +512,11 @@ namespace elem
         SingleWriterSingleReaderQueue<SharedResourcePtr> bufferQueue;
         SharedResourcePtr activeBuffer;
 
+        // The newest sequence and buffer, as seen from the realtime thread. The rendering
+        // thread, which is the worker in the background, takes them via `update`.
+        std::shared_ptr<Sequence> latestSeq;
+        SharedResourcePtr latestBuffer;
+
         std::array<detail::BufferReader<float>, 2> readers;
         size_t activeReader = 0;
         int64_t nextExpectedBlockStart = 0;
@@ -400,7 +527,18 @@ namespace elem
         signalsmith::stretch::SignalsmithStretch<FloatType> stretch;
         double accFracSamples = 0;
         std::atomic<double> stretchFactor = 1.0;
+        std::atomic<double> shiftSemitones = 0.0;
+        double rtShift = 0;
         std::vector<FloatType> scratchBuffer;
+
+        std::atomic<bool> background = false;
+        bool rtBackground = false;
+
+        // Declared last so that the worker is stopped before the state it renders from
+        // goes away
+        std::shared_ptr<Ahead> ahead;
+        SingleWriterSingleReaderQueue<std::shared_ptr<Ahead>> aheadQueue;
+        std::shared_ptr<Ahead> activeAhead;
     };
 
     template <typename FloatType>
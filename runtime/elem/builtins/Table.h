@@ -4,6 +4,8 @@
 #include "../SingleWriterSingleReaderQueue.h"
 #include "../Types.h"
 
+#include "helpers/Interpolation.h"
+
 
 namespace elem
 {
@@ -13,6 +15,9 @@ namespace elem
     // Can be used for loading sample buffers and reading from them at variable
     // playback rates, or as windowed grain readers, or for loading various functions
     // as lookup tables, etc.
+    //
+    // The `interpolation` property selects between "linear" (the default), "hermite"
+    // and "sinc" reads, with reads past either end of the table repeating the end sample.
     template <typename FloatType>
     struct TableNode : public GraphNode<FloatType> {
         using GraphNode<FloatType>::GraphNode;
@@ -30,6 +35,22 @@ namespace elem
                 bufferQueue.push(std::move(ref));
             }
 
+            if (key == "interpolation") {
+                if (!val.isString())
+                    return ReturnCode::InvalidPropertyType();
+
+                InterpolationMode m;
+
+                if (!parseInterpolationMode((js::String) val, m))
+                    return ReturnCode::InvalidPropertyValue();
+
+                // Make sure the sinc kernel is built here rather than on the realtime thread
+                if (m == InterpolationMode::Sinc)
+                    detail::SincKernel<FloatType>::get();
+
+                interpolation.store(m);
+            }
+
             return GraphNode<FloatType>::setProperty(key, val);
         }
 
@@ -48,29 +69,41 @@ namespace elem
             if (numChannels == 0 || activeBuffer == nullptr)
                 return (void) std::fill_n(outputData, numSamples, FloatType(0));
 
-            auto const bufferView = activeBuffer->getChannelData(0);
-            auto const bufferSize = static_cast<int>(bufferView.size());
-            auto const bufferData = bufferView.data();
+            // Reading through visitChannelData lets a double precision graph read double
+            // resource data directly, without a per-sample conversion
+            visitChannelData<FloatType>(*activeBuffer, 0, [&](auto const& bufferView) {
+                auto const bufferSize = bufferView.size();
+                auto const bufferData = bufferView.data();
 
-            if (bufferSize == 0)
-                return (void) std::fill_n(outputData, numSamples, FloatType(0));
+                if (bufferSize == 0)
+                    return (void) std::fill_n(outputData, numSamples, FloatType(0));
 
-            // Finally, render sample output
-            for (size_t i = 0; i < numSamples; ++i) {
-                auto const readPos = std::clamp(inputData[0][i], FloatType(0), FloatType(1)) * FloatType(bufferSize - 1);
-                auto const readLeft = static_cast<int>(readPos);
-                auto const readRight = readLeft + 1;
-                auto const frac = readPos - std::floor(readPos);
+                auto const m = interpolation.load();
 
-                auto const left = bufferData[readLeft % bufferSize];
-                auto const right = bufferData[readRight % bufferSize];
+                // Finally, render sample output, resolving the read positions for each
+                // chunk of the block before handing them to the interpolator
+                for (size_t start = 0; start < numSamples; start += kChunkSize) {
+                    auto const count = std::min(kChunkSize, numSamples - start);
 
-                // Now we can read the next sample out with linear
-                // interpolation for sub-sample reads.
-                outputData[i] = left + frac * (right - left);
-            }
+                    for (size_t i = 0; i < count; ++i) {
+                        auto const readPos = std::clamp(inputData[0][start + i], FloatType(0), FloatType(1)) * FloatType(bufferSize - 1);
+
+                        index[i] = static_cast<size_t>(readPos);
+                        frac[i] = readPos - static_cast<FloatType>(index[i]);
+                    }
+
+                    interpolate(m, InterpolationEdge::Clamp, bufferData, bufferSize, index, frac, outputData + start, count);
+                }
+            });
         }
 
+        static constexpr size_t kChunkSize = 64;
+
+        size_t index[kChunkSize];
+        FloatType frac[kChunkSize];
+
+        std::atomic<InterpolationMode> interpolation { InterpolationMode::Linear };
+
         SingleWriterSingleReaderQueue<SharedResourcePtr> bufferQueue;
         SharedResourcePtr activeBuffer;
     };
@@ -0,0 +1,205 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+
+#include "../GraphNode.h"
+#include "../Subgraph.h"
+
+
+namespace elem
+{
+
+    namespace detail
+    {
+        template <typename FloatType>
+        struct VoiceBank {
+            std::vector<SubgraphInstance<FloatType>> voices;
+            std::vector<char> active;
+            std::vector<char> gated;
+            std::vector<size_t> activeList;
+            std::vector<FloatType const*> inputPtrs;
+        };
+    }
+
+    // A polyphonic voice container: renders `voices` instances of the subgraph given in
+    // its `template` property as one node in the render sequence.
+    //
+    // Children are grouped by voice: with K inputs per voice, voice v receives children
+    // v * K through v * K + K - 1 as its input channels 0 to K - 1, which its template
+    // reads with `in` nodes. Any children after the last voice's inputs are shared, and
+    // follow each voice's own inputs. K is given by the `inputs` property, and otherwise
+    // divides the children evenly between voices.
+    //
+    // The input channel given by the `gate` property (0 by default) drives voice activity.
+    // A voice is processed while its gate is high, and for as long afterwards as its output
+    // keeps sounding; once a whole block comes out silent with the gate low, the voice goes
+    // idle, and costs nothing until its gate rises again. A negative `gate` keeps every
+    // voice running.
+    //
+    // Voices are processed node by node: each node of the template runs for every active
+    // voice before the next node runs, so that one node type's code and coefficients stay
+    // hot across voices. The outputs of the template are summed across voices into the
+    // container's output channels.
+    template <typename FloatType>
+    struct VoicesNode : public SubgraphContainerNode<FloatType, detail::VoiceBank<FloatType>> {
+        using VoiceBank = detail::VoiceBank<FloatType>;
+        using Container = SubgraphContainerNode<FloatType, VoiceBank>;
+        using Container::Container;
+
+        static constexpr size_t kMaxVoices = 1024;
+        static constexpr size_t kMaxVoiceInputs = 64;
+
+        // Peak output level below which a released voice counts as silent
+        static constexpr FloatType kSilenceThreshold = FloatType(1e-5);
+
+        int setProperty(std::string const& key, js::Value const& val, SharedResourceMap& resources) override
+        {
+            if (key == "voices") {
+                if (!val.isNumber())
+                    return ReturnCode::InvalidPropertyType();
+
+                auto const n = static_cast<size_t>((js::Number) val);
+
+                if (n < 1 || n > kMaxVoices)
+                    return ReturnCode::InvalidPropertyValue();
+
+                if (n != numVoices) {
+                    numVoices = n;
+
+                    if (auto res = Container::rebuild(resources); res != ReturnCode::Ok())
+                        return res;
+                }
+            }
+
+            if (key == "inputs" || key == "gate") {
+                if (!val.isNumber())
+                    return ReturnCode::InvalidPropertyType();
+
+                auto const v = static_cast<int>((js::Number) val);
+
+                if (key == "inputs" && (v < 0 || v > static_cast<int>(kMaxVoiceInputs)))
+                    return ReturnCode::InvalidPropertyValue();
+
+                (key == "inputs" ? inputsPerVoice : gateIndex).store(v);
+            }
+
+            return Container::setProperty(key, val, resources);
+        }
+
+        int buildEngine(VoiceBank& bank, SharedResourceMap& resources) override
+        {
+            bank.voices.resize(numVoices);
+
+            for (auto& voice : bank.voices) {
+                auto const res = voice.build(Container::subgraphTemplate, Container::factory, GraphNode<FloatType>::getSampleRate(), static_cast<int>(GraphNode<FloatType>::getBlockSize()), resources);
+
+                if (res != ReturnCode::Ok())
+                    return res;
+            }
+
+            bank.active.assign(numVoices, 0);
+            bank.gated.assign(numVoices, 0);
+            bank.activeList.assign(numVoices, 0);
+            bank.inputPtrs.assign(numVoices * kMaxVoiceInputs, nullptr);
+
+            return ReturnCode::Ok();
+        }
+
+        void forEachSubgraph(VoiceBank& bank, std::function<void(SubgraphInstance<FloatType>&)> const& fn) override
+        {
+            for (auto& voice : bank.voices)
+                fn(voice);
+        }
+
+        void process (BlockContext<FloatType> const& ctx) override {
+            auto** inputData = ctx.inputData;
+            auto** outputData = ctx.outputData;
+            auto numChildren = ctx.numInputChannels;
+            auto numSamples = ctx.numSamples;
+
+            auto* activeBank = Container::getActiveEngine();
+
+            for (size_t j = 0; j < ctx.numOutputChannels; ++j)
+                std::fill_n(outputData[j], numSamples, FloatType(0));
+
+            if (activeBank == nullptr)
+                return;
+
+            auto& bank = *activeBank;
+            auto const n = bank.voices.size();
+
+            // Work out which children each voice sees
+            auto const requested = inputsPerVoice.load();
+            auto const perVoice = requested >= 0 ? std::min(static_cast<size_t>(requested), numChildren / n) : numChildren / n;
+            auto const numShared = numChildren - perVoice * n;
+            auto const numVoiceInputs = std::min(perVoice + numShared, kMaxVoiceInputs);
+            auto const gate = gateIndex.load();
+            auto const hasGate = gate >= 0 && static_cast<size_t>(gate) < numVoiceInputs;
+
+            size_t numActive = 0;
+
+            for (size_t v = 0; v < n; ++v) {
+                auto* ptrs = bank.inputPtrs.data() + v * kMaxVoiceInputs;
+
+                for (size_t k = 0; k < numVoiceInputs; ++k)
+                    ptrs[k] = k < perVoice ? inputData[v * perVoice + k] : inputData[n * perVoice + (k - perVoice)];
+
+                bool gated = !hasGate;
+
+                if (hasGate) {
+                    auto const* g = ptrs[gate];
+
+                    for (size_t i = 0; i < numSamples && !gated; ++i)
+                        gated = g[i] > FloatType(0);
+                }
+
+                bank.gated[v] = gated;
+
+                if (gated)
+                    bank.active[v] = 1;
+
+                if (bank.active[v])
+                    bank.activeList[numActive++] = v;
+            }
+
+            // Node by node, across every active voice
+            auto const numNodes = n > 0 ? bank.voices[0].getNumNodes() : size_t(0);
+
+            for (size_t i = 0; i < numNodes; ++i) {
+                for (size_t a = 0; a < numActive; ++a) {
+                    auto const v = bank.activeList[a];
+                    bank.voices[v].processNode(i, bank.inputPtrs.data() + v * kMaxVoiceInputs, numVoiceInputs, numSamples, ctx.userData);
+                }
+            }
+
+            auto const numOutputs = std::min(ctx.numOutputChannels, n > 0 ? bank.voices[0].getNumOutputs() : size_t(0));
+
+            for (size_t a = 0; a < numActive; ++a) {
+                auto const v = bank.activeList[a];
+                auto& voice = bank.voices[v];
+                FloatType peak = 0;
+
+                for (size_t c = 0; c < numOutputs; ++c) {
+                    auto const* data = voice.getOutput(c);
+
+                    for (size_t i = 0; i < numSamples; ++i) {
+                        outputData[c][i] += data[i];
+                        peak = std::max(peak, std::abs(data[i]));
+                    }
+                }
+
+                if (!bank.gated[v] && peak < kSilenceThreshold)
+                    bank.active[v] = 0;
+            }
+        }
+
+        // Props, as seen from the non-realtime thread
+        size_t numVoices = 1;
+
+        std::atomic<int> inputsPerVoice = -1;
+        std::atomic<int> gateIndex = 0;
+    };
+
+} // namespace elem
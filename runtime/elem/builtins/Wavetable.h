@@ -0,0 +1,112 @@
+#pragma once
+
+#include "../GraphNode.h"
+#include "../SingleWriterSingleReaderQueue.h"
+#include "../Types.h"
+#include "../WavetableResource.h"
+
+
+namespace elem
+{
+
+    // WavetableNode is a band-limited table reader for wavetable oscillators.
+    //
+    // Like TableNode, it expects a single child carrying a read position, typically a
+    // phasor, and reads one cycle of the waveform loaded at the `path` property. On first
+    // use of a path, a WavetableResource with band-limited mip levels is derived from the
+    // resource and cached in the resource map.
+    //
+    // The read rate is taken from the change in read position from one sample to the next,
+    // and the node blends between the two mip levels bracketing that rate such that no
+    // harmonic it plays crosses Nyquist. The crossfade keeps the timbre continuous as the
+    // pitch sweeps across level boundaries.
+    template <typename FloatType>
+    struct WavetableNode : public GraphNode<FloatType> {
+        using GraphNode<FloatType>::GraphNode;
+
+        int setProperty(std::string const& key, js::Value const& val, SharedResourceMap& resources) override
+        {
+            if (key == "path") {
+                if (!val.isString())
+                    return ReturnCode::InvalidPropertyType();
+
+                if (!resources.has((js::String) val))
+                    return ReturnCode::InvalidPropertyValue();
+
+                auto ref = resources.getDerived((js::String) val, "wavetable", [](SharedResourcePtr const& source) -> SharedResourcePtr {
+                    return visitChannelData<FloatType>(*source, 0, [](auto const& view) {
+                        return std::make_shared<WavetableResource>(view.data(), view.size());
+                    });
+                });
+
+                auto table = std::dynamic_pointer_cast<WavetableResource>(ref);
+
+                if (table == nullptr || table->getNumLevels() == 0)
+                    return ReturnCode::InvalidPropertyValue();
+
+                tableQueue.push(std::move(table));
+            }
+
+            return GraphNode<FloatType>::setProperty(key, val);
+        }
+
+        void process (BlockContext<FloatType> const& ctx) override {
+            auto** inputData = ctx.inputData;
+            auto* outputData = ctx.outputData[0];
+            auto numChannels = ctx.numInputChannels;
+            auto numSamples = ctx.numSamples;
+
+            while (tableQueue.size() > 0)
+                tableQueue.pop(activeTable);
+
+            if (numChannels == 0 || activeTable == nullptr)
+                return (void) std::fill_n(outputData, numSamples, FloatType(0));
+
+            auto const tableSize = activeTable->getTableSize();
+            auto const lastLevel = static_cast<FloatType>(activeTable->getNumLevels() - 1);
+            auto const log2TableSize = std::log2(static_cast<FloatType>(tableSize));
+
+            for (size_t i = 0; i < numSamples; ++i) {
+                auto const x = inputData[0][i];
+
+                // Phase increment in cycles per sample, accounting for wraparound
+                auto delta = x - prevPosition;
+                delta = std::abs(delta - std::round(delta));
+                prevPosition = x;
+
+                // Level k holds harmonics up to tableSize / 2^(k + 1), which are all below
+                // Nyquist as long as k >= log2(tableSize * delta). We read from one level above
+                // that, fading toward the next, so that both levels in the blend are clean.
+                auto const level = delta > FloatType(0)
+                    ? std::clamp(std::log2(delta) + log2TableSize + FloatType(1), FloatType(0), lastLevel)
+                    : FloatType(0);
+
+                auto const levelIndex = static_cast<size_t>(level);
+                auto const levelFrac = level - static_cast<FloatType>(levelIndex);
+
+                // Linear interpolation within each level, relying on the guard sample
+                // for the wraparound
+                auto const pos = (x - std::floor(x)) * static_cast<FloatType>(tableSize);
+                auto const readLeft = std::min(static_cast<size_t>(pos), tableSize - 1);
+                auto const frac = pos - static_cast<FloatType>(readLeft);
+
+                auto const read = [&](size_t k) {
+                    auto const* data = activeTable->getLevelData(k);
+                    return FloatType(data[readLeft]) + frac * (FloatType(data[readLeft + 1]) - FloatType(data[readLeft]));
+                };
+
+                auto const lower = read(levelIndex);
+
+                outputData[i] = (levelFrac > FloatType(0))
+                    ? lower + levelFrac * (read(levelIndex + 1) - lower)
+                    : lower;
+            }
+        }
+
+        SingleWriterSingleReaderQueue<std::shared_ptr<WavetableResource>> tableQueue;
+        std::shared_ptr<WavetableResource> activeTable;
+
+        FloatType prevPosition = 0;
+    };
+
+} // namespace elem
@@ -0,0 +1,284 @@
+#pragma once
+
+#include "../../GraphNode.h"
+#include "../../SingleWriterSingleReaderQueue.h"
+
+#include "../helpers/RefCountedPool.h"
+#include "../helpers/SIMD.h"
+
+
+namespace elem
+{
+
+    // A bank of second order Transposed Direct Form II sections, configured from props.
+    //
+    // The `coeffs` property holds five coefficients per section, [b0, b1, b2, a1, a2],
+    // normalized such that a0 = 1 as with the biquad node, and the `mode` property chooses
+    // whether the sections run in series ("cascade", the default) or side by side with
+    // their outputs summed ("parallel"). Each child is an independent channel filtered by
+    // the same bank, written to the matching output channel; the `channels` property sets
+    // how many channels hold filter state.
+    //
+    // Sections are processed several at a time in SIMD lanes. In parallel mode that falls
+    // out naturally since every section sees the same input. In cascade mode section k
+    // depends on the output of section k - 1, so we skew the sections across time: at
+    // step n, section k processes sample n - k, which its predecessor produced on the
+    // previous step. That keeps every lane busy without adding latency, at the cost of
+    // a short ramp in and out at the edges of each block.
+    template <typename FloatType>
+    struct BiquadBankNode : public GraphNode<FloatType> {
+        using GraphNode<FloatType>::GraphNode;
+        using Vec = simd::Vec<FloatType>;
+
+        enum class Mode {
+            Cascade = 0,
+            Parallel = 1,
+        };
+
+        // Coefficients and state, laid out one array per coefficient with each section in
+        // its own lane. Arrays are padded to a whole number of vectors with zeroed sections,
+        // which output silence.
+        struct Bank {
+            size_t numSections = 0;
+            size_t numChannels = 0;
+            size_t paddedSize = 0;
+
+            std::vector<FloatType> b0, b1, b2, a1, a2;
+            std::vector<FloatType> z1, z2;
+
+            // Cascade mode's inputs to each section for the current step, plus one slot
+            // for the last section's output
+            std::vector<FloatType> io;
+        };
+
+        int setProperty(std::string const& key, js::Value const& val) override
+        {
+            if (key == "mode") {
+                if (!val.isString())
+                    return ReturnCode::InvalidPropertyType();
+
+                auto const m = (js::String) val;
+
+                if (m != "cascade" && m != "parallel")
+                    return ReturnCode::InvalidPropertyValue();
+
+                _mode.store(m == "parallel" ? Mode::Parallel : Mode::Cascade);
+            }
+
+            if (key == "channels") {
+                if (!val.isNumber())
+                    return ReturnCode::InvalidPropertyType();
+
+                auto const n = (js::Number) val;
+
+                if (n < 1)
+                    return ReturnCode::InvalidPropertyValue();
+
+                numChannels = static_cast<size_t>(n);
+
+                // Nothing to rebuild until we've seen coefficients
+                if (!coeffs.empty())
+                    updateBank();
+            }
+
+            if (key == "coeffs") {
+                std::vector<FloatType> next;
+
+                if (val.isFloat32Array()) {
+                    auto const& arr = val.getFloat32Array();
+                    next.assign(arr.begin(), arr.end());
+                } else if (val.isArray()) {
+                    auto const& arr = val.getArray();
+
+                    for (size_t i = 0; i < arr.size(); ++i) {
+                        if (!arr[i].isNumber())
+                            return ReturnCode::InvalidPropertyType();
+
+                        next.push_back(FloatType((js::Number) arr[i]));
+                    }
+                } else {
+                    return ReturnCode::InvalidPropertyType();
+                }
+
+                if (next.empty() || next.size() % 5 != 0)
+                    return ReturnCode::InvalidPropertyValue();
+
+                coeffs = std::move(next);
+                updateBank();
+            }
+
+            return GraphNode<FloatType>::setProperty(key, val);
+        }
+
+        void updateBank()
+        {
+            auto bank = bankPool.allocate();
+
+            auto const numSections = coeffs.size() / 5;
+            auto const paddedSize = ((numSections + Vec::size - 1) / Vec::size) * Vec::size;
+
+            bank->numSections = numSections;
+            bank->numChannels = numChannels;
+            bank->paddedSize = paddedSize;
+
+            for (auto* v : { &bank->b0, &bank->b1, &bank->b2, &bank->a1, &bank->a2 })
+                v->assign(paddedSize, FloatType(0));
+
+            for (size_t i = 0; i < numSections; ++i) {
+                bank->b0[i] = coeffs[i * 5 + 0];
+                bank->b1[i] = coeffs[i * 5 + 1];
+                bank->b2[i] = coeffs[i * 5 + 2];
+                bank->a1[i] = coeffs[i * 5 + 3];
+                bank->a2[i] = coeffs[i * 5 + 4];
+            }
+
+            bank->z1.assign(paddedSize * numChannels, FloatType(0));
+            bank->z2.assign(paddedSize * numChannels, FloatType(0));
+            bank->io.assign(paddedSize + 1, FloatType(0));
+
+            bankQueue.push(std::move(bank));
+        }
+
+        // One step of the sections in the lanes starting at `offset`, returning their outputs
+        static inline Vec tickVector(Bank& bank, size_t offset, FloatType* z1, FloatType* z2, Vec in)
+        {
+            auto const y = Vec::load(bank.b0.data() + offset) * in + Vec::load(z1 + offset);
+
+            (Vec::load(bank.b1.data() + offset) * in - Vec::load(bank.a1.data() + offset) * y + Vec::load(z2 + offset)).store(z1 + offset);
+            (Vec::load(bank.b2.data() + offset) * in - Vec::load(bank.a2.data() + offset) * y).store(z2 + offset);
+
+            return y;
+        }
+
+        static inline FloatType tickScalar(Bank& bank, size_t k, FloatType* z1, FloatType* z2, FloatType in)
+        {
+            auto const y = bank.b0[k] * in + z1[k];
+            z1[k] = bank.b1[k] * in - bank.a1[k] * y + z2[k];
+            z2[k] = bank.b2[k] * in - bank.a2[k] * y;
+            return y;
+        }
+
+        void processCascade(Bank& bank, size_t channel, FloatType const* x, FloatType* out, size_t numSamples)
+        {
+            auto* z1 = bank.z1.data() + channel * bank.paddedSize;
+            auto* z2 = bank.z2.data() + channel * bank.paddedSize;
+            auto* io = bank.io.data();
+
+            auto const numSections = bank.numSections;
+            auto const numGroups = bank.paddedSize / Vec::size;
+
+            for (size_t n = 0; n < numSamples + numSections - 1; ++n) {
+                io[0] = n < numSamples ? x[n] : FloatType(0);
+
+                // Section k processes sample n - k on this step, so only those sections with
+                // 0 <= n - k < numSamples have anything to do
+                auto const lo = n >= numSamples ? n - numSamples + 1 : 0;
+                auto const hi = std::min(n, numSections - 1);
+
+                // Walking the groups, and the sections within them, from last to first lets
+                // each section write its output into the slot its successor has already read
+                for (size_t g = numGroups; g-- > 0;) {
+                    auto const first = g * Vec::size;
+                    auto const last = std::min(first + Vec::size, numSections) - 1;
+
+                    if (first > hi || last < lo)
+                        continue;
+
+                    if (first >= lo && last <= hi) {
+                        tickVector(bank, first, z1, z2, Vec::load(io + first)).store(io + first + 1);
+                        continue;
+                    }
+
+                    for (size_t k = std::min(last, hi) + 1; k-- > std::max(first, lo);) {
+                        io[k + 1] = tickScalar(bank, k, z1, z2, io[k]);
+                    }
+                }
+
+                if (n + 1 >= numSections)
+                    out[n + 1 - numSections] = io[numSections];
+            }
+        }
+
+        void processParallel(Bank& bank, size_t channel, FloatType const* x, FloatType* out, size_t numSamples)
+        {
+            auto* z1 = bank.z1.data() + channel * bank.paddedSize;
+            auto* z2 = bank.z2.data() + channel * bank.paddedSize;
+
+            FloatType lanes[Vec::size];
+
+            for (size_t n = 0; n < numSamples; ++n) {
+                auto const in = Vec::broadcast(x[n]);
+                auto acc = Vec::broadcast(FloatType(0));
+
+                for (size_t offset = 0; offset < bank.paddedSize; offset += Vec::size) {
+                    acc = acc + tickVector(bank, offset, z1, z2, in);
+                }
+
+                acc.store(lanes);
+
+                FloatType sum = 0;
+
+                for (size_t i = 0; i < Vec::size; ++i)
+                    sum += lanes[i];
+
+                out[n] = sum;
+            }
+        }
+
+        void process (BlockContext<FloatType> const& ctx) override {
+            auto** inputData = ctx.inputData;
+            auto** outputData = ctx.outputData;
+            auto numInputChannels = ctx.numInputChannels;
+            auto numOutputChannels = ctx.numOutputChannels;
+            auto numSamples = ctx.numSamples;
+
+            // Pick up the latest bank, carrying filter state across if the shape of the
+            // bank hasn't changed so that coefficient updates don't click
+            while (bankQueue.size() > 0) {
+                std::shared_ptr<Bank> next;
+                bankQueue.pop(next);
+
+                if (activeBank && activeBank->paddedSize == next->paddedSize && activeBank->numChannels == next->numChannels) {
+                    std::copy(activeBank->z1.begin(), activeBank->z1.end(), next->z1.begin());
+                    std::copy(activeBank->z2.begin(), activeBank->z2.end(), next->z2.begin());
+                } else {
+                    std::fill(next->z1.begin(), next->z1.end(), FloatType(0));
+                    std::fill(next->z2.begin(), next->z2.end(), FloatType(0));
+                }
+
+                activeBank = std::move(next);
+            }
+
+            auto const m = _mode.load();
+
+            for (size_t ch = 0; ch < numOutputChannels; ++ch) {
+                auto* out = outputData[ch];
+
+                // If we don't have the inputs we need, we bail here and zero the buffer
+                // hoping to prevent unexpected signals.
+                if (activeBank == nullptr || ch >= numInputChannels || ch >= activeBank->numChannels) {
+                    std::fill_n(out, numSamples, FloatType(0));
+                    continue;
+                }
+
+                if (m == Mode::Parallel) {
+                    processParallel(*activeBank, ch, inputData[ch], out, numSamples);
+                } else {
+                    processCascade(*activeBank, ch, inputData[ch], out, numSamples);
+                }
+            }
+        }
+
+        // Props, as seen from the non-realtime thread
+        std::vector<FloatType> coeffs;
+        size_t numChannels = 1;
+
+        std::atomic<Mode> _mode { Mode::Cascade };
+        static_assert(std::atomic<Mode>::is_always_lock_free);
+
+        RefCountedPool<Bank> bankPool;
+        SingleWriterSingleReaderQueue<std::shared_ptr<Bank>> bankQueue;
+        std::shared_ptr<Bank> activeBank;
+    };
+
+} // namespace elem
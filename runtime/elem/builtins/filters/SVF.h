@@ -1,6 +1,8 @@
 #pragma once
 
 #include "../../GraphNode.h"
+#include "../helpers/BufferUtils.h"
+#include "../helpers/FloatUtils.h"
 
 
 namespace elem
@@ -14,7 +16,9 @@ namespace elem
     // which defines the cutoff frequency, one which defines the filter Q, and finally
     // the input signal itself. Accepting these inputs as audio signals allows for
     // fast modulation at the processing expense of computing the coefficients on
-    // every tick of the filter.
+    // every tick of the filter. To keep that expense down, a block over which the
+    // cutoff and Q hold constant computes its coefficients once, or not at all if
+    // they match the previous block's.
     template <typename FloatType>
     struct StateVariableFilterNode : public GraphNode<FloatType> {
         using GraphNode<FloatType>::GraphNode;
@@ -45,6 +49,15 @@ namespace elem
             return GraphNode<FloatType>::setProperty(key, val);
         }
 
+        void prepare(double sr, size_t bs) override
+        {
+            GraphNode<FloatType>::prepare(sr, bs);
+
+            // The cached coefficients were warped for the old rate
+            _lastFc = std::numeric_limits<double>::quiet_NaN();
+            _lastQ = std::numeric_limits<double>::quiet_NaN();
+        }
+
         inline FloatType tick (Mode m, FloatType v0) {
             double v3 = v0 - _ic2eq;
             double v1 = _ic1eq * _a1 + v3 * _a2;
@@ -72,11 +85,18 @@ namespace elem
         inline void updateCoeffs (double fc, double q) {
             auto const sr = GraphNode<FloatType>::getSampleRate();
 
-            _g = std::tan(3.14159265359 * std::clamp(fc, 20.0, sr / 2.0001)  / sr);
+            // With g = gn / gd, a1 = 1 / (1 + g * (g + k)) = gd^2 / (gd^2 + gn * (gn + k * gd)),
+            // which lets the three coefficients share a single division
+            double gn = 0, gd = 1;
+            prewarpTan(3.14159265359 * std::clamp(fc, 20.0, sr / 2.0001)  / sr, gn, gd);
+
             _k = 1.0 / std::clamp(q, 0.25, 20.0);
-            _a1 = 1.0 / (1.0 + _g * (_g + _k));
-            _a2 = _g * _a1;
-            _a3 = _g * _a2;
+
+            auto const d = 1.0 / (gd * gd + gn * (gn + _k * gd));
+
+            _a1 = gd * gd * d;
+            _a2 = gn * gd * d;
+            _a3 = gn * gn * d;
         }
 
         void process (BlockContext<FloatType> const& ctx) override {
@@ -88,9 +108,28 @@ namespace elem
             auto m = _mode.load();
 
             // If we don't have the inputs we need, bail here and zero the buffer
-            if (numChannels < 3)
+            if (numChannels < 3 || numSamples == 0)
                 return (void) std::fill_n(outputData, numSamples, FloatType(0));
 
+            // When the cutoff and Q hold steady over the block, which is by far the
+            // common case, we compute the coefficients at most once
+            if (util::is_constant(inputData[0], numSamples) && util::is_constant(inputData[1], numSamples)) {
+                auto const fc = inputData[0][0];
+                auto const q = inputData[1][0];
+
+                if (fc != _lastFc || q != _lastQ) {
+                    updateCoeffs(fc, q);
+                    _lastFc = fc;
+                    _lastQ = q;
+                }
+
+                for (size_t i = 0; i < numSamples; ++i) {
+                    outputData[i] = tick(m, inputData[2][i]);
+                }
+
+                return;
+            }
+
             for (size_t i = 0; i < numSamples; ++i) {
                 auto fc = inputData[0][i];
                 auto q = inputData[1][i];
@@ -102,6 +141,9 @@ namespace elem
                 // Tick the filter
                 outputData[i] = tick(m, xn);
             }
+
+            _lastFc = inputData[0][numSamples - 1];
+            _lastQ = inputData[1][numSamples - 1];
         }
 
         // Props
@@ -109,12 +151,16 @@ namespace elem
         static_assert(std::atomic<Mode>::is_always_lock_free);
 
         // Coefficients
-        double _g = 0;
         double _k = 0;
         double _a1 = 0;
         double _a2 = 0;
         double _a3 = 0;
 
+        // The inputs the current coefficients were computed from. NaN never compares
+        // equal, which forces the first computation.
+        double _lastFc = std::numeric_limits<double>::quiet_NaN();
+        double _lastQ = std::numeric_limits<double>::quiet_NaN();
+
         // State
         double _ic1eq = 0;
         double _ic2eq = 0;
@@ -1,6 +1,8 @@
 #pragma once
 
 #include "../../GraphNode.h"
+#include "../helpers/BufferUtils.h"
+#include "../helpers/FloatUtils.h"
 
 
 namespace elem
@@ -16,6 +18,8 @@ namespace elem
     //
     // Accepting these inputs as audio signals allows for fast modulation at the
     // processing expense of computing the coefficients on every tick of the filter.
+    // As with the SVF, a block over which the cutoff, Q and gain hold constant
+    // computes its coefficients once, or not at all if nothing changed.
     template <typename FloatType>
     struct StateVariableShelfFilterNode : public GraphNode<FloatType> {
         using GraphNode<FloatType>::GraphNode;
@@ -43,6 +47,17 @@ namespace elem
             return GraphNode<FloatType>::setProperty(key, val);
         }
 
+        void prepare(double sr, size_t bs) override
+        {
+            GraphNode<FloatType>::prepare(sr, bs);
+
+            // The cached coefficients were warped for the old rate. Any of these failing
+            // to compare equal recomputes them, mode included, on the next block.
+            _lastFc = std::numeric_limits<double>::quiet_NaN();
+            _lastQ = std::numeric_limits<double>::quiet_NaN();
+            _lastGain = std::numeric_limits<double>::quiet_NaN();
+        }
+
         inline FloatType tick (Mode m, FloatType v0) {
             double v3 = v0 - _ic2eq;
             double v1 = _ic1eq * _a1 + v3 * _a2;
@@ -66,20 +81,29 @@ namespace elem
         inline void updateCoeffs (Mode m, double fc, double q, double gainDecibels) {
             auto const sr = GraphNode<FloatType>::getSampleRate();
 
-            _A = std::pow(10, gainDecibels / 40.0);
-            _g = std::tan(3.14159265359 * std::clamp(fc, 20.0, sr / 2.0001)  / sr);
+            if (gainDecibels != _lastGain) {
+                _A = std::pow(10, gainDecibels / 40.0);
+                _lastGain = gainDecibels;
+            }
+
+            double gn = 0, gd = 1;
+            prewarpTan(3.14159265359 * std::clamp(fc, 20.0, sr / 2.0001)  / sr, gn, gd);
+
             _k = 1.0 / std::clamp(q, 0.25, 20.0);
 
             if (m == Mode::Lowshelf)
-                _g /= _A;
+                gd *= _A;
             if (m == Mode::Highshelf)
-                _g *= _A;
+                gn *= _A;
             if (m == Mode::Bell)
                 _k /= _A;
 
-            _a1 = 1.0 / (1.0 + _g * (_g + _k));
-            _a2 = _g * _a1;
-            _a3 = _g * _a2;
+            // As in the SVF, with g = gn / gd the three coefficients share one division
+            auto const d = 1.0 / (gd * gd + gn * (gn + _k * gd));
+
+            _a1 = gd * gd * d;
+            _a2 = gn * gd * d;
+            _a3 = gn * gn * d;
         }
 
         void process (BlockContext<FloatType> const& ctx) override {
@@ -91,9 +115,28 @@ namespace elem
             auto m = _mode.load();
 
             // If we don't have the inputs we need, bail here and zero the buffer
-            if (numChannels < 4)
+            if (numChannels < 4 || numSamples == 0)
                 return (void) std::fill_n(outputData, numSamples, FloatType(0));
 
+            if (util::is_constant(inputData[0], numSamples) && util::is_constant(inputData[1], numSamples) && util::is_constant(inputData[2], numSamples)) {
+                auto const fc = inputData[0][0];
+                auto const q = inputData[1][0];
+                auto const gain = inputData[2][0];
+
+                if (m != _lastMode || fc != _lastFc || q != _lastQ || gain != _lastGain) {
+                    updateCoeffs(m, fc, q, gain);
+                    _lastMode = m;
+                    _lastFc = fc;
+                    _lastQ = q;
+                }
+
+                for (size_t i = 0; i < numSamples; ++i) {
+                    outputData[i] = tick(m, inputData[3][i]);
+                }
+
+                return;
+            }
+
             for (size_t i = 0; i < numSamples; ++i) {
                 auto fc = inputData[0][i];
                 auto q = inputData[1][i];
@@ -106,6 +149,10 @@ namespace elem
                 // Tick the filter
                 outputData[i] = tick(m, xn);
             }
+
+            _lastMode = m;
+            _lastFc = inputData[0][numSamples - 1];
+            _lastQ = inputData[1][numSamples - 1];
         }
 
         // Props
@@ -114,12 +161,18 @@ namespace elem
 
         // Coefficients
         double _A = 0;
-        double _g = 0;
         double _k = 0;
         double _a1 = 0;
         double _a2 = 0;
         double _a3 = 0;
 
+        // The inputs the current coefficients were computed from. NaN never compares
+        // equal, which forces the first computation.
+        Mode _lastMode = Mode::Lowshelf;
+        double _lastFc = std::numeric_limits<double>::quiet_NaN();
+        double _lastQ = std::numeric_limits<double>::quiet_NaN();
+        double _lastGain = std::numeric_limits<double>::quiet_NaN();
+
         // State
         double _ic1eq = 0;
         double _ic2eq = 0;
@@ -13,6 +13,20 @@ namespace elem
                 output[i] = static_cast<ToType>(input[i]);
             }
         }
+
+        // Returns true if every sample in the buffer equals the first. Deliberately
+        // without an early exit so that the loop vectorizes.
+        template <typename FloatType>
+        bool is_constant(FloatType const* input, size_t numSamples)
+        {
+            bool result = true;
+
+            for (size_t i = 1; i < numSamples; ++i) {
+                result &= (input[i] == input[0]);
+            }
+
+            return result;
+        }
     }
 
 }
@@ -0,0 +1,239 @@
+#pragma once
+
+#include <cmath>
+#include <complex>
+#include <cstddef>
+#include <vector>
+
+
+namespace elem
+{
+
+    // An iterative radix-2 complex FFT for power of two sizes.
+    //
+    // Twiddle factors and the bit reversal permutation are computed once at construction,
+    // so that repeated transforms of the same size do no allocation and no trigonometry.
+    // The forward transform is unscaled; the inverse transform applies the 1/N scaling so
+    // that inverse(forward(x)) == x.
+    template <typename FloatType>
+    class ComplexFFT
+    {
+    public:
+        using Complex = std::complex<FloatType>;
+
+        ComplexFFT() = default;
+
+        explicit ComplexFFT(size_t _size)
+        {
+            resize(_size);
+        }
+
+        // Prepares the twiddle and permutation tables for the given size, which must be a
+        // power of two
+        void resize(size_t _size)
+        {
+            size = _size;
+            numBits = 0;
+
+            while ((size_t(1) << numBits) < size)
+                numBits++;
+
+            auto const pi = 3.141592653589793238;
+
+            twiddles.resize(size / 2);
+
+            for (size_t i = 0; i < size / 2; ++i) {
+                auto const phase = -2.0 * pi * static_cast<double>(i) / static_cast<double>(size);
+                twiddles[i] = Complex(FloatType(std::cos(phase)), FloatType(std::sin(phase)));
+            }
+
+            bitReversed.resize(size);
+
+            for (size_t i = 0; i < size; ++i) {
+                size_t r = 0;
+
+                for (size_t b = 0; b < numBits; ++b) {
+                    if (i & (size_t(1) << b))
+                        r |= size_t(1) << (numBits - 1 - b);
+                }
+
+                bitReversed[i] = r;
+            }
+        }
+
+        size_t getSize() const { return size; }
+
+        void forward(Complex* data) const
+        {
+            transform(data, false);
+        }
+
+        void inverse(Complex* data) const
+        {
+            transform(data, true);
+
+            auto const scale = FloatType(1) / FloatType(size);
+
+            for (size_t i = 0; i < size; ++i) {
+                data[i] *= scale;
+            }
+        }
+
+    private:
+        void transform(Complex* data, bool conjugateTwiddles) const
+        {
+            for (size_t i = 0; i < size; ++i) {
+                auto const j = bitReversed[i];
+
+                if (i < j)
+                    std::swap(data[i], data[j]);
+            }
+
+            for (size_t span = 2; span <= size; span <<= 1) {
+                auto const half = span / 2;
+                auto const stride = size / span;
+
+                for (size_t start = 0; start < size; start += span) {
+                    for (size_t k = 0; k < half; ++k) {
+                        auto w = twiddles[k * stride];
+
+                        if (conjugateTwiddles)
+                            w = std::conj(w);
+
+                        // Spelled out rather than using std::complex's operator*, which
+                        // carries extra inf/nan handling we don't need here
+                        auto const a = data[start + k];
+                        auto const x = data[start + k + half];
+                        auto const b = Complex(x.real() * w.real() - x.imag() * w.imag(), x.real() * w.imag() + x.imag() * w.real());
+
+                        data[start + k] = a + b;
+                        data[start + k + half] = a - b;
+                    }
+                }
+            }
+        }
+
+        size_t size = 0;
+        size_t numBits = 0;
+
+        std::vector<Complex> twiddles;
+        std::vector<size_t> bitReversed;
+    };
+
+    // A real-input FFT for power of two sizes of at least 4, computed as a complex FFT of
+    // half the size over the even and odd samples packed into one complex sequence.
+    //
+    // The spectrum is held in split form: N/2 real parts and N/2 imaginary parts, with the
+    // purely real Nyquist bin packed into the imaginary part of the (also purely real) DC
+    // bin. That gives every spectrum a whole power of two number of bins, which suits
+    // lane-wise spectral arithmetic. As with ComplexFFT, the forward transform is unscaled
+    // and the inverse transform applies the 1/N scaling.
+    //
+    // The transforms use internal scratch space, so one instance must not be shared
+    // between threads.
+    template <typename FloatType>
+    class RealFFT
+    {
+    public:
+        using Complex = std::complex<FloatType>;
+
+        RealFFT() = default;
+
+        explicit RealFFT(size_t _size)
+        {
+            resize(_size);
+        }
+
+        void resize(size_t _size)
+        {
+            size = _size;
+
+            auto const half = size / 2;
+            auto const pi = 3.141592653589793238;
+
+            fft.resize(half);
+            scratch.resize(half);
+            twiddles.resize(half);
+
+            for (size_t k = 0; k < half; ++k) {
+                auto const phase = -2.0 * pi * static_cast<double>(k) / static_cast<double>(size);
+                twiddles[k] = Complex(FloatType(std::cos(phase)), FloatType(std::sin(phase)));
+            }
+        }
+
+        size_t getSize() const { return size; }
+
+        // Transforms `size` real samples into size / 2 packed bins
+        void forward(FloatType const* input, FloatType* re, FloatType* im)
+        {
+            auto const half = size / 2;
+            auto* z = scratch.data();
+
+            for (size_t m = 0; m < half; ++m) {
+                z[m] = Complex(input[2 * m], input[2 * m + 1]);
+            }
+
+            fft.forward(z);
+
+            // With E and O the spectra of the even and odd samples,
+            //
+            //   E[k] = (Z[k] + conj(Z[M - k])) / 2
+            //   O[k] = (Z[k] - conj(Z[M - k])) / 2i
+            //   X[k] = E[k] + W^k O[k]
+            //
+            // where M = N / 2, W = e^(-2 pi i / N) and Z[M] = Z[0].
+            re[0] = z[0].real() + z[0].imag();
+            im[0] = z[0].real() - z[0].imag();
+
+            for (size_t k = 1; k < half; ++k) {
+                auto const a = z[k];
+                auto const b = std::conj(z[half - k]);
+
+                auto const e = (a + b) * FloatType(0.5);
+                auto const d = (a - b) * FloatType(0.5);
+                auto const o = Complex(d.imag(), -d.real());
+                auto const w = twiddles[k];
+
+                re[k] = e.real() + w.real() * o.real() - w.imag() * o.imag();
+                im[k] = e.imag() + w.real() * o.imag() + w.imag() * o.real();
+            }
+        }
+
+        // Transforms size / 2 packed bins back into `size` real samples
+        void inverse(FloatType const* re, FloatType const* im, FloatType* output)
+        {
+            auto const half = size / 2;
+            auto* z = scratch.data();
+
+            // The forward relations undone, with Z[k] = E[k] + i O[k]
+            z[0] = Complex(FloatType(0.5) * (re[0] + im[0]), FloatType(0.5) * (re[0] - im[0]));
+
+            for (size_t k = 1; k < half; ++k) {
+                auto const a = Complex(re[k], im[k]);
+                auto const b = Complex(re[half - k], -im[half - k]);
+
+                auto const e = (a + b) * FloatType(0.5);
+                auto const d = (a - b) * FloatType(0.5);
+                auto const w = twiddles[k];
+                auto const o = Complex(d.real() * w.real() + d.imag() * w.imag(), d.imag() * w.real() - d.real() * w.imag());
+
+                z[k] = Complex(e.real() - o.imag(), e.imag() + o.real());
+            }
+
+            fft.inverse(z);
+
+            for (size_t m = 0; m < half; ++m) {
+                output[2 * m] = z[m].real();
+                output[2 * m + 1] = z[m].imag();
+            }
+        }
+
+    private:
+        size_t size = 0;
+
+        ComplexFFT<FloatType> fft;
+        std::vector<Complex> scratch;
+        std::vector<Complex> twiddles;
+    };
+
+} // namespace elem
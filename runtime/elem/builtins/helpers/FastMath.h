@@ -0,0 +1,281 @@
+#pragma once
+
+#include <limits>
+#include <type_traits>
+
+#include "SIMD.h"
+
+
+namespace elem
+{
+namespace simd
+{
+
+    //==============================================================================
+    // Polynomial approximations of common transcendental functions over Vec<T>.
+    //
+    // These are branch-free so that every lane follows the same instruction stream, and
+    // use enough terms to land within a few ulps of libm over the ranges that matter
+    // for audio: about 1e-7 relative error in float and 1e-15 in double. They make no
+    // attempt at libm's handling of denormals, infinities or NaNs, and the trigonometric
+    // functions lose accuracy for very large arguments (beyond about 1e5 in float), where
+    // a single precision argument is already too coarse to carry a phase anyway. Their
+    // results stay within [-1, 1] there all the same.
+    namespace detail
+    {
+        // Evaluates c[0] + c[1] x + ... + c[n - 1] x^(n - 1) by Horner's method
+        template <typename T>
+        inline Vec<T> horner(Vec<T> x, T const* c, size_t n)
+        {
+            auto acc = Vec<T>::broadcast(c[n - 1]);
+
+            for (size_t i = n - 1; i > 0; --i) {
+                acc = acc * x + Vec<T>::broadcast(c[i - 1]);
+            }
+
+            return acc;
+        }
+
+        template <typename T, size_t N>
+        inline Vec<T> horner(Vec<T> x, T const (&c)[N])
+        {
+            return horner(x, c, N);
+        }
+
+        // Lane-wise test for q == k, for the small integral quadrant values below
+        template <typename T>
+        inline Vec<T> equals(Vec<T> q, T k)
+        {
+            return abs(q - Vec<T>::broadcast(k)) < Vec<T>::broadcast(T(0.5));
+        }
+
+        // Taylor coefficients of e^x about 0, carried to the order each precision needs
+        // for |x| <= ln(2)/2
+        template <typename T> struct ExpCoefficients;
+
+        template <> struct ExpCoefficients<float> {
+            static constexpr float c[] = { 1.0f, 1.0f, 1.0f / 2.0f, 1.0f / 6.0f, 1.0f / 24.0f, 1.0f / 120.0f, 1.0f / 720.0f, 1.0f / 5040.0f };
+        };
+
+        template <> struct ExpCoefficients<double> {
+            static constexpr double c[] = {
+                1.0, 1.0, 1.0 / 2.0, 1.0 / 6.0, 1.0 / 24.0, 1.0 / 120.0, 1.0 / 720.0, 1.0 / 5040.0,
+                1.0 / 40320.0, 1.0 / 362880.0, 1.0 / 3628800.0, 1.0 / 39916800.0, 1.0 / 479001600.0,
+            };
+        };
+
+        // Coefficients of the series log(m) = 2 (s + s^3/3 + s^5/5 + ...), s = (m - 1)/(m + 1),
+        // expressed as a polynomial in s^2
+        template <typename T> struct LogCoefficients;
+
+        template <> struct LogCoefficients<float> {
+            static constexpr float c[] = { 2.0f, 2.0f / 3.0f, 2.0f / 5.0f, 2.0f / 7.0f, 2.0f / 9.0f };
+        };
+
+        template <> struct LogCoefficients<double> {
+            static constexpr double c[] = {
+                2.0, 2.0 / 3.0, 2.0 / 5.0, 2.0 / 7.0, 2.0 / 9.0, 2.0 / 11.0, 2.0 / 13.0, 2.0 / 15.0,
+                2.0 / 17.0, 2.0 / 19.0, 2.0 / 21.0,
+            };
+        };
+
+        // Taylor coefficients of sin(x)/x and cos(x) in x^2, for |x| <= pi/4
+        template <typename T> struct TrigCoefficients;
+
+        template <> struct TrigCoefficients<float> {
+            static constexpr float sin[] = { 1.0f, -1.0f / 6.0f, 1.0f / 120.0f, -1.0f / 5040.0f, 1.0f / 362880.0f };
+            static constexpr float cos[] = { 1.0f, -1.0f / 2.0f, 1.0f / 24.0f, -1.0f / 720.0f, 1.0f / 40320.0f, -1.0f / 3628800.0f };
+        };
+
+        template <> struct TrigCoefficients<double> {
+            static constexpr double sin[] = {
+                1.0, -1.0 / 6.0, 1.0 / 120.0, -1.0 / 5040.0, 1.0 / 362880.0, -1.0 / 39916800.0,
+                1.0 / 6227020800.0, -1.0 / 1307674368000.0, 1.0 / 355687428096000.0,
+            };
+
+            static constexpr double cos[] = {
+                1.0, -1.0 / 2.0, 1.0 / 24.0, -1.0 / 720.0, 1.0 / 40320.0, -1.0 / 3628800.0,
+                1.0 / 479001600.0, -1.0 / 87178291200.0, 1.0 / 20922789888000.0, -1.0 / 6402373705728000.0,
+            };
+        };
+
+        // Reduces x to r in [-pi/4, pi/4] with x = r + q * pi/2, returning r and writing the
+        // quadrant q (mod 4, in [0, 4)) to `quadrant`
+        template <typename T>
+        inline Vec<T> reduceQuarterPi(Vec<T> x, Vec<T>& quadrant)
+        {
+            using V = Vec<T>;
+
+            // pi/2 split into three parts so that k * part is exact for moderate k
+            auto const k = floor(x * V::broadcast(T(0.63661977236758134308)) + V::broadcast(T(0.5)));
+            auto r = x - k * V::broadcast(T(1.5703125));
+            r = r - k * V::broadcast(T(4.837512969970703125e-4));
+            r = r - k * V::broadcast(T(7.549789948768648e-8));
+
+            quadrant = k - V::broadcast(T(4)) * floor(k * V::broadcast(T(0.25)));
+
+            // Past the range where k * part is exact, r is only approximately reduced, and
+            // keeping it near [-pi/4, pi/4] keeps the results bounded like libm's
+            auto const bound = V::broadcast(T(0.786));
+            return max(min(r, bound), V::broadcast(T(0)) - bound);
+        }
+
+        template <typename T>
+        inline void sinCosReduced(Vec<T> r, Vec<T>& s, Vec<T>& c)
+        {
+            auto const r2 = r * r;
+
+            s = r * horner(r2, TrigCoefficients<T>::sin);
+            c = horner(r2, TrigCoefficients<T>::cos);
+        }
+    }
+
+    //==============================================================================
+    template <typename T>
+    inline Vec<T> exp(Vec<T> x)
+    {
+        using V = Vec<T>;
+
+        // Clamp to the range where the result is a normal number
+        auto const limit = std::is_same_v<T, float> ? T(87.0) : T(708.0);
+        x = max(min(x, V::broadcast(limit)), V::broadcast(-limit));
+
+        // x = n ln2 + r, with |r| <= ln2/2 and ln2 split into exact high and low parts
+        auto const n = floor(x * V::broadcast(T(1.4426950408889634074)) + V::broadcast(T(0.5)));
+        auto r = x - n * V::broadcast(T(0.693145751953125));
+        r = r - n * V::broadcast(T(1.428606820309417232e-6));
+
+        return detail::horner(r, detail::ExpCoefficients<T>::c) * exp2i(n);
+    }
+
+    // e^x - 1, accurate near zero where exp(x) - 1 would cancel
+    template <typename T>
+    inline Vec<T> expm1(Vec<T> x)
+    {
+        using V = Vec<T>;
+
+        // For small arguments use the series without its constant term
+        auto constexpr n = std::extent_v<decltype(detail::ExpCoefficients<T>::c)>;
+        auto const small = x * detail::horner(x, detail::ExpCoefficients<T>::c + 1, n - 1);
+        auto const large = exp(x) - V::broadcast(T(1));
+
+        return select(abs(x) < V::broadcast(T(0.34657359027997265471)), small, large);
+    }
+
+    template <typename T>
+    inline Vec<T> log(Vec<T> x)
+    {
+        using V = Vec<T>;
+
+        // x = m 2^e, then fold m from [1, 2) into [sqrt(1/2), sqrt(2)) to keep s small
+        V e = V::broadcast(T(0));
+        auto m = splitExponent(x, e);
+
+        auto const fold = m > V::broadcast(T(1.41421356237309504880));
+        m = select(fold, m * V::broadcast(T(0.5)), m);
+        e = select(fold, e + V::broadcast(T(1)), e);
+
+        auto const s = (m - V::broadcast(T(1))) / (m + V::broadcast(T(1)));
+        auto const logm = s * detail::horner(s * s, detail::LogCoefficients<T>::c);
+        auto const result = e * V::broadcast(T(0.69314718055994530942)) + logm;
+
+        // Match libm at the edges of the domain: -inf at zero, NaN below
+        auto const zero = V::broadcast(T(0));
+        auto const nan = V::broadcast(std::numeric_limits<T>::quiet_NaN());
+        auto const negInf = V::broadcast(-std::numeric_limits<T>::infinity());
+
+        return select(x > zero, result, select(x < zero, nan, negInf));
+    }
+
+    template <typename T>
+    inline Vec<T> log2(Vec<T> x)
+    {
+        return log(x) * Vec<T>::broadcast(T(1.44269504088896340736));
+    }
+
+    template <typename T>
+    inline Vec<T> log10(Vec<T> x)
+    {
+        return log(x) * Vec<T>::broadcast(T(0.43429448190325182765));
+    }
+
+    template <typename T>
+    inline Vec<T> sin(Vec<T> x)
+    {
+        using V = Vec<T>;
+
+        V q = V::broadcast(T(0));
+        auto const r = detail::reduceQuarterPi(x, q);
+
+        V s = r, c = r;
+        detail::sinCosReduced(r, s, c);
+
+        // By quadrant: sin(r), cos(r), -sin(r), -cos(r)
+        auto const base = select(detail::equals(q, T(1)), c, select(detail::equals(q, T(3)), c, s));
+        return select(q > V::broadcast(T(1.5)), V::broadcast(T(0)) - base, base);
+    }
+
+    template <typename T>
+    inline Vec<T> cos(Vec<T> x)
+    {
+        using V = Vec<T>;
+
+        V q = V::broadcast(T(0));
+        auto const r = detail::reduceQuarterPi(x, q);
+
+        V s = r, c = r;
+        detail::sinCosReduced(r, s, c);
+
+        // By quadrant: cos(r), -sin(r), -cos(r), sin(r)
+        auto const base = select(detail::equals(q, T(1)), s, select(detail::equals(q, T(3)), s, c));
+        auto const negate = select(q > V::broadcast(T(0.5)), q < V::broadcast(T(2.5)), V::broadcast(T(0)));
+
+        return select(negate, V::broadcast(T(0)) - base, base);
+    }
+
+    template <typename T>
+    inline Vec<T> tan(Vec<T> x)
+    {
+        using V = Vec<T>;
+
+        V q = V::broadcast(T(0));
+        auto const r = detail::reduceQuarterPi(x, q);
+
+        V s = r, c = r;
+        detail::sinCosReduced(r, s, c);
+
+        // tan has period pi, so only the parity of the quadrant matters, and in odd
+        // quadrants tan(r + pi/2) = -cos(r)/sin(r)
+        auto const odd = select(detail::equals(q, T(1)), detail::equals(q, T(1)), detail::equals(q, T(3)));
+        return select(odd, (V::broadcast(T(0)) - c) / s, s / c);
+    }
+
+    template <typename T>
+    inline Vec<T> tanh(Vec<T> x)
+    {
+        using V = Vec<T>;
+
+        // tanh(|x|) = em / (em + 2) with em = expm1(2|x|), which stays accurate near zero.
+        // Beyond the clamp the result is 1 to working precision.
+        auto const limit = std::is_same_v<T, float> ? T(9.0) : T(19.0);
+        auto const ax = min(abs(x), V::broadcast(limit));
+        auto const em = expm1(ax + ax);
+        auto const y = em / (em + V::broadcast(T(2)));
+
+        return select(x < V::broadcast(T(0)), V::broadcast(T(0)) - y, y);
+    }
+
+    //==============================================================================
+    // Function objects over the kernels above, for passing to `transform` or as template
+    // arguments
+    struct Sin   { template <typename T> Vec<T> operator()(Vec<T> x) const { return sin(x); } };
+    struct Cos   { template <typename T> Vec<T> operator()(Vec<T> x) const { return cos(x); } };
+    struct Tan   { template <typename T> Vec<T> operator()(Vec<T> x) const { return tan(x); } };
+    struct Tanh  { template <typename T> Vec<T> operator()(Vec<T> x) const { return tanh(x); } };
+    struct Exp   { template <typename T> Vec<T> operator()(Vec<T> x) const { return exp(x); } };
+    struct Log   { template <typename T> Vec<T> operator()(Vec<T> x) const { return log(x); } };
+    struct Log2  { template <typename T> Vec<T> operator()(Vec<T> x) const { return log2(x); } };
+    struct Log10 { template <typename T> Vec<T> operator()(Vec<T> x) const { return log10(x); } };
+
+} // namespace simd
+} // namespace elem
@@ -14,4 +14,35 @@ namespace elem
         return std::abs(x - y) <= FloatType(1e-6);
     }
 
+    // tan(x) for x in [0, pi/2), the range of the bilinear transform's frequency prewarp
+    // tan(pi * fc / sr), as a ratio numerator / denominator. Agrees with std::tan to within
+    // a few ulps across that range at a fraction of the cost, and leaving the division to
+    // the caller lets filters fold it into the one they already do for their coefficients.
+    //
+    // Above pi/4 we use tan(x) = cos(r) / sin(r) with r = pi/2 - x so that the sin and
+    // cos series below only ever see |r| <= pi/4.
+    inline void prewarpTan (double x, double& numerator, double& denominator) {
+        constexpr double halfPiHi = 1.5707963267948966;
+        constexpr double halfPiLo = 6.123233995736766e-17;
+
+        bool const reflect = x > 0.78539816339744831;
+        double const r = reflect ? (halfPiHi - x) + halfPiLo : x;
+        double const r2 = r * r;
+
+        double const s = r * (1.0 + r2 * (-1.0 / 6.0 + r2 * (1.0 / 120.0 + r2 * (-1.0 / 5040.0 + r2 * (1.0 / 362880.0
+            + r2 * (-1.0 / 39916800.0 + r2 * (1.0 / 6227020800.0 + r2 * (-1.0 / 1307674368000.0))))))));
+
+        double const c = 1.0 + r2 * (-1.0 / 2.0 + r2 * (1.0 / 24.0 + r2 * (-1.0 / 720.0 + r2 * (1.0 / 40320.0
+            + r2 * (-1.0 / 3628800.0 + r2 * (1.0 / 479001600.0 + r2 * (-1.0 / 87178291200.0 + r2 * (1.0 / 20922789888000.0))))))));
+
+        numerator = reflect ? c : s;
+        denominator = reflect ? s : c;
+    }
+
+    inline double prewarpTan (double x) {
+        double n = 0, d = 1;
+        prewarpTan(x, n, d);
+        return n / d;
+    }
+
 } // namespace elem
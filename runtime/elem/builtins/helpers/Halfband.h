@@ -0,0 +1,196 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+
+namespace elem
+{
+
+    namespace detail
+    {
+        // Designs a Kaiser windowed halfband lowpass of 4 * numTaps - 1 taps, centered on
+        // tap 2 * numTaps - 1. Every other tap of a halfband filter is zero, save for the
+        // center tap of 1/2, so we only return the 2 * numTaps taps at odd distances from
+        // the center. They're scaled by 2, for unity gain at DC when interpolating.
+        inline std::vector<double> designHalfband(size_t numTaps, double beta)
+        {
+            auto const center = static_cast<double>(2 * numTaps - 1);
+            auto const pi = 3.141592653589793238;
+
+            // Zeroth order modified Bessel function of the first kind, via its power series
+            auto const besselI0 = [](double x) {
+                double sum = 1.0;
+                double term = 1.0;
+
+                for (int k = 1; k < 64; ++k) {
+                    term *= (x / (2.0 * k)) * (x / (2.0 * k));
+                    sum += term;
+
+                    if (term < sum * 1e-12)
+                        break;
+                }
+
+                return sum;
+            };
+
+            std::vector<double> taps(2 * numTaps);
+            double sum = 0;
+
+            for (size_t i = 0; i < taps.size(); ++i) {
+                auto const d = static_cast<double>(2 * i) - center;
+                auto const w = d / center;
+                auto const window = besselI0(beta * std::sqrt(1.0 - w * w)) / besselI0(beta);
+
+                taps[i] = std::sin(0.5 * pi * d) / (0.5 * pi * d) * window;
+                sum += taps[i];
+            }
+
+            // The window costs us a little gain, which we put back
+            for (auto& t : taps)
+                t /= sum;
+
+            return taps;
+        }
+    }
+
+    // Doubles the sample rate of a signal with a polyphase halfband filter.
+    //
+    // Of each pair of output samples, one is the input itself, delayed, and the other
+    // is the only one which takes any filtering: a symmetric FIR over the last
+    // 2 * numTaps inputs. The latency is 2 * numTaps - 1 samples at the output rate.
+    template <typename FloatType>
+    class HalfbandUpsampler
+    {
+    public:
+        HalfbandUpsampler(size_t _numTaps, double beta, size_t maxBlockSize)
+            : numTaps(_numTaps)
+            , history(2 * _numTaps - 1)
+        {
+            auto const t = detail::designHalfband(numTaps, beta);
+
+            taps.assign(t.begin(), t.begin() + static_cast<std::ptrdiff_t>(numTaps));
+            buffer.assign(history + maxBlockSize, FloatType(0));
+            sums.assign(maxBlockSize, FloatType(0));
+        }
+
+        // Writes 2 * numSamples samples to the output. The block may be no larger than
+        // the maximum given at construction.
+        void process(FloatType const* input, FloatType* output, size_t numSamples)
+        {
+            auto* x = buffer.data() + history;
+            auto* acc = sums.data();
+
+            std::copy_n(input, numSamples, x);
+            std::fill_n(acc, numSamples, FloatType(0));
+
+            // The taps are symmetric, so we fold the window in half. Running each tap
+            // across the whole block keeps the inner loop free to vectorize.
+            for (size_t i = 0; i < numTaps; ++i) {
+                auto const t = taps[i];
+                auto const* a = x - i;
+                auto const* b = x + i - history;
+
+                for (size_t n = 0; n < numSamples; ++n)
+                    acc[n] += t * (a[n] + b[n]);
+            }
+
+            auto const* delayed = x + 1 - numTaps;
+
+            for (size_t n = 0; n < numSamples; ++n) {
+                output[2 * n] = acc[n];
+                output[2 * n + 1] = delayed[n];
+            }
+
+            std::copy_n(buffer.data() + numSamples, history, buffer.data());
+        }
+
+        void reset()
+        {
+            std::fill(buffer.begin(), buffer.end(), FloatType(0));
+        }
+
+    private:
+        size_t numTaps = 0;
+        size_t history = 0;
+
+        std::vector<FloatType> taps;
+
+        // The last `history` inputs, followed by room for a block
+        std::vector<FloatType> buffer;
+        std::vector<FloatType> sums;
+    };
+
+    // Halves the sample rate of a signal with a polyphase halfband filter, the
+    // counterpart to HalfbandUpsampler.
+    //
+    // The even input samples run through the symmetric FIR, and the odd ones only
+    // through the center tap. The latency is 2 * numTaps - 1 samples at the input rate.
+    template <typename FloatType>
+    class HalfbandDownsampler
+    {
+    public:
+        HalfbandDownsampler(size_t _numTaps, double beta, size_t maxBlockSize)
+            : numTaps(_numTaps)
+            , history(2 * _numTaps - 1)
+        {
+            auto const t = detail::designHalfband(numTaps, beta);
+
+            taps.resize(numTaps);
+
+            for (size_t i = 0; i < numTaps; ++i)
+                taps[i] = FloatType(0.5 * t[i]);
+
+            even.assign(history + maxBlockSize, FloatType(0));
+            odd.assign(numTaps + maxBlockSize, FloatType(0));
+        }
+
+        // Reads 2 * numSamples samples from the input, and writes numSamples to the
+        // output. The output block may be no larger than the maximum given at construction.
+        void process(FloatType const* input, FloatType* output, size_t numSamples)
+        {
+            auto* e = even.data() + history;
+            auto* o = odd.data() + numTaps;
+
+            for (size_t n = 0; n < numSamples; ++n) {
+                e[n] = input[2 * n];
+                o[n] = input[2 * n + 1];
+            }
+
+            auto const* delayed = o - numTaps;
+
+            for (size_t n = 0; n < numSamples; ++n)
+                output[n] = FloatType(0.5) * delayed[n];
+
+            for (size_t i = 0; i < numTaps; ++i) {
+                auto const t = taps[i];
+                auto const* a = e - i;
+                auto const* b = e + i - history;
+
+                for (size_t n = 0; n < numSamples; ++n)
+                    output[n] += t * (a[n] + b[n]);
+            }
+
+            std::copy_n(even.data() + numSamples, history, even.data());
+            std::copy_n(odd.data() + numSamples, numTaps, odd.data());
+        }
+
+        void reset()
+        {
+            std::fill(even.begin(), even.end(), FloatType(0));
+            std::fill(odd.begin(), odd.end(), FloatType(0));
+        }
+
+    private:
+        size_t numTaps = 0;
+        size_t history = 0;
+
+        std::vector<FloatType> taps;
+
+        // The last inputs of either phase, followed by room for a block
+        std::vector<FloatType> even;
+        std::vector<FloatType> odd;
+    };
+
+} // namespace elem
@@ -0,0 +1,298 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <string>
+#include <type_traits>
+
+#include "SIMD.h"
+
+
+namespace elem
+{
+
+    // How sub-sample reads from a buffer are interpolated
+    enum class InterpolationMode {
+        Linear = 0,
+        Hermite = 1,
+        Sinc = 2,
+    };
+
+    // How reads reaching past either end of a buffer resolve: by repeating the sample at
+    // that end, or by wrapping around to the other
+    enum class InterpolationEdge {
+        Clamp = 0,
+        Wrap = 1,
+    };
+
+    // Parses the `interpolation` property shared by the table and sample nodes, returning
+    // false for an unrecognized value
+    inline bool parseInterpolationMode(std::string const& name, InterpolationMode& mode)
+    {
+        if (name == "linear") { mode = InterpolationMode::Linear; return true; }
+        if (name == "hermite") { mode = InterpolationMode::Hermite; return true; }
+        if (name == "sinc") { mode = InterpolationMode::Sinc; return true; }
+
+        return false;
+    }
+
+    namespace detail
+    {
+        // An 8-tap Kaiser windowed sinc kernel, tabulated at kNumPhases fractional offsets
+        // with linear interpolation between adjacent rows. Each row is normalized to unity
+        // gain at DC, and at a fractional offset of zero the kernel reduces to the sample
+        // itself, so whole sample reads come back unchanged as in the other modes.
+        template <typename FloatType>
+        struct SincKernel {
+            static constexpr size_t kNumTaps = 8;
+            static constexpr size_t kNumPhases = 256;
+            static constexpr int64_t kTapsBefore = kNumTaps / 2 - 1;
+
+            // Row p holds the weights for a fractional offset of p / kNumPhases, with an
+            // extra row at the end for the offset of 1 so that every row has a neighbour
+            std::array<FloatType, (kNumPhases + 1) * kNumTaps> weights;
+
+            SincKernel()
+            {
+                constexpr double pi = 3.14159265358979323846;
+                constexpr double beta = 7.0;
+                constexpr double halfWidth = kNumTaps / 2;
+
+                // Zeroth order modified Bessel function of the first kind, by its series
+                auto const bessel0 = [](double x) {
+                    double sum = 1.0, term = 1.0;
+
+                    for (int k = 1; k < 32; ++k) {
+                        term *= (x / (2.0 * k)) * (x / (2.0 * k));
+                        sum += term;
+                    }
+
+                    return sum;
+                };
+
+                for (size_t p = 0; p <= kNumPhases; ++p) {
+                    auto const frac = static_cast<double>(p) / static_cast<double>(kNumPhases);
+                    auto* row = weights.data() + p * kNumTaps;
+
+                    double rowWeights[kNumTaps];
+                    double sum = 0.0;
+
+                    for (size_t k = 0; k < kNumTaps; ++k) {
+                        auto const x = static_cast<double>(k) - static_cast<double>(kTapsBefore) - frac;
+                        // Exact zeros at the whole sample offsets, where sin(pi x) would
+                        // leave rounding error behind
+                        auto const sinc = (x == std::floor(x)) ? (x == 0.0 ? 1.0 : 0.0) : std::sin(pi * x) / (pi * x);
+                        auto const w = x / halfWidth;
+                        auto const window = std::abs(w) < 1.0 ? bessel0(beta * std::sqrt(1.0 - w * w)) / bessel0(beta) : 0.0;
+
+                        rowWeights[k] = sinc * window;
+                        sum += rowWeights[k];
+                    }
+
+                    for (size_t k = 0; k < kNumTaps; ++k)
+                        row[k] = static_cast<FloatType>(rowWeights[k] / sum);
+                }
+            }
+
+            // The table is built on first use, so nodes offering sinc interpolation should
+            // call this from the non-realtime thread when the mode is selected
+            static SincKernel const& get()
+            {
+                static SincKernel const kernel;
+                return kernel;
+            }
+        };
+
+        template <typename SampleType>
+        inline SampleType const& edgeRead(SampleType const* data, int64_t size, int64_t i, InterpolationEdge edge)
+        {
+            if (edge == InterpolationEdge::Wrap) {
+                i %= size;
+                return data[i < 0 ? i + size : i];
+            }
+
+            return data[std::clamp(i, int64_t(0), size - 1)];
+        }
+    }
+
+    // Reads numSamples interpolated values from the buffer into `out`, where output sample
+    // j is read at position index[j] + frac[j], with frac[j] in [0, 1).
+    //
+    // Callers first resolve a whole block of read positions, with whatever looping or
+    // bounds logic they need, and then hand them here in one go. Taps are gathered a chunk
+    // at a time into lane order, taking a direct path without any edge handling whenever
+    // the whole chunk's footprint lies within the buffer, and the interpolation itself then
+    // runs across the chunk in SIMD lanes. Linear mode, where there's too little arithmetic
+    // to be worth staging, reads directly from the buffer whenever it can. It computes
+    // exactly
+    //
+    //   x0 + frac * (x1 - x0)
+    //
+    // per sample, so it is interchangeable with the scalar expression of the same form.
+    template <typename FloatType, typename SampleType>
+    inline void interpolate(InterpolationMode mode, InterpolationEdge edge, SampleType const* data, size_t size,
+                            size_t const* index, FloatType const* frac, FloatType* out, size_t numSamples)
+    {
+        using Vec = simd::Vec<FloatType>;
+        using Sinc = detail::SincKernel<FloatType>;
+
+        constexpr size_t kChunkSize = 64;
+        static_assert(kChunkSize % Vec::size == 0);
+        static_assert(Sinc::kNumTaps % Vec::size == 0);
+
+        if (size == 0)
+            return (void) std::fill_n(out, numSamples, FloatType(0));
+
+        auto const n = static_cast<int64_t>(size);
+
+        // The span of taps around index[j] each mode reads from
+        auto const tapsBefore = mode == InterpolationMode::Sinc ? Sinc::kTapsBefore : (mode == InterpolationMode::Hermite ? 1 : 0);
+        auto const tapsAfter = mode == InterpolationMode::Sinc ? int64_t(Sinc::kNumTaps) - Sinc::kTapsBefore - 1 : (mode == InterpolationMode::Hermite ? 2 : 1);
+
+        if (mode == InterpolationMode::Sinc) {
+            auto const& kernel = Sinc::get();
+
+            for (size_t j = 0; j < numSamples; ++j) {
+                auto const i = static_cast<int64_t>(index[j]);
+
+                // Where the taps lie within a buffer of our own sample type we can load them
+                // straight from it; otherwise we stage them through a small buffer
+                alignas(32) FloatType staged[Sinc::kNumTaps];
+                FloatType const* taps = staged;
+
+                if constexpr (std::is_same_v<SampleType, FloatType>) {
+                    if (i >= tapsBefore && i + tapsAfter < n)
+                        taps = data + (i - tapsBefore);
+                }
+
+                if (taps == staged) {
+                    for (size_t k = 0; k < Sinc::kNumTaps; ++k)
+                        staged[k] = FloatType(detail::edgeRead(data, n, i - tapsBefore + static_cast<int64_t>(k), edge));
+                }
+
+                auto const phase = frac[j] * FloatType(Sinc::kNumPhases);
+                auto const row = std::min(static_cast<size_t>(phase), Sinc::kNumPhases - 1);
+                auto const alpha = Vec::broadcast(phase - FloatType(row));
+
+                auto const* w0 = kernel.weights.data() + row * Sinc::kNumTaps;
+                auto const* w1 = w0 + Sinc::kNumTaps;
+
+                auto acc = Vec::broadcast(FloatType(0));
+
+                for (size_t k = 0; k < Sinc::kNumTaps; k += Vec::size) {
+                    auto const a = Vec::load(w0 + k);
+                    auto const w = a + alpha * (Vec::load(w1 + k) - a);
+
+                    acc = acc + w * Vec::load(taps + k);
+                }
+
+                alignas(32) FloatType lanes[Vec::size];
+                acc.store(lanes);
+
+                FloatType sum = 0;
+
+                for (size_t k = 0; k < Vec::size; ++k)
+                    sum += lanes[k];
+
+                out[j] = sum;
+            }
+
+            return;
+        }
+
+        alignas(32) FloatType t0[kChunkSize], t1[kChunkSize], t2[kChunkSize], t3[kChunkSize];
+        alignas(32) FloatType f[kChunkSize];
+        alignas(32) FloatType y[kChunkSize];
+
+        // For linear mode t0 and t1 hold the samples either side of the read position. For
+        // Hermite mode t0 through t3 hold the samples at offsets -1 through 2.
+        FloatType* taps[4] = { t0, t1, t2, t3 };
+        auto const numTaps = static_cast<size_t>(tapsBefore + tapsAfter + 1);
+
+        for (size_t start = 0; start < numSamples; start += kChunkSize) {
+            auto const count = std::min(kChunkSize, numSamples - start);
+            auto const padded = ((count + Vec::size - 1) / Vec::size) * Vec::size;
+
+            auto const* idx = index + start;
+
+            size_t lo = idx[0], hi = idx[0];
+
+            for (size_t j = 1; j < count; ++j) {
+                lo = std::min(lo, idx[j]);
+                hi = std::max(hi, idx[j]);
+            }
+
+            auto const inBounds = static_cast<int64_t>(lo) >= tapsBefore && static_cast<int64_t>(hi) + tapsAfter < n;
+
+            // Staging the taps buys nothing for the single multiply-add of a linear read,
+            // so where the chunk needs no edge handling we read straight from the buffer
+            if (inBounds && mode == InterpolationMode::Linear) {
+                auto const* fr = frac + start;
+                auto* y0 = out + start;
+
+                for (size_t j = 0; j < count; ++j) {
+                    auto const x0 = FloatType(data[idx[j]]);
+                    auto const x1 = FloatType(data[idx[j] + 1]);
+
+                    y0[j] = x0 + fr[j] * (x1 - x0);
+                }
+
+                continue;
+            }
+
+            if (inBounds) {
+                for (size_t k = 0; k < numTaps; ++k) {
+                    auto const offset = static_cast<int64_t>(k) - tapsBefore;
+
+                    for (size_t j = 0; j < count; ++j)
+                        taps[k][j] = FloatType(data[static_cast<int64_t>(idx[j]) + offset]);
+                }
+            } else {
+                for (size_t k = 0; k < numTaps; ++k) {
+                    for (size_t j = 0; j < count; ++j)
+                        taps[k][j] = FloatType(detail::edgeRead(data, n, static_cast<int64_t>(idx[j]) + static_cast<int64_t>(k) - tapsBefore, edge));
+                }
+            }
+
+            std::copy_n(frac + start, count, f);
+
+            // Pad the last vector out with silence
+            for (size_t j = count; j < padded; ++j) {
+                t0[j] = t1[j] = t2[j] = t3[j] = f[j] = FloatType(0);
+            }
+
+            if (mode == InterpolationMode::Linear) {
+                for (size_t j = 0; j < padded; j += Vec::size) {
+                    auto const x0 = Vec::load(t0 + j);
+                    (x0 + Vec::load(f + j) * (Vec::load(t1 + j) - x0)).store(y + j);
+                }
+            } else {
+                auto const half = Vec::broadcast(FloatType(0.5));
+                auto const oneAndAHalf = Vec::broadcast(FloatType(1.5));
+                auto const two = Vec::broadcast(FloatType(2));
+                auto const twoAndAHalf = Vec::broadcast(FloatType(2.5));
+
+                // Catmull-Rom flavored cubic Hermite through x0 and x1, with slopes taken
+                // from the neighbouring samples
+                for (size_t j = 0; j < padded; j += Vec::size) {
+                    auto const xm1 = Vec::load(t0 + j);
+                    auto const x0 = Vec::load(t1 + j);
+                    auto const x1 = Vec::load(t2 + j);
+                    auto const x2 = Vec::load(t3 + j);
+                    auto const x = Vec::load(f + j);
+
+                    auto const c1 = half * (x1 - xm1);
+                    auto const c2 = xm1 - twoAndAHalf * x0 + two * x1 - half * x2;
+                    auto const c3 = half * (x2 - xm1) + oneAndAHalf * (x0 - x1);
+
+                    (((c3 * x + c2) * x + c1) * x + x0).store(y + j);
+                }
+            }
+
+            std::copy_n(y, count, out + start);
+        }
+    }
+
+} // namespace elem
@@ -0,0 +1,252 @@
+#pragma once
+
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "../../SharedResource.h"
+#include "FFT.h"
+#include "SIMD.h"
+
+
+namespace elem
+{
+
+    // One segment of an impulse response, split into uniform partitions of blockSize
+    // samples and transformed for convolution against blocks of input.
+    //
+    // Each partition is zero padded to twice the block size before its transform, and the
+    // spectra are stored in RealFFT's packed split layout, partition after partition, so
+    // that partition p's bins start at p * blockSize in both `re` and `im`. Once built it is
+    // read-only.
+    struct ConvolutionPartitions {
+        size_t blockSize = 0;
+        size_t numPartitions = 0;
+
+        std::vector<float> re;
+        std::vector<float> im;
+
+        ConvolutionPartitions(float const* ir, size_t length, size_t _blockSize)
+            : blockSize(_blockSize)
+            , numPartitions((length + _blockSize - 1) / _blockSize)
+        {
+            RealFFT<float> fft(2 * blockSize);
+            std::vector<float> padded(2 * blockSize);
+
+            re.resize(numPartitions * blockSize);
+            im.resize(numPartitions * blockSize);
+
+            for (size_t p = 0; p < numPartitions; ++p) {
+                auto const start = p * blockSize;
+                auto const count = std::min(blockSize, length - start);
+
+                std::fill(padded.begin(), padded.end(), 0.0f);
+                std::copy_n(ir + start, count, padded.begin());
+
+                fft.forward(padded.data(), re.data() + start, im.data() + start);
+            }
+        }
+    };
+
+    // The spectra of an impulse response laid out for a two stage convolver: the first
+    // headLength samples in partitions of headSize, and the rest in partitions of tailSize.
+    //
+    // This is read-only once built, and is cached in the resource map as a resource derived
+    // from the impulse response, keyed by its layout, so that every convolver running the
+    // same impulse response with the same layout shares one copy. It exposes no channel
+    // data of its own.
+    class ConvolutionSpectra : public SharedResource {
+    public:
+        ConvolutionSpectra(float const* ir, size_t length, size_t headSize, size_t tailSize, size_t headLength)
+            : head(ir, std::min(length, headLength), headSize)
+            , tail(ir + std::min(length, headLength), length - std::min(length, headLength), tailSize)
+            , irLength(length)
+        {
+        }
+
+        // Returns a key identifying the given layout among an impulse response's derived
+        // resources
+        static std::string getKey(size_t headSize, size_t tailSize, size_t headLength)
+        {
+            return "convolution:" + std::to_string(headSize) + ":" + std::to_string(tailSize) + ":" + std::to_string(headLength);
+        }
+
+        BufferView<float> getChannelData(size_t) override
+        {
+            return BufferView<float>(nullptr, 0);
+        }
+
+        size_t numChannels() override {
+            return 0;
+        }
+
+        size_t numSamples() override {
+            return irLength;
+        }
+
+        ConvolutionPartitions const head;
+        ConvolutionPartitions const tail;
+
+    private:
+        size_t irLength = 0;
+    };
+
+    // A uniformly partitioned overlap-save convolver with no added latency.
+    //
+    // Input blocks of blockSize samples are transformed together with the block before them
+    // and kept, as spectra, in a frequency-domain delay line of one entry per partition.
+    // Each output block is then the sum of the delay line's entries, each multiplied by its
+    // partition's spectrum, transformed back.
+    //
+    // To avoid the latency of waiting for a whole block of input, `process` accepts any
+    // number of samples: at each call it transforms the current block as far as it has
+    // been filled, and combines that with the contributions of the older entries, which
+    // are summed once when the block begins. That costs a forward and an inverse transform
+    // per call, so calls of at least a block at a time are the most efficient.
+    class PartitionedConvolver
+    {
+    public:
+        using Vec = simd::Vec<float>;
+
+        // Allocates the delay line and scratch space for the given partitions. Must be
+        // called off the realtime thread.
+        void init(std::shared_ptr<ConvolutionPartitions const> _partitions)
+        {
+            partitions = std::move(_partitions);
+
+            auto const blockSize = partitions ? partitions->blockSize : 0;
+            auto const numPartitions = partitions ? partitions->numPartitions : 0;
+
+            fft.resize(2 * blockSize);
+
+            input.assign(2 * blockSize, 0.0f);
+            output.assign(2 * blockSize, 0.0f);
+            delayRe.assign(numPartitions * blockSize, 0.0f);
+            delayIm.assign(numPartitions * blockSize, 0.0f);
+            historyRe.assign(blockSize, 0.0f);
+            historyIm.assign(blockSize, 0.0f);
+            sumRe.assign(blockSize, 0.0f);
+            sumIm.assign(blockSize, 0.0f);
+
+            inputPosition = 0;
+            currentSlot = 0;
+        }
+
+        void process(float const* in, float* out, size_t numSamples)
+        {
+            if (!partitions || partitions->numPartitions == 0)
+                return (void) std::fill_n(out, numSamples, 0.0f);
+
+            auto const blockSize = partitions->blockSize;
+
+            for (size_t done = 0; done < numSamples; /* no increment */) {
+                auto const count = std::min(numSamples - done, blockSize - inputPosition);
+
+                // The first half of the input buffer holds the previous block, the second
+                // half the current one. Samples past the current position are stale, but
+                // can only reach output samples later than the ones we read.
+                std::copy_n(in + done, count, input.data() + blockSize + inputPosition);
+
+                if (inputPosition == 0)
+                    sumHistory();
+
+                auto* slotRe = delayRe.data() + currentSlot * blockSize;
+                auto* slotIm = delayIm.data() + currentSlot * blockSize;
+
+                fft.forward(input.data(), slotRe, slotIm);
+
+                std::copy(historyRe.begin(), historyRe.end(), sumRe.begin());
+                std::copy(historyIm.begin(), historyIm.end(), sumIm.begin());
+
+                multiplyAccumulate(slotRe, slotIm, partitions->re.data(), partitions->im.data());
+
+                fft.inverse(sumRe.data(), sumIm.data(), output.data());
+                std::copy_n(output.data() + blockSize + inputPosition, count, out + done);
+
+                inputPosition += count;
+                done += count;
+
+                if (inputPosition == blockSize) {
+                    std::copy_n(input.data() + blockSize, blockSize, input.data());
+
+                    inputPosition = 0;
+                    currentSlot = (currentSlot + 1) % partitions->numPartitions;
+                }
+            }
+        }
+
+    private:
+        // Sums the contributions of every partition but the first against the delay line
+        // entries of the blocks before the current one
+        void sumHistory()
+        {
+            auto const blockSize = partitions->blockSize;
+            auto const numPartitions = partitions->numPartitions;
+
+            std::fill(sumRe.begin(), sumRe.end(), 0.0f);
+            std::fill(sumIm.begin(), sumIm.end(), 0.0f);
+
+            for (size_t p = 1; p < numPartitions; ++p) {
+                auto const slot = (currentSlot + numPartitions - p) % numPartitions;
+
+                multiplyAccumulate(
+                    delayRe.data() + slot * blockSize,
+                    delayIm.data() + slot * blockSize,
+                    partitions->re.data() + p * blockSize,
+                    partitions->im.data() + p * blockSize
+                );
+            }
+
+            std::copy(sumRe.begin(), sumRe.end(), historyRe.begin());
+            std::copy(sumIm.begin(), sumIm.end(), historyIm.begin());
+        }
+
+        // sum += x * h, bin by bin, over spectra in the packed layout
+        void multiplyAccumulate(float const* xRe, float const* xIm, float const* hRe, float const* hIm)
+        {
+            auto const blockSize = partitions->blockSize;
+
+            // The DC and Nyquist bins packed into bin 0 are each purely real, so bin 0 is
+            // two real products rather than one complex one
+            auto const dc = sumRe[0] + xRe[0] * hRe[0];
+            auto const nyquist = sumIm[0] + xIm[0] * hIm[0];
+
+            auto* re = sumRe.data();
+            auto* im = sumIm.data();
+
+            if (blockSize % Vec::size == 0) {
+                for (size_t k = 0; k < blockSize; k += Vec::size) {
+                    auto const ar = Vec::load(xRe + k);
+                    auto const ai = Vec::load(xIm + k);
+                    auto const br = Vec::load(hRe + k);
+                    auto const bi = Vec::load(hIm + k);
+
+                    (Vec::load(re + k) + ar * br - ai * bi).store(re + k);
+                    (Vec::load(im + k) + ar * bi + ai * br).store(im + k);
+                }
+            } else {
+                for (size_t k = 0; k < blockSize; ++k) {
+                    re[k] += xRe[k] * hRe[k] - xIm[k] * hIm[k];
+                    im[k] += xRe[k] * hIm[k] + xIm[k] * hRe[k];
+                }
+            }
+
+            re[0] = dc;
+            im[0] = nyquist;
+        }
+
+        std::shared_ptr<ConvolutionPartitions const> partitions;
+        RealFFT<float> fft;
+
+        std::vector<float> input;
+        std::vector<float> output;
+        std::vector<float> delayRe, delayIm;
+        std::vector<float> historyRe, historyIm;
+        std::vector<float> sumRe, sumIm;
+
+        size_t inputPosition = 0;
+        size_t currentSlot = 0;
+    };
+
+} // namespace elem
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <cmath>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "../../AudioBufferResource.h"
+#include "../../SharedResource.h"
+#include "Resampler.h"
+
+
+namespace elem
+{
+
+    // Looks up the named resource, substituting a copy converted to the given engine
+    // sample rate if the resource was recorded at a different rate.
+    //
+    // The converted copy is built with a high quality sinc resampler the first time it's
+    // requested and is then cached in the resource map, so every node reading the same
+    // resource at the same engine rate shares one copy. With the rates matched up front,
+    // sample readers can treat a playback rate of 1 as a plain copy rather than
+    // interpolating on every sample.
+    //
+    // The converted copy stores samples in the caller's FloatType, so that double
+    // precision graphs also get a conversion-free read path from it.
+    //
+    // This must be called from the non-realtime thread, typically during setProperty.
+    template <typename FloatType>
+    SharedResourcePtr getRateMatchedResource(SharedResourceMap& resources, std::string const& name, double sampleRate)
+    {
+        auto resource = resources.get(name);
+
+        if (resource == nullptr)
+            return nullptr;
+
+        auto const sourceRate = resource->getSampleRate();
+
+        if (sourceRate <= 0.0 || sampleRate <= 0.0 || std::abs(sourceRate - sampleRate) < 1e-6)
+            return resource;
+
+        auto const key = "rate:" + std::to_string(sampleRate) + (std::is_same_v<FloatType, double> ? ":f64" : ":f32");
+
+        return resources.getDerived(name, key, [=](SharedResourcePtr const& source) -> SharedResourcePtr {
+            SincResampler resampler(sourceRate, sampleRate);
+            std::vector<std::vector<FloatType>> channels(source->numChannels());
+
+            for (size_t i = 0; i < channels.size(); ++i) {
+                visitChannelData<FloatType>(*source, i, [&](auto const& view) {
+                    channels[i].resize(resampler.getOutputLength(view.size()));
+                    resampler.process(view.data(), view.size(), channels[i].data(), channels[i].size());
+                });
+            }
+
+            return std::make_shared<BasicAudioBufferResource<FloatType>>(std::move(channels), sampleRate);
+        });
+    }
+
+    // Returns the ratio of the given engine sample rate to the rate the named resource
+    // was recorded at, or 1 where getRateMatchedResource returns the resource itself.
+    //
+    // Multiplying a position in the resource as recorded by this ratio gives the same
+    // position in the copy that getRateMatchedResource returns.
+    inline double getRateMatchRatio(SharedResourceMap& resources, std::string const& name, double sampleRate)
+    {
+        auto resource = resources.get(name);
+
+        if (resource == nullptr)
+            return 1.0;
+
+        auto const sourceRate = resource->getSampleRate();
+
+        if (sourceRate <= 0.0 || sampleRate <= 0.0 || std::abs(sourceRate - sampleRate) < 1e-6)
+            return 1.0;
+
+        return sampleRate / sourceRate;
+    }
+
+} // namespace elem
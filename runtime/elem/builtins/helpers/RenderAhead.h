@@ -0,0 +1,345 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <system_error>
+#include <vector>
+
+#include "../../BackgroundWorker.h"
+#include "../../SharedResource.h"
+#include "../../SingleWriterSingleReaderQueue.h"
+
+
+namespace elem
+{
+
+    namespace detail
+    {
+        // Renders a sample sequence ahead of the realtime thread, on a worker thread, for
+        // the sampleseq nodes whose time stretching is too heavy to run inline.
+        //
+        // The worker renders chunks of one block's length into a lock-free FIFO, each
+        // stamped with the value of the time input it was rendered for. It can't see the
+        // time input, so it extrapolates it from the time and rate it was last anchored at.
+        // The realtime thread only copies chunks out of the FIFO.
+        //
+        // When the time input stops lining up with the chunks, because the transport jumped,
+        // started or stopped, the realtime thread fades out what it has, drops the rest, and
+        // sends the worker a request to start over from the new time. Every seek starts a new
+        // generation, and chunks left over from an older one are dropped unheard. Changes to
+        // the sequence, the sample, and the stretch and shift properties travel through the
+        // same request channel and apply from the next chunk the worker renders, so they're
+        // heard up to one lookahead later.
+        template <typename FloatType, typename Sequence>
+        class RenderAhead
+        {
+        public:
+            // What the realtime thread wants rendered
+            struct Request {
+                uint64_t generation = 0;
+                double time = 0;
+                double rate = 0;
+                double stretchFactor = 1;
+                double shift = 0;
+                std::shared_ptr<Sequence> seq;
+                SharedResourcePtr buffer;
+            };
+
+            // Time input values within this many samples of the expected value count as
+            // lined up, as with the sample readers
+            static constexpr double kTolerance = 16.0;
+
+            // Must be called off the realtime thread. The lookahead is rounded up to a power
+            // of two number of chunks.
+            RenderAhead(size_t _numChannels, size_t _chunkSize, size_t lookahead)
+                : numChannels(_numChannels)
+                , chunkSize(_chunkSize)
+            {
+                numChunks = 4;
+
+                while (numChunks * chunkSize < lookahead)
+                    numChunks <<= 1;
+
+                storage.assign(numChunks * numChannels * chunkSize, FloatType(0));
+                channelPtrs.resize(numChunks * numChannels);
+                chunks.resize(numChunks);
+
+                for (size_t i = 0; i < channelPtrs.size(); ++i)
+                    channelPtrs[i] = storage.data() + i * chunkSize;
+            }
+
+            // Starts the worker thread, which calls the given job whenever the realtime
+            // thread triggers it. Returns false if the environment has no thread support.
+            // Must be called off the realtime thread.
+            bool startWorker(std::function<void()>&& job)
+            {
+                if (!BackgroundWorker::isSupported())
+                    return false;
+
+                try {
+                    worker = std::make_unique<BackgroundWorker>(std::move(job));
+                } catch (std::system_error const&) {
+                    return false;
+                }
+
+                return true;
+            }
+
+            bool isIdle() const
+            {
+                return worker == nullptr || worker->isIdle();
+            }
+
+            //==============================================================================
+            // Worker side. Renders chunks until the FIFO is full, taking requests between
+            // chunks, through the given renderer's `update`, `seek` and `render` methods.
+            template <typename Renderer>
+            void renderAhead(Renderer& renderer)
+            {
+                while (true) {
+                    Request req;
+
+                    while (requests.pop(req)) {
+                        if (req.generation != generation) {
+                            generation = req.generation;
+                            time = req.time;
+                            rate = req.rate;
+
+                            renderer.update(req.seq, req.buffer);
+                            renderer.seek();
+                        } else {
+                            renderer.update(req.seq, req.buffer);
+                        }
+
+                        stretchFactor = req.stretchFactor;
+                        shift = req.shift;
+                    }
+
+                    auto const w = writeIndex.load(std::memory_order_relaxed);
+
+                    if (generation == 0 || w - readIndex.load(std::memory_order_acquire) >= numChunks)
+                        return;
+
+                    auto const slot = w & (numChunks - 1);
+
+                    chunks[slot].generation = generation;
+                    chunks[slot].time = time;
+
+                    renderer.render(time, stretchFactor, shift, channelPtrs.data() + slot * numChannels, numChannels, chunkSize);
+
+                    time += rate * static_cast<double>(chunkSize);
+                    writeIndex.store(w + 1, std::memory_order_release);
+                }
+            }
+
+            //==============================================================================
+            // Realtime side. Starts over from the next block, dropping anything rendered so
+            // far, as when the worker takes over from inline rendering.
+            void restart()
+            {
+                dropAll();
+                rtRestart = true;
+            }
+
+            // Writes the block starting at time input `t` to the output, given the current
+            // sequence, sample and properties in `current`
+            void process(double t, Request&& current, FloatType** outputData, size_t numOutputChannels, size_t numSamples)
+            {
+                // The rate at which the time input advanced over the last block. A seek throws
+                // off the step which lands on it, so we anchor with the step before.
+                auto const previousStep = rtStep;
+
+                rtStep = rtHasLast ? (t - rtLastTime) / static_cast<double>(rtLastNumSamples) : 0.0;
+                rtLastTime = t;
+                rtLastNumSamples = numSamples;
+                rtHasLast = true;
+
+                auto const changed = current.seq != rtSent.seq
+                    || current.buffer != rtSent.buffer
+                    || current.stretchFactor != rtSent.stretchFactor
+                    || current.shift != rtSent.shift;
+
+                if (changed) {
+                    rtSent.seq = current.seq;
+                    rtSent.buffer = current.buffer;
+                    rtSent.stretchFactor = current.stretchFactor;
+                    rtSent.shift = current.shift;
+                    rtDirty = true;
+                }
+
+                auto const tolerance = kTolerance * std::abs(rtRate) + 1e-9;
+
+                if (rtRestart || rtSent.generation == 0 || std::abs(t - rtNextTime) > tolerance) {
+                    if (rtRestart || rtSent.generation == 0) {
+                        for (size_t j = 0; j < numOutputChannels; ++j)
+                            std::fill_n(outputData[j], numSamples, FloatType(0));
+                    } else {
+                        // Fade out on the audio we had lined up past the old time
+                        read(outputData, numOutputChannels, numSamples, false);
+
+                        for (size_t j = 0; j < numOutputChannels; ++j) {
+                            for (size_t i = 0; i < numSamples; ++i)
+                                outputData[j][i] *= FloatType(1) - FloatType(i + 1) / FloatType(numSamples);
+                        }
+                    }
+
+                    dropAll();
+
+                    // The worker has the length of this block to render the first chunk of
+                    // the next, so we anchor it there
+                    rtRestart = false;
+                    rtRate = previousStep;
+                    rtNextTime = t + rtRate * static_cast<double>(numSamples);
+
+                    rtSent.generation++;
+                    rtSent.time = rtNextTime;
+                    rtSent.rate = rtRate;
+
+                    // If the channel is full we try again from the next block
+                    rtDirty = false;
+                    rtRestart = !requests.push(Request(rtSent));
+                    trigger();
+
+                    return;
+                }
+
+                if (rtDirty && requests.push(Request(rtSent)))
+                    rtDirty = false;
+
+                read(outputData, numOutputChannels, numSamples, true);
+
+                rtNextTime += rtRate * static_cast<double>(numSamples);
+                trigger();
+            }
+
+        private:
+            struct Chunk {
+                uint64_t generation = 0;
+                double time = 0;
+            };
+
+            void trigger()
+            {
+                if (worker == nullptr)
+                    return;
+
+                if (worker->isIdle())
+                    worker->trigger();
+                else
+                    worker->retryWake();
+            }
+
+            // Drops everything in the FIFO. Only the reader moves the read index, so the
+            // realtime thread can do this without coordinating with the worker.
+            void dropAll()
+            {
+                readIndex.store(writeIndex.load(std::memory_order_acquire), std::memory_order_release);
+                rtOffset = 0;
+            }
+
+            // Copies from the FIFO into the output, dropping chunks from before the last seek,
+            // and zeroing whatever the worker hasn't got to yet. When catching up, skips any
+            // audio which the time input has already passed, as when the worker falls behind.
+            void read(FloatType** outputData, size_t numOutputChannels, size_t numSamples, bool catchUp)
+            {
+                size_t i = 0;
+
+                while (i < numSamples) {
+                    auto const r = readIndex.load(std::memory_order_relaxed);
+
+                    if (r == writeIndex.load(std::memory_order_acquire))
+                        break;
+
+                    auto const slot = r & (numChunks - 1);
+                    auto const& chunk = chunks[slot];
+
+                    if (chunk.generation != rtSent.generation) {
+                        readIndex.store(r + 1, std::memory_order_release);
+                        rtOffset = 0;
+                        continue;
+                    }
+
+                    auto count = std::min(numSamples - i, chunkSize - rtOffset);
+
+                    if (catchUp && rtRate > 0.0) {
+                        auto const want = rtNextTime + rtRate * static_cast<double>(i);
+                        auto const have = chunk.time + rtRate * static_cast<double>(rtOffset);
+                        auto const behind = std::llround((want - have) / rtRate);
+
+                        if (behind > 0) {
+                            count = std::min(static_cast<size_t>(behind), chunkSize - rtOffset);
+                            advance(r, count);
+                            continue;
+                        }
+                    }
+
+                    for (size_t j = 0; j < numOutputChannels; ++j) {
+                        if (j < numChannels) {
+                            std::copy_n(channelPtrs[slot * numChannels + j] + rtOffset, count, outputData[j] + i);
+                        } else {
+                            std::fill_n(outputData[j] + i, count, FloatType(0));
+                        }
+                    }
+
+                    advance(r, count);
+                    i += count;
+                }
+
+                for (size_t j = 0; j < numOutputChannels; ++j)
+                    std::fill_n(outputData[j] + i, numSamples - i, FloatType(0));
+            }
+
+            void advance(size_t r, size_t count)
+            {
+                rtOffset += count;
+
+                if (rtOffset == chunkSize) {
+                    readIndex.store(r + 1, std::memory_order_release);
+                    rtOffset = 0;
+                }
+            }
+
+            size_t numChannels = 0;
+            size_t chunkSize = 0;
+            size_t numChunks = 0;
+
+            std::vector<FloatType> storage;
+            std::vector<FloatType*> channelPtrs;
+            std::vector<Chunk> chunks;
+
+            // Free running chunk counts; the FIFO holds the chunks between them
+            std::atomic<size_t> readIndex = 0;
+            std::atomic<size_t> writeIndex = 0;
+
+            SingleWriterSingleReaderQueue<Request> requests;
+
+            // Worker state
+            uint64_t generation = 0;
+            double time = 0;
+            double rate = 0;
+            double stretchFactor = 1;
+            double shift = 0;
+
+            // Realtime state
+            Request rtSent;
+            size_t rtOffset = 0;
+            double rtRate = 0;
+            double rtNextTime = 0;
+            double rtStep = 0;
+            double rtLastTime = 0;
+            size_t rtLastNumSamples = 0;
+            bool rtHasLast = false;
+            bool rtRestart = false;
+            bool rtDirty = false;
+
+            // Declared last so that it's destroyed first, and with it any job in progress
+            // finished, before the state that job works on
+            std::unique_ptr<BackgroundWorker> worker;
+        };
+    }
+
+} // namespace elem
@@ -0,0 +1,123 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+
+namespace elem
+{
+
+    // Band-limited sample rate conversion for whole buffers using a Kaiser windowed
+    // sinc kernel.
+    //
+    // This is an offline converter, intended for preparing resource data on a
+    // non-realtime thread: converting a buffer once up front lets realtime readers
+    // play it back at the engine rate without interpolating on every sample.
+    //
+    // The kernel is tabulated once at construction, oversampled between zero crossings
+    // and linearly interpolated during conversion, so the cost per output sample is
+    // roughly 2 * zeroCrossings multiply-adds (scaled up when downsampling).
+    class SincResampler
+    {
+    public:
+        SincResampler(double sourceRate, double targetRate, int zeroCrossings = 32, double beta = 9.0)
+            : ratio(sourceRate / targetRate)
+            , cutoff(std::min(1.0, targetRate / sourceRate))
+            , numZeroCrossings(zeroCrossings)
+        {
+            auto const tableSize = static_cast<size_t>(numZeroCrossings * kTableResolution) + 2;
+            auto const pi = 3.141592653589793238;
+            auto const i0Beta = besselI0(beta);
+
+            kernel.resize(tableSize);
+
+            for (size_t i = 0; i < tableSize; ++i) {
+                auto const x = static_cast<double>(i) / static_cast<double>(kTableResolution);
+                auto const w = x / static_cast<double>(numZeroCrossings);
+
+                auto const sinc = (x == 0.0) ? 1.0 : std::sin(pi * x) / (pi * x);
+                auto const window = (w >= 1.0) ? 0.0 : besselI0(beta * std::sqrt(1.0 - w * w)) / i0Beta;
+
+                kernel[i] = sinc * window;
+            }
+        }
+
+        // Returns the number of output samples produced for the given input length
+        size_t getOutputLength(size_t numInputSamples) const
+        {
+            return static_cast<size_t>(std::ceil(static_cast<double>(numInputSamples) / ratio));
+        }
+
+        template <typename InputType, typename OutputType>
+        void process(InputType const* input, size_t numInputSamples, OutputType* output, size_t numOutputSamples) const
+        {
+            // When downsampling we widen the kernel by the inverse of the cutoff so that
+            // the filter rejects everything above the new Nyquist frequency
+            auto const halfWidth = static_cast<double>(numZeroCrossings) / cutoff;
+            auto const inputLength = static_cast<int64_t>(numInputSamples);
+
+            for (size_t n = 0; n < numOutputSamples; ++n) {
+                auto const t = static_cast<double>(n) * ratio;
+                auto const first = std::max(int64_t(0), static_cast<int64_t>(std::ceil(t - halfWidth)));
+                auto const last = std::min(inputLength - 1, static_cast<int64_t>(std::floor(t + halfWidth)));
+
+                double acc = 0;
+
+                for (int64_t k = first; k <= last; ++k) {
+                    acc += static_cast<double>(input[k]) * lookup(std::abs(t - static_cast<double>(k)) * cutoff);
+                }
+
+                output[n] = static_cast<OutputType>(acc * cutoff);
+            }
+        }
+
+        template <typename FloatType>
+        std::vector<FloatType> process(std::vector<FloatType> const& input) const
+        {
+            std::vector<FloatType> output(getOutputLength(input.size()));
+            process(input.data(), input.size(), output.data(), output.size());
+            return output;
+        }
+
+    private:
+        double lookup(double x) const
+        {
+            auto const pos = x * static_cast<double>(kTableResolution);
+            auto const index = static_cast<size_t>(pos);
+
+            if (index + 1 >= kernel.size())
+                return 0.0;
+
+            auto const frac = pos - static_cast<double>(index);
+            return kernel[index] + frac * (kernel[index + 1] - kernel[index]);
+        }
+
+        // Zeroth order modified Bessel function of the first kind, via its power series
+        static double besselI0(double x)
+        {
+            double sum = 1.0;
+            double term = 1.0;
+            double const halfX = x / 2.0;
+
+            for (int k = 1; k < 64; ++k) {
+                term *= (halfX / k) * (halfX / k);
+                sum += term;
+
+                if (term < sum * 1e-12)
+                    break;
+            }
+
+            return sum;
+        }
+
+        static constexpr int kTableResolution = 512;
+
+        std::vector<double> kernel;
+        double ratio = 1.0;
+        double cutoff = 1.0;
+        int numZeroCrossings = 32;
+    };
+
+} // namespace elem
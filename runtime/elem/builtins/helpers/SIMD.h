@@ -0,0 +1,415 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+// Pick the widest instruction set we were compiled for. Defining ELEM_SIMD_DISABLE
+// forces the scalar fallback everywhere.
+#if !defined(ELEM_SIMD_DISABLE)
+    #if defined(__AVX2__)
+        #define ELEM_SIMD_AVX2 1
+        #include <immintrin.h>
+    #elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+        #define ELEM_SIMD_SSE2 1
+        #include <emmintrin.h>
+    #elif defined(__ARM_NEON) && defined(__aarch64__)
+        #define ELEM_SIMD_NEON 1
+        #include <arm_neon.h>
+    #endif
+#endif
+
+
+namespace elem
+{
+namespace simd
+{
+
+    //==============================================================================
+    // A small fixed-width vector type over float or double lanes.
+    //
+    // Vec<T> wraps the native register type of the instruction set selected at compile
+    // time (AVX2, SSE2, or NEON on AArch64), falling back to a single scalar lane
+    // elsewhere. Comparisons produce masks of the same type, with every bit of a lane
+    // set where the comparison holds, for use with `select`. `min` and `max` follow
+    // std::min and std::max exactly, including which operand wins for equal or
+    // unordered lanes, so vector and scalar paths agree bit for bit.
+    //
+    // Only the handful of operations needed by our kernels are provided; this is not
+    // meant as a general purpose SIMD library.
+    template <typename T>
+    struct Vec
+    {
+        static constexpr size_t size = 1;
+        T v;
+
+        static Vec load(T const* p) { return {*p}; }
+        static Vec broadcast(T x) { return {x}; }
+        void store(T* p) const { *p = v; }
+    };
+
+    namespace detail
+    {
+        template <typename T> struct Bits;
+        template <> struct Bits<float> { using Type = uint32_t; static constexpr int mantissaBits = 23; static constexpr int bias = 127; };
+        template <> struct Bits<double> { using Type = uint64_t; static constexpr int mantissaBits = 52; static constexpr int bias = 1023; };
+
+        template <typename T>
+        inline T maskFromBool(bool b) {
+            typename Bits<T>::Type bits = b ? ~typename Bits<T>::Type(0) : 0;
+            T x;
+            std::memcpy(&x, &bits, sizeof(T));
+            return x;
+        }
+
+        template <typename T>
+        inline bool boolFromMask(T m) {
+            typename Bits<T>::Type bits;
+            std::memcpy(&bits, &m, sizeof(T));
+            return bits != 0;
+        }
+    }
+
+    // Scalar fallback
+    template <typename T> inline Vec<T> operator+ (Vec<T> a, Vec<T> b) { return {a.v + b.v}; }
+    template <typename T> inline Vec<T> operator- (Vec<T> a, Vec<T> b) { return {a.v - b.v}; }
+    template <typename T> inline Vec<T> operator* (Vec<T> a, Vec<T> b) { return {a.v * b.v}; }
+    template <typename T> inline Vec<T> operator/ (Vec<T> a, Vec<T> b) { return {a.v / b.v}; }
+    template <typename T> inline Vec<T> min (Vec<T> a, Vec<T> b) { return {std::min(a.v, b.v)}; }
+    template <typename T> inline Vec<T> max (Vec<T> a, Vec<T> b) { return {std::max(a.v, b.v)}; }
+    template <typename T> inline Vec<T> abs (Vec<T> a) { return {std::abs(a.v)}; }
+    template <typename T> inline Vec<T> sqrt (Vec<T> a) { return {std::sqrt(a.v)}; }
+    template <typename T> inline Vec<T> floor (Vec<T> a) { return {std::floor(a.v)}; }
+    template <typename T> inline Vec<T> operator< (Vec<T> a, Vec<T> b) { return {detail::maskFromBool<T>(a.v < b.v)}; }
+    template <typename T> inline Vec<T> operator> (Vec<T> a, Vec<T> b) { return {detail::maskFromBool<T>(a.v > b.v)}; }
+    template <typename T> inline Vec<T> select (Vec<T> mask, Vec<T> a, Vec<T> b) { return detail::boolFromMask(mask.v) ? a : b; }
+
+    // Returns 2^n for lanes holding integral values of n within the normal exponent range
+    template <typename T> inline Vec<T> exp2i (Vec<T> n) {
+        using Bits = detail::Bits<T>;
+        auto const bits = static_cast<typename Bits::Type>(static_cast<int64_t>(n.v) + Bits::bias) << Bits::mantissaBits;
+        T x;
+        std::memcpy(&x, &bits, sizeof(T));
+        return {x};
+    }
+
+    // Splits normal, positive lanes into a mantissa in [1, 2), which is returned, and an
+    // unbiased exponent, written to `exponent`
+    template <typename T> inline Vec<T> splitExponent (Vec<T> x, Vec<T>& exponent) {
+        using Bits = detail::Bits<T>;
+        typename Bits::Type bits;
+        std::memcpy(&bits, &x.v, sizeof(T));
+
+        auto const mantissaMask = (typename Bits::Type(1) << Bits::mantissaBits) - 1;
+        auto const e = static_cast<int64_t>(bits >> Bits::mantissaBits) - Bits::bias;
+        auto const m = (bits & mantissaMask) | (static_cast<typename Bits::Type>(Bits::bias) << Bits::mantissaBits);
+
+        exponent.v = static_cast<T>(e);
+
+        T mantissa;
+        std::memcpy(&mantissa, &m, sizeof(T));
+        return {mantissa};
+    }
+
+#if defined(ELEM_SIMD_AVX2)
+    //==============================================================================
+    template <>
+    struct Vec<float>
+    {
+        static constexpr size_t size = 8;
+        __m256 v;
+
+        static Vec load(float const* p) { return {_mm256_loadu_ps(p)}; }
+        static Vec broadcast(float x) { return {_mm256_set1_ps(x)}; }
+        void store(float* p) const { _mm256_storeu_ps(p, v); }
+    };
+
+    inline Vec<float> operator+ (Vec<float> a, Vec<float> b) { return {_mm256_add_ps(a.v, b.v)}; }
+    inline Vec<float> operator- (Vec<float> a, Vec<float> b) { return {_mm256_sub_ps(a.v, b.v)}; }
+    inline Vec<float> operator* (Vec<float> a, Vec<float> b) { return {_mm256_mul_ps(a.v, b.v)}; }
+    inline Vec<float> operator/ (Vec<float> a, Vec<float> b) { return {_mm256_div_ps(a.v, b.v)}; }
+    inline Vec<float> min (Vec<float> a, Vec<float> b) { return {_mm256_min_ps(b.v, a.v)}; }
+    inline Vec<float> max (Vec<float> a, Vec<float> b) { return {_mm256_max_ps(b.v, a.v)}; }
+    inline Vec<float> abs (Vec<float> a) { return {_mm256_andnot_ps(_mm256_set1_ps(-0.0f), a.v)}; }
+    inline Vec<float> sqrt (Vec<float> a) { return {_mm256_sqrt_ps(a.v)}; }
+    inline Vec<float> floor (Vec<float> a) { return {_mm256_floor_ps(a.v)}; }
+    inline Vec<float> operator< (Vec<float> a, Vec<float> b) { return {_mm256_cmp_ps(a.v, b.v, _CMP_LT_OQ)}; }
+    inline Vec<float> operator> (Vec<float> a, Vec<float> b) { return {_mm256_cmp_ps(a.v, b.v, _CMP_GT_OQ)}; }
+    inline Vec<float> select (Vec<float> mask, Vec<float> a, Vec<float> b) { return {_mm256_blendv_ps(b.v, a.v, mask.v)}; }
+
+    inline Vec<float> exp2i (Vec<float> n) {
+        auto const i = _mm256_add_epi32(_mm256_cvttps_epi32(n.v), _mm256_set1_epi32(127));
+        return {_mm256_castsi256_ps(_mm256_slli_epi32(i, 23))};
+    }
+
+    inline Vec<float> splitExponent (Vec<float> x, Vec<float>& exponent) {
+        auto const bits = _mm256_castps_si256(x.v);
+        auto const e = _mm256_sub_epi32(_mm256_srli_epi32(bits, 23), _mm256_set1_epi32(127));
+        auto const m = _mm256_or_si256(_mm256_and_si256(bits, _mm256_set1_epi32(0x007fffff)), _mm256_set1_epi32(0x3f800000));
+
+        exponent.v = _mm256_cvtepi32_ps(e);
+        return {_mm256_castsi256_ps(m)};
+    }
+
+    template <>
+    struct Vec<double>
+    {
+        static constexpr size_t size = 4;
+        __m256d v;
+
+        static Vec load(double const* p) { return {_mm256_loadu_pd(p)}; }
+        static Vec broadcast(double x) { return {_mm256_set1_pd(x)}; }
+        void store(double* p) const { _mm256_storeu_pd(p, v); }
+    };
+
+    inline Vec<double> operator+ (Vec<double> a, Vec<double> b) { return {_mm256_add_pd(a.v, b.v)}; }
+    inline Vec<double> operator- (Vec<double> a, Vec<double> b) { return {_mm256_sub_pd(a.v, b.v)}; }
+    inline Vec<double> operator* (Vec<double> a, Vec<double> b) { return {_mm256_mul_pd(a.v, b.v)}; }
+    inline Vec<double> operator/ (Vec<double> a, Vec<double> b) { return {_mm256_div_pd(a.v, b.v)}; }
+    inline Vec<double> min (Vec<double> a, Vec<double> b) { return {_mm256_min_pd(b.v, a.v)}; }
+    inline Vec<double> max (Vec<double> a, Vec<double> b) { return {_mm256_max_pd(b.v, a.v)}; }
+    inline Vec<double> abs (Vec<double> a) { return {_mm256_andnot_pd(_mm256_set1_pd(-0.0), a.v)}; }
+    inline Vec<double> sqrt (Vec<double> a) { return {_mm256_sqrt_pd(a.v)}; }
+    inline Vec<double> floor (Vec<double> a) { return {_mm256_floor_pd(a.v)}; }
+    inline Vec<double> operator< (Vec<double> a, Vec<double> b) { return {_mm256_cmp_pd(a.v, b.v, _CMP_LT_OQ)}; }
+    inline Vec<double> operator> (Vec<double> a, Vec<double> b) { return {_mm256_cmp_pd(a.v, b.v, _CMP_GT_OQ)}; }
+    inline Vec<double> select (Vec<double> mask, Vec<double> a, Vec<double> b) { return {_mm256_blendv_pd(b.v, a.v, mask.v)}; }
+
+    inline Vec<double> exp2i (Vec<double> n) {
+        auto const i = _mm_add_epi32(_mm256_cvttpd_epi32(n.v), _mm_set1_epi32(1023));
+        return {_mm256_castsi256_pd(_mm256_slli_epi64(_mm256_cvtepi32_epi64(i), 52))};
+    }
+
+    inline Vec<double> splitExponent (Vec<double> x, Vec<double>& exponent) {
+        auto const bits = _mm256_castpd_si256(x.v);
+        auto const e64 = _mm256_and_si256(_mm256_srli_epi64(bits, 52), _mm256_set1_epi64x(0x7ff));
+
+        // Gather the low halves of each 64-bit lane so we can convert from 32-bit ints
+        auto const e32 = _mm256_castsi256_si128(_mm256_permutevar8x32_epi32(e64, _mm256_setr_epi32(0, 2, 4, 6, 0, 2, 4, 6)));
+        auto const m = _mm256_or_si256(_mm256_and_si256(bits, _mm256_set1_epi64x(0x000fffffffffffffLL)), _mm256_set1_epi64x(0x3ff0000000000000LL));
+
+        exponent.v = _mm256_cvtepi32_pd(_mm_sub_epi32(e32, _mm_set1_epi32(1023)));
+        return {_mm256_castsi256_pd(m)};
+    }
+
+#elif defined(ELEM_SIMD_SSE2)
+    //==============================================================================
+    template <>
+    struct Vec<float>
+    {
+        static constexpr size_t size = 4;
+        __m128 v;
+
+        static Vec load(float const* p) { return {_mm_loadu_ps(p)}; }
+        static Vec broadcast(float x) { return {_mm_set1_ps(x)}; }
+        void store(float* p) const { _mm_storeu_ps(p, v); }
+    };
+
+    inline Vec<float> operator+ (Vec<float> a, Vec<float> b) { return {_mm_add_ps(a.v, b.v)}; }
+    inline Vec<float> operator- (Vec<float> a, Vec<float> b) { return {_mm_sub_ps(a.v, b.v)}; }
+    inline Vec<float> operator* (Vec<float> a, Vec<float> b) { return {_mm_mul_ps(a.v, b.v)}; }
+    inline Vec<float> operator/ (Vec<float> a, Vec<float> b) { return {_mm_div_ps(a.v, b.v)}; }
+    inline Vec<float> min (Vec<float> a, Vec<float> b) { return {_mm_min_ps(b.v, a.v)}; }
+    inline Vec<float> max (Vec<float> a, Vec<float> b) { return {_mm_max_ps(b.v, a.v)}; }
+    inline Vec<float> abs (Vec<float> a) { return {_mm_andnot_ps(_mm_set1_ps(-0.0f), a.v)}; }
+    inline Vec<float> sqrt (Vec<float> a) { return {_mm_sqrt_ps(a.v)}; }
+    inline Vec<float> operator< (Vec<float> a, Vec<float> b) { return {_mm_cmplt_ps(a.v, b.v)}; }
+    inline Vec<float> operator> (Vec<float> a, Vec<float> b) { return {_mm_cmpgt_ps(a.v, b.v)}; }
+    inline Vec<float> select (Vec<float> mask, Vec<float> a, Vec<float> b) { return {_mm_or_ps(_mm_and_ps(mask.v, a.v), _mm_andnot_ps(mask.v, b.v))}; }
+
+    // SSE2 has no rounding instructions, so we truncate through the integer unit and
+    // correct the lanes that rounded up. Every float from 2^23 up is already integral,
+    // which covers the lanes beyond the integer unit's reach, so those pass through.
+    inline Vec<float> floor (Vec<float> a) {
+        auto const t = _mm_cvtepi32_ps(_mm_cvttps_epi32(a.v));
+        auto const f = _mm_sub_ps(t, _mm_and_ps(_mm_cmpgt_ps(t, a.v), _mm_set1_ps(1.0f)));
+        auto const small = _mm_cmplt_ps(_mm_andnot_ps(_mm_set1_ps(-0.0f), a.v), _mm_set1_ps(8388608.0f));
+
+        return {_mm_or_ps(_mm_and_ps(small, f), _mm_andnot_ps(small, a.v))};
+    }
+
+    inline Vec<float> exp2i (Vec<float> n) {
+        auto const i = _mm_add_epi32(_mm_cvttps_epi32(n.v), _mm_set1_epi32(127));
+        return {_mm_castsi128_ps(_mm_slli_epi32(i, 23))};
+    }
+
+    inline Vec<float> splitExponent (Vec<float> x, Vec<float>& exponent) {
+        auto const bits = _mm_castps_si128(x.v);
+        auto const e = _mm_sub_epi32(_mm_srli_epi32(bits, 23), _mm_set1_epi32(127));
+        auto const m = _mm_or_si128(_mm_and_si128(bits, _mm_set1_epi32(0x007fffff)), _mm_set1_epi32(0x3f800000));
+
+        exponent.v = _mm_cvtepi32_ps(e);
+        return {_mm_castsi128_ps(m)};
+    }
+
+    template <>
+    struct Vec<double>
+    {
+        static constexpr size_t size = 2;
+        __m128d v;
+
+        static Vec load(double const* p) { return {_mm_loadu_pd(p)}; }
+        static Vec broadcast(double x) { return {_mm_set1_pd(x)}; }
+        void store(double* p) const { _mm_storeu_pd(p, v); }
+    };
+
+    inline Vec<double> operator+ (Vec<double> a, Vec<double> b) { return {_mm_add_pd(a.v, b.v)}; }
+    inline Vec<double> operator- (Vec<double> a, Vec<double> b) { return {_mm_sub_pd(a.v, b.v)}; }
+    inline Vec<double> operator* (Vec<double> a, Vec<double> b) { return {_mm_mul_pd(a.v, b.v)}; }
+    inline Vec<double> operator/ (Vec<double> a, Vec<double> b) { return {_mm_div_pd(a.v, b.v)}; }
+    inline Vec<double> min (Vec<double> a, Vec<double> b) { return {_mm_min_pd(b.v, a.v)}; }
+    inline Vec<double> max (Vec<double> a, Vec<double> b) { return {_mm_max_pd(b.v, a.v)}; }
+    inline Vec<double> abs (Vec<double> a) { return {_mm_andnot_pd(_mm_set1_pd(-0.0), a.v)}; }
+    inline Vec<double> sqrt (Vec<double> a) { return {_mm_sqrt_pd(a.v)}; }
+    inline Vec<double> operator< (Vec<double> a, Vec<double> b) { return {_mm_cmplt_pd(a.v, b.v)}; }
+    inline Vec<double> operator> (Vec<double> a, Vec<double> b) { return {_mm_cmpgt_pd(a.v, b.v)}; }
+    inline Vec<double> select (Vec<double> mask, Vec<double> a, Vec<double> b) { return {_mm_or_pd(_mm_and_pd(mask.v, a.v), _mm_andnot_pd(mask.v, b.v))}; }
+
+    // Doubles between 2^31 and 2^52 are out of the integer unit's reach but not yet
+    // integral, so here we round to nearest by adding and subtracting 2^52 instead, and
+    // correct the lanes that rounded up. Lanes from 2^52 up pass through.
+    inline Vec<double> floor (Vec<double> a) {
+        auto const big = _mm_set1_pd(4503599627370496.0);
+        auto const sign = _mm_and_pd(a.v, _mm_set1_pd(-0.0));
+        auto const mag = _mm_andnot_pd(_mm_set1_pd(-0.0), a.v);
+        auto const t = _mm_or_pd(_mm_sub_pd(_mm_add_pd(mag, big), big), sign);
+        auto const f = _mm_sub_pd(t, _mm_and_pd(_mm_cmpgt_pd(t, a.v), _mm_set1_pd(1.0)));
+        auto const small = _mm_cmplt_pd(mag, big);
+
+        return {_mm_or_pd(_mm_and_pd(small, f), _mm_andnot_pd(small, a.v))};
+    }
+
+    inline Vec<double> exp2i (Vec<double> n) {
+        // Widen the two 32-bit results to 64-bit lanes; the biased exponent is positive
+        // so zero extension is enough
+        auto const i = _mm_add_epi32(_mm_cvttpd_epi32(n.v), _mm_set1_epi32(1023));
+        return {_mm_castsi128_pd(_mm_slli_epi64(_mm_unpacklo_epi32(i, _mm_setzero_si128()), 52))};
+    }
+
+    inline Vec<double> splitExponent (Vec<double> x, Vec<double>& exponent) {
+        auto const bits = _mm_castpd_si128(x.v);
+        auto const e64 = _mm_and_si128(_mm_srli_epi64(bits, 52), _mm_set1_epi64x(0x7ff));
+        auto const e32 = _mm_shuffle_epi32(e64, _MM_SHUFFLE(3, 1, 2, 0));
+        auto const m = _mm_or_si128(_mm_and_si128(bits, _mm_set1_epi64x(0x000fffffffffffffLL)), _mm_set1_epi64x(0x3ff0000000000000LL));
+
+        exponent.v = _mm_cvtepi32_pd(_mm_sub_epi32(e32, _mm_set1_epi32(1023)));
+        return {_mm_castsi128_pd(m)};
+    }
+
+#elif defined(ELEM_SIMD_NEON)
+    //==============================================================================
+    template <>
+    struct Vec<float>
+    {
+        static constexpr size_t size = 4;
+        float32x4_t v;
+
+        static Vec load(float const* p) { return {vld1q_f32(p)}; }
+        static Vec broadcast(float x) { return {vdupq_n_f32(x)}; }
+        void store(float* p) const { vst1q_f32(p, v); }
+    };
+
+    inline Vec<float> operator+ (Vec<float> a, Vec<float> b) { return {vaddq_f32(a.v, b.v)}; }
+    inline Vec<float> operator- (Vec<float> a, Vec<float> b) { return {vsubq_f32(a.v, b.v)}; }
+    inline Vec<float> operator* (Vec<float> a, Vec<float> b) { return {vmulq_f32(a.v, b.v)}; }
+    inline Vec<float> operator/ (Vec<float> a, Vec<float> b) { return {vdivq_f32(a.v, b.v)}; }
+    inline Vec<float> min (Vec<float> a, Vec<float> b) { return {vbslq_f32(vcltq_f32(b.v, a.v), b.v, a.v)}; }
+    inline Vec<float> max (Vec<float> a, Vec<float> b) { return {vbslq_f32(vcltq_f32(a.v, b.v), b.v, a.v)}; }
+    inline Vec<float> abs (Vec<float> a) { return {vabsq_f32(a.v)}; }
+    inline Vec<float> sqrt (Vec<float> a) { return {vsqrtq_f32(a.v)}; }
+    inline Vec<float> floor (Vec<float> a) { return {vrndmq_f32(a.v)}; }
+    inline Vec<float> operator< (Vec<float> a, Vec<float> b) { return {vreinterpretq_f32_u32(vcltq_f32(a.v, b.v))}; }
+    inline Vec<float> operator> (Vec<float> a, Vec<float> b) { return {vreinterpretq_f32_u32(vcgtq_f32(a.v, b.v))}; }
+    inline Vec<float> select (Vec<float> mask, Vec<float> a, Vec<float> b) { return {vbslq_f32(vreinterpretq_u32_f32(mask.v), a.v, b.v)}; }
+
+    inline Vec<float> exp2i (Vec<float> n) {
+        auto const i = vaddq_s32(vcvtq_s32_f32(n.v), vdupq_n_s32(127));
+        return {vreinterpretq_f32_s32(vshlq_n_s32(i, 23))};
+    }
+
+    inline Vec<float> splitExponent (Vec<float> x, Vec<float>& exponent) {
+        auto const bits = vreinterpretq_u32_f32(x.v);
+        auto const e = vsubq_s32(vreinterpretq_s32_u32(vshrq_n_u32(bits, 23)), vdupq_n_s32(127));
+        auto const m = vorrq_u32(vandq_u32(bits, vdupq_n_u32(0x007fffff)), vdupq_n_u32(0x3f800000));
+
+        exponent.v = vcvtq_f32_s32(e);
+        return {vreinterpretq_f32_u32(m)};
+    }
+
+    template <>
+    struct Vec<double>
+    {
+        static constexpr size_t size = 2;
+        float64x2_t v;
+
+        static Vec load(double const* p) { return {vld1q_f64(p)}; }
+        static Vec broadcast(double x) { return {vdupq_n_f64(x)}; }
+        void store(double* p) const { vst1q_f64(p, v); }
+    };
+
+    inline Vec<double> operator+ (Vec<double> a, Vec<double> b) { return {vaddq_f64(a.v, b.v)}; }
+    inline Vec<double> operator- (Vec<double> a, Vec<double> b) { return {vsubq_f64(a.v, b.v)}; }
+    inline Vec<double> operator* (Vec<double> a, Vec<double> b) { return {vmulq_f64(a.v, b.v)}; }
+    inline Vec<double> operator/ (Vec<double> a, Vec<double> b) { return {vdivq_f64(a.v, b.v)}; }
+    inline Vec<double> min (Vec<double> a, Vec<double> b) { return {vbslq_f64(vcltq_f64(b.v, a.v), b.v, a.v)}; }
+    inline Vec<double> max (Vec<double> a, Vec<double> b) { return {vbslq_f64(vcltq_f64(a.v, b.v), b.v, a.v)}; }
+    inline Vec<double> abs (Vec<double> a) { return {vabsq_f64(a.v)}; }
+    inline Vec<double> sqrt (Vec<double> a) { return {vsqrtq_f64(a.v)}; }
+    inline Vec<double> floor (Vec<double> a) { return {vrndmq_f64(a.v)}; }
+    inline Vec<double> operator< (Vec<double> a, Vec<double> b) { return {vreinterpretq_f64_u64(vcltq_f64(a.v, b.v))}; }
+    inline Vec<double> operator> (Vec<double> a, Vec<double> b) { return {vreinterpretq_f64_u64(vcgtq_f64(a.v, b.v))}; }
+    inline Vec<double> select (Vec<double> mask, Vec<double> a, Vec<double> b) { return {vbslq_f64(vreinterpretq_u64_f64(mask.v), a.v, b.v)}; }
+
+    inline Vec<double> exp2i (Vec<double> n) {
+        auto const i = vaddq_s64(vcvtq_s64_f64(n.v), vdupq_n_s64(1023));
+        return {vreinterpretq_f64_s64(vshlq_n_s64(i, 52))};
+    }
+
+    inline Vec<double> splitExponent (Vec<double> x, Vec<double>& exponent) {
+        auto const bits = vreinterpretq_u64_f64(x.v);
+        auto const e = vsubq_s64(vreinterpretq_s64_u64(vshrq_n_u64(bits, 52)), vdupq_n_s64(1023));
+        auto const m = vorrq_u64(vandq_u64(bits, vdupq_n_u64(0x000fffffffffffffULL)), vdupq_n_u64(0x3ff0000000000000ULL));
+
+        exponent.v = vcvtq_f64_s64(e);
+        return {vreinterpretq_f64_u64(m)};
+    }
+
+#endif
+
+    //==============================================================================
+    // Function objects for the lane-wise binary operations, matching std::plus,
+    // std::multiplies, std::min and std::max
+    struct Add { template <typename T> Vec<T> operator()(Vec<T> a, Vec<T> b) const { return a + b; } };
+    struct Mul { template <typename T> Vec<T> operator()(Vec<T> a, Vec<T> b) const { return a * b; } };
+    struct Min { template <typename T> Vec<T> operator()(Vec<T> a, Vec<T> b) const { return min(a, b); } };
+    struct Max { template <typename T> Vec<T> operator()(Vec<T> a, Vec<T> b) const { return max(a, b); } };
+
+    //==============================================================================
+    // Applies a vector kernel across a buffer, `fn` being any callable from Vec<T>
+    // to Vec<T>.
+    //
+    // The tail that doesn't fill a whole vector is staged through a small padded buffer,
+    // so every sample goes through exactly the same arithmetic regardless of where it
+    // falls in the block.
+    template <typename T, typename Fn>
+    inline void transform(T const* input, T* output, size_t numSamples, Fn&& fn)
+    {
+        using V = Vec<T>;
+
+        size_t i = 0;
+
+        for (; i + V::size <= numSamples; i += V::size) {
+            fn(V::load(input + i)).store(output + i);
+        }
+
+        if (i < numSamples) {
+            T scratch[V::size] = {};
+            std::copy(input + i, input + numSamples, scratch);
+            fn(V::load(scratch)).store(scratch);
+            std::copy(scratch, scratch + (numSamples - i), output + i);
+        }
+    }
+
+} // namespace simd
+} // namespace elem
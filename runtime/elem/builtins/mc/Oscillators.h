@@ -0,0 +1,213 @@
+#pragma once
+
+#include "../../GraphNode.h"
+#include "../../SingleWriterSingleReaderQueue.h"
+
+#include "../Oscillators.h"
+#include "../helpers/RefCountedPool.h"
+#include "../helpers/SIMD.h"
+
+
+namespace elem
+{
+
+    // A bank of PolyBLEP oscillators, one voice per child, rendering each voice to the
+    // matching output channel.
+    //
+    // This is the multichannel counterpart to PolyBlepOscillatorNode, producing the same
+    // output sample for sample for non-negative frequencies, but processing voices several
+    // at a time in SIMD lanes with the BLEP correction computed branch-free. That makes a
+    // unison or supersaw stack of N voices one node rather than N.
+    //
+    // The `channels` property sets how many voices hold phase state, and is expected to
+    // match the number of children.
+    template <typename FloatType, detail::BlepMode Mode>
+    struct MCPolyBlepOscillatorNode : public GraphNode<FloatType> {
+        using GraphNode<FloatType>::GraphNode;
+        using Vec = simd::Vec<FloatType>;
+
+        // Samples per chunk when transposing between per-voice buffers and lanes
+        static constexpr size_t kChunkSize = 32;
+
+        // Per-voice state, padded to a whole number of vectors, with scratch space for one
+        // chunk of each voice's input and output in lane order
+        struct VoiceState {
+            size_t numVoices = 0;
+            std::vector<FloatType> phase;
+            std::vector<FloatType> acc;
+            std::vector<FloatType> lanesIn;
+            std::vector<FloatType> lanesOut;
+        };
+
+        int setProperty(std::string const& key, js::Value const& val) override
+        {
+            if (key == "channels") {
+                if (!val.isNumber())
+                    return ReturnCode::InvalidPropertyType();
+
+                auto const n = (js::Number) val;
+
+                if (n < 1)
+                    return ReturnCode::InvalidPropertyValue();
+
+                auto const numVoices = static_cast<size_t>(n);
+                auto const paddedSize = ((numVoices + Vec::size - 1) / Vec::size) * Vec::size;
+
+                auto state = statePool.allocate();
+
+                state->numVoices = numVoices;
+                state->phase.assign(paddedSize, FloatType(0));
+                state->acc.assign(paddedSize, FloatType(0));
+                state->lanesIn.assign(paddedSize * kChunkSize, FloatType(0));
+                state->lanesOut.assign(paddedSize * kChunkSize, FloatType(0));
+
+                stateQueue.push(std::move(state));
+            }
+
+            return GraphNode<FloatType>::setProperty(key, val);
+        }
+
+        // The branch-free equivalent of PolyBlepOscillatorNode::blep, evaluating both
+        // polynomial segments and selecting between them per lane
+        static inline Vec blep (Vec phase, Vec increment)
+        {
+            auto const one = Vec::broadcast(FloatType(1));
+            auto const two = Vec::broadcast(FloatType(2));
+
+            auto const p = phase / increment;
+            auto const q = (phase - one) / increment;
+
+            auto const rising = (two - p) * p - one;
+            auto const falling = (q + two) * q + one;
+
+            return select(phase < increment, rising,
+                select(phase > (one - increment), falling, Vec::broadcast(FloatType(0))));
+        }
+
+        static inline Vec tick (Vec phase, Vec increment, Vec& acc)
+        {
+            auto const one = Vec::broadcast(FloatType(1));
+            auto const half = Vec::broadcast(FloatType(0.5));
+
+            if constexpr (Mode == detail::BlepMode::Saw) {
+                return Vec::broadcast(FloatType(2)) * phase - one - blep(phase, increment);
+            }
+
+            if constexpr (Mode == detail::BlepMode::Square || Mode == detail::BlepMode::Triangle) {
+                auto const naive = select(phase < half, one, Vec::broadcast(FloatType(-1)));
+
+                // For phase in [0, 1) this is fmod(phase + 0.5, 1)
+                auto const shifted = phase + half;
+                auto const halfPhase = select(shifted < one, shifted, shifted - one);
+
+                auto const square = naive + blep(phase, increment) - blep(halfPhase, increment);
+
+                if constexpr (Mode == detail::BlepMode::Square) {
+                    return square;
+                }
+
+                acc = acc + Vec::broadcast(FloatType(4)) * increment * square;
+                return acc;
+            }
+
+            return Vec::broadcast(FloatType(0));
+        }
+
+        void process (BlockContext<FloatType> const& ctx) override {
+            auto** inputData = ctx.inputData;
+            auto** outputData = ctx.outputData;
+            auto numSamples = ctx.numSamples;
+
+            // Pick up the latest voice state, carrying the phase of any voices we already
+            // had across so that changing the voice count doesn't reset every voice
+            while (stateQueue.size() > 0) {
+                std::shared_ptr<VoiceState> next;
+                stateQueue.pop(next);
+
+                std::fill(next->phase.begin(), next->phase.end(), FloatType(0));
+                std::fill(next->acc.begin(), next->acc.end(), FloatType(0));
+
+                if (activeState) {
+                    auto const n = std::min(activeState->phase.size(), next->phase.size());
+
+                    std::copy_n(activeState->phase.begin(), n, next->phase.begin());
+                    std::copy_n(activeState->acc.begin(), n, next->acc.begin());
+                }
+
+                activeState = std::move(next);
+            }
+
+            auto const numVoices = activeState
+                ? std::min({ ctx.numInputChannels, ctx.numOutputChannels, activeState->numVoices })
+                : size_t(0);
+
+            // Zero any outputs we don't have voices for
+            for (size_t j = numVoices; j < ctx.numOutputChannels; ++j)
+                std::fill_n(outputData[j], numSamples, FloatType(0));
+
+            if (numVoices == 0)
+                return;
+
+            auto const sr = Vec::broadcast(FloatType(GraphNode<FloatType>::getSampleRate()));
+            auto const one = Vec::broadcast(FloatType(1));
+
+            auto* phaseData = activeState->phase.data();
+            auto* accData = activeState->acc.data();
+            auto* lanesIn = activeState->lanesIn.data();
+            auto* lanesOut = activeState->lanesOut.data();
+
+            // Voice v's sample i within a chunk lives at lane (v % size) of vector i in its
+            // group's region of the scratch buffers
+            auto const laneIndex = [](size_t v, size_t i) {
+                return (v - v % Vec::size) * kChunkSize + i * Vec::size + v % Vec::size;
+            };
+
+            for (size_t start = 0; start < numSamples; start += kChunkSize) {
+                auto const chunkSize = std::min(kChunkSize, numSamples - start);
+
+                // Transpose the chunk's frequencies into lane order up front. Filling the
+                // scratch buffer well ahead of reading it back as vectors avoids stalling on
+                // store forwarding as a per-sample gather would. Lanes past the last voice
+                // were zeroed at allocation and are never written, so they run at zero
+                // frequency.
+                for (size_t v = 0; v < numVoices; ++v) {
+                    for (size_t i = 0; i < chunkSize; ++i) {
+                        lanesIn[laneIndex(v, i)] = inputData[v][start + i];
+                    }
+                }
+
+                // Each group's phase is a serial dependency from one sample to the next, so
+                // we step every group once per sample rather than running each group through
+                // the whole chunk in turn, letting the groups' dependency chains overlap.
+                for (size_t i = 0; i < chunkSize; ++i) {
+                    for (size_t first = 0; first < numVoices; first += Vec::size) {
+                        auto const offset = first * kChunkSize + i * Vec::size;
+
+                        auto phase = Vec::load(phaseData + first);
+                        auto acc = Vec::load(accData + first);
+
+                        auto const increment = Vec::load(lanesIn + offset) / sr;
+                        tick(phase, increment, acc).store(lanesOut + offset);
+
+                        phase = phase + increment;
+                        phase = select(phase < one, phase, phase - one);
+
+                        phase.store(phaseData + first);
+                        acc.store(accData + first);
+                    }
+                }
+
+                for (size_t v = 0; v < numVoices; ++v) {
+                    for (size_t i = 0; i < chunkSize; ++i) {
+                        outputData[v][start + i] = lanesOut[laneIndex(v, i)];
+                    }
+                }
+            }
+        }
+
+        RefCountedPool<VoiceState> statePool;
+        SingleWriterSingleReaderQueue<std::shared_ptr<VoiceState>> stateQueue;
+        std::shared_ptr<VoiceState> activeState;
+    };
+
+} // namespace elem
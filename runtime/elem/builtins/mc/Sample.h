@@ -6,7 +6,8 @@
 
 #include "../helpers/Change.h"
 #include "../helpers/GainFade.h"
-#include "../helpers/FloatUtils.h"
+#include "../helpers/Interpolation.h"
+#include "../helpers/RateMatchedResource.h"
 
 
 namespace elem
@@ -20,6 +21,14 @@ namespace elem
     // The sample file is loaded from disk or from virtual memory with a path set by the `path` property.
     // The sample is then triggered on the rising edge of an incoming pulse train, so
     // this node expects a single child node delivering that train.
+    //
+    // The `interpolation` property selects between "linear" (the default), "hermite"
+    // and "sinc" reads when the `playbackRate` property is away from unity.
+    //
+    // `startOffset` and `stopOffset` count samples of the resource as it was recorded. A
+    // resource recorded at another sample rate is converted to ours the first time a node
+    // refers to it, during that render; `Runtime::loadSharedResourceAsync` does the same
+    // conversion on its background thread as part of the load.
     template <typename FloatType>
     struct MCSampleNode : public GraphNode<FloatType> {
         using GraphNode<FloatType>::GraphNode;
@@ -33,8 +42,16 @@ namespace elem
                 if (!resources.has((js::String) val))
                     return ReturnCode::InvalidPropertyValue();
 
-                auto ref = resources.get((js::String) val);
+                // Resources recorded at a different rate are swapped for a copy converted
+                // to our sample rate, so that nominal pitch needs no interpolation
+                auto ref = getRateMatchedResource<FloatType>(resources, (js::String) val, GraphNode<FloatType>::getSampleRate());
                 bufferQueue.push(std::move(ref));
+
+                // The offsets count samples of the resource as recorded, so they follow it
+                // into the converted copy
+                offsetRatio = getRateMatchRatio(resources, (js::String) val, GraphNode<FloatType>::getSampleRate());
+                startOffset.store(toPlaybackSamples(GraphNode<FloatType>::getPropertyWithDefault("startOffset", js::Number(0))));
+                stopOffset.store(toPlaybackSamples(GraphNode<FloatType>::getPropertyWithDefault("stopOffset", js::Number(0))));
             }
 
             if (key == "mode") {
@@ -58,7 +75,7 @@ namespace elem
                 if (vi < 0)
                     return ReturnCode::InvalidPropertyValue();
 
-                startOffset.store(static_cast<size_t>(vi));
+                startOffset.store(toPlaybackSamples(vi));
             }
 
             if (key == "stopOffset") {
@@ -71,7 +88,7 @@ namespace elem
                 if (vi < 0)
                     return ReturnCode::InvalidPropertyValue();
 
-                stopOffset.store(static_cast<size_t>(vi));
+                stopOffset.store(toPlaybackSamples(vi));
             }
 
             if (key == "playbackRate") {
@@ -81,9 +98,31 @@ namespace elem
                 playbackRate.store((js::Number) val);
             }
 
+            if (key == "interpolation") {
+                if (!val.isString())
+                    return ReturnCode::InvalidPropertyType();
+
+                InterpolationMode m;
+
+                if (!parseInterpolationMode((js::String) val, m))
+                    return ReturnCode::InvalidPropertyValue();
+
+                // Make sure the sinc kernel is built here rather than on the realtime thread
+                if (m == InterpolationMode::Sinc)
+                    detail::SincKernel<FloatType>::get();
+
+                interpolation.store(m);
+            }
+
             return GraphNode<FloatType>::setProperty(key, val);
         }
 
+        // Converts an offset into the resource as recorded to one into the copy we play
+        size_t toPlaybackSamples(js::Number v) const
+        {
+            return static_cast<size_t>(std::round(static_cast<double>(static_cast<int>(v)) * offsetRatio));
+        }
+
         void reset() override {
             readers[0].noteOff();
             readers[1].noteOff();
@@ -127,6 +166,7 @@ namespace elem
             auto const ostart = startOffset.load();
             auto const ostop = stopOffset.load();
             auto const rate = playbackRate.load();
+            auto const interp = interpolation.load();
 
             size_t i = 0;
             size_t j = 0;
@@ -136,8 +176,8 @@ namespace elem
 
                 if (cv > FloatType(0.5)) {
                     // Read from [i, j]
-                    readers[0].sumInto(outputData, numOuts, i, j - i, rate);
-                    readers[1].sumInto(outputData, numOuts, i, j - i, rate);
+                    readers[0].sumInto(outputData, numOuts, i, j - i, rate, interp);
+                    readers[1].sumInto(outputData, numOuts, i, j - i, rate, interp);
 
                     // Update voice state
                     readers[currentReader & 1].noteOff();
@@ -150,8 +190,8 @@ namespace elem
                 // If we're in trigger mode then we can ignore falling edges
                 if (cv < FloatType(-0.5) && playbackMode != Mode::Trigger) {
                     // Read from [i, j]
-                    readers[0].sumInto(outputData, numOuts, i, j - i, rate);
-                    readers[1].sumInto(outputData, numOuts, i, j - i, rate);
+                    readers[0].sumInto(outputData, numOuts, i, j - i, rate, interp);
+                    readers[1].sumInto(outputData, numOuts, i, j - i, rate, interp);
 
                     // Update voice state
                     readers[currentReader & 1].noteOff();
@@ -162,8 +202,8 @@ namespace elem
                 }
             }
 
-            readers[0].sumInto(outputData, numOuts, i, j - i, rate);
-            readers[1].sumInto(outputData, numOuts, i, j - i, rate);
+            readers[0].sumInto(outputData, numOuts, i, j - i, rate, interp);
+            readers[1].sumInto(outputData, numOuts, i, j - i, rate, interp);
         }
 
         SingleWriterSingleReaderQueue<SharedResourcePtr> bufferQueue;
@@ -183,11 +223,13 @@ namespace elem
         std::atomic<Mode> mode = Mode::Trigger;
         std::atomic<size_t> startOffset = 0;
         std::atomic<size_t> stopOffset = 0;
+        double offsetRatio = 1.0;
         std::atomic<double> playbackRate = 1.0;
+        std::atomic<InterpolationMode> interpolation = InterpolationMode::Linear;
     };
 
     // A helper struct for reading from sample data with variable rate using
-    // linear interpolation.
+    // the shared interpolation kernel.
     template <typename FloatType>
     struct MCVariablePitchReader
     {
@@ -218,25 +260,7 @@ namespace elem
             gainFade.fadeOut();
         }
 
-        FloatType lerpRead(BufferView<float> const& view, double pos)
-        {
-            auto* data = view.data();
-            auto size = view.size();
-
-            auto left = static_cast<size_t>(pos);
-            auto right = left + 1;
-            auto alpha = pos - (double) left;
-
-            if (left >= size)
-                return FloatType(0);
-
-            if (right >= size)
-                return data[left];
-
-            return lerp(static_cast<float>(alpha), data[left], data[right]);
-        }
-
-        void sumInto(FloatType** outputData, size_t numOuts, size_t writeOffset, size_t numSamples, double playbackRate)
+        void sumInto(FloatType** outputData, size_t numOuts, size_t writeOffset, size_t numSamples, double playbackRate, InterpolationMode interpolation)
         {
             elem::GainFade<FloatType> localFade(gainFade);
 
@@ -244,27 +268,78 @@ namespace elem
             double readStop = 0;
 
             for (size_t i = 0; i < std::min(numOuts, sourceBuffer->numChannels()); ++i) {
-                auto bufferView = sourceBuffer->getChannelData(i);
-                size_t const sourceLength = bufferView.size();
+                visitChannelData<FloatType>(*sourceBuffer, i, [&](auto const& bufferView) {
+                    size_t const sourceLength = bufferView.size();
+
+                    readStop = static_cast<double>(sourceLength) - stopOffset;
+
+                    // Reinitialize the local copy to match our member instance
+                    localFade = gainFade;
 
-                readStop = static_cast<double>(sourceLength) - stopOffset;
+                    // At unity rate from a whole sample position every read lands exactly on a
+                    // source sample, so we can step an integer index rather than interpolate
+                    auto const isUnityRate = playbackRate == 1.0
+                        && pos == std::floor(pos)
+                        && readStart >= 0.0
+                        && readStart < readStop;
 
-                // Reinitialize the local copy to match our member instance
-                localFade = gainFade;
+                    if (isUnityRate) {
+                        auto* sourceData = bufferView.data();
+                        auto const start = static_cast<size_t>(readStart);
+                        auto const stop = static_cast<size_t>(readStop);
+                        auto readPos = static_cast<size_t>(pos);
 
-                for (size_t j = 0; j < numSamples; ++j) {
-                    double readPos = pos + static_cast<double>(j) * playbackRate;
+                        for (size_t j = 0; j < numSamples; ++j, ++readPos) {
+                            if (readPos >= stop) {
+                                if (!shouldLoop)
+                                    break;
 
-                    if (readPos >= readStop) {
-                        if (shouldLoop) {
-                            readPos = readStart + std::fmod(readPos - readStart, readStop - readStart);
-                        } else {
-                            continue;
+                                readPos = start + (readPos - start) % (stop - start);
+                            }
+
+                            outputData[i][writeOffset + j] += localFade(FloatType(sourceData[readPos]));
                         }
+
+                        return;
                     }
 
-                    outputData[i][writeOffset + j] += localFade(lerpRead(bufferView, readPos));
-                }
+                    // Otherwise we resolve the read positions a chunk at a time and hand them
+                    // to the shared interpolator. Reads that run past the end of a one-shot
+                    // are skipped entirely, leaving the fade where it was, and we point them
+                    // at the start of the buffer just to keep the interpolator in bounds.
+                    constexpr size_t kChunkSize = 64;
+
+                    size_t index[kChunkSize];
+                    FloatType frac[kChunkSize];
+                    FloatType reads[kChunkSize];
+                    bool skip[kChunkSize];
+
+                    for (size_t start = 0; start < numSamples; start += kChunkSize) {
+                        auto const count = std::min(kChunkSize, numSamples - start);
+
+                        for (size_t j = 0; j < count; ++j) {
+                            double readPos = pos + static_cast<double>(start + j) * playbackRate;
+
+                            skip[j] = readPos >= readStop && !shouldLoop;
+
+                            if (skip[j]) {
+                                readPos = 0.0;
+                            } else if (readPos >= readStop) {
+                                readPos = readStart + std::fmod(readPos - readStart, readStop - readStart);
+                            }
+
+                            index[j] = static_cast<size_t>(readPos);
+                            frac[j] = FloatType(readPos - (double) index[j]);
+                        }
+
+                        interpolate(interpolation, InterpolationEdge::Clamp, bufferView.data(), sourceLength, index, frac, reads, count);
+
+                        for (size_t j = 0; j < count; ++j) {
+                            if (!skip[j])
+                                outputData[i][writeOffset + start + j] += localFade(reads[j]);
+                        }
+                    }
+                });
             }
 
             // Here we have a localFade instance that has finished running over a block, which
@@ -2,6 +2,7 @@
 
 #include "../helpers/FloatUtils.h"
 #include "../helpers/GainFade.h"
+#include "../helpers/RenderAhead.h"
 
 
 namespace elem
@@ -87,6 +88,8 @@ namespace elem
         };
     }
 
+    // As with SampleSeqNode, the `background` property moves the stretching variant's
+    // rendering onto a worker thread.
     template <typename FloatType, bool WithStretch = false>
     struct StereoSampleSeqNode : public GraphNode<FloatType> {
         StereoSampleSeqNode(NodeId id, FloatType const sr, int const blockSize)
@@ -101,6 +104,38 @@ namespace elem
             }
         }
 
+        using Sequence = std::map<double, FloatType, std::less<double>>;
+        using Ahead = detail::RenderAhead<FloatType, Sequence>;
+
+        // How far ahead the background worker renders, in samples
+        static constexpr size_t kLookahead = 2048;
+
+        void prepare(double sr, size_t bs) override
+        {
+            GraphNode<FloatType>::prepare(sr, bs);
+
+            for (auto& reader : readers) {
+                reader.fade.setFadeInTimeMs(sr, 8.0);
+                reader.fade.setFadeOutTimeMs(sr, 8.0);
+            }
+
+            if constexpr (WithStretch) {
+                // The worker renders in chunks of one block, from this node's stretcher, so
+                // we stop it before touching either. Dropping the last reference joins its
+                // thread, and the background property starts a new one at the new size when
+                // the runtime hands it back to us.
+                while (aheadQueue.size() > 0)
+                    aheadQueue.pop(activeAhead);
+
+                activeAhead = nullptr;
+                ahead = nullptr;
+                rtBackground = false;
+
+                stretch.presetDefault(2, sr);
+                scratchBuffer.assign(bs * 4 * 2, FloatType(0));
+            }
+        }
+
         int setProperty(std::string const& key, js::Value const& val, SharedResourceMap& resources) override
         {
             if constexpr (WithStretch) {
@@ -108,8 +143,7 @@ namespace elem
                     if (!val.isNumber())
                         return ReturnCode::InvalidPropertyType();
 
-                    auto shift = (js::Number) val;
-                    stretch.setTransposeSemitones(shift);
+                    shiftSemitones.store((js::Number) val);
                 }
 
                 if (key == "stretch") {
@@ -123,6 +157,25 @@ namespace elem
 
                     stretchFactor.store(_stretchFactor);
                 }
+
+                if (key == "background") {
+                    if (!val.isBool())
+                        return ReturnCode::InvalidPropertyType();
+
+                    // The worker is started the first time it's asked for, and kept until
+                    // the node goes away or is prepared again. Without thread support we
+                    // simply stretch inline.
+                    if ((js::Boolean) val && ahead == nullptr) {
+                        auto a = std::make_shared<Ahead>(2, GraphNode<FloatType>::getBlockSize(), kLookahead);
+
+                        if (a->startWorker([this, p = a.get()]() { p->renderAhead(*this); })) {
+                            ahead = a;
+                            aheadQueue.push(std::move(a));
+                        }
+                    }
+
+                    background.store((js::Boolean) val);
+                }
             }
 
             if (key == "duration") {
@@ -205,11 +258,107 @@ namespace elem
             }
         }
 
+        // Takes a new sequence or sample, on whichever thread is rendering
+        void update(std::shared_ptr<Sequence> const& seq, SharedResourcePtr const& buffer)
+        {
+            if (buffer != activeBuffer) {
+                activeBuffer = buffer;
+
+                readers[0].reset(sampleDuration.load());
+                readers[1].reset(sampleDuration.load());
+            }
+
+            // New sequence means we'll have to find our new event boundaries given
+            // the current input time
+            if (seq != nullptr && seq != activeSeq) {
+                activeSeq = seq;
+
+                prevEvent = activeSeq->end();
+                nextEvent = activeSeq->end();
+            }
+        }
+
+        // Starts playback over from wherever the next render call's time lands
+        void seek()
+        {
+            rtSampleDuration = sampleDuration.load();
+
+            readers[0].reset(rtSampleDuration);
+            readers[1].reset(rtSampleDuration);
+
+            if (activeSeq != nullptr) {
+                prevEvent = activeSeq->end();
+                nextEvent = activeSeq->end();
+            }
+
+            if constexpr (WithStretch) {
+                stretch.reset();
+                accFracSamples = 0;
+            }
+        }
+
         void process (BlockContext<FloatType> const& ctx) override {
             auto** inputData = ctx.inputData;
             auto** outputData = ctx.outputData;
             auto numSamples = ctx.numSamples;
 
+            // Pull newest buffer and seq from their queues
+            while (bufferQueue.size() > 0)
+                bufferQueue.pop(latestBuffer);
+
+            while (seqQueue.size() > 0)
+                seqQueue.pop(latestSeq);
+
+            auto const silence = [&]() {
+                for (size_t i = 0; i < ctx.numOutputChannels; ++i) {
+                    std::fill_n(outputData[i], numSamples, FloatType(0));
+                }
+            };
+
+            if (ctx.numInputChannels < 1)
+                return silence();
+
+            // Downsampling from a-rate to k-rate
+            auto const t = static_cast<double>(inputData[0][0]);
+
+            if constexpr (WithStretch) {
+                while (aheadQueue.size() > 0)
+                    aheadQueue.pop(activeAhead);
+
+                auto const inBackground = activeAhead != nullptr && background.load();
+
+                if (inBackground != rtBackground) {
+                    // The worker may still be running a job on our state, in which case we
+                    // wait it out before rendering inline again
+                    if (!inBackground && !activeAhead->isIdle())
+                        return silence();
+
+                    // Either way, playback picks up again from the current time. The
+                    // worker had rendered ahead of it.
+                    if (inBackground) {
+                        activeAhead->restart();
+                    } else {
+                        seek();
+                    }
+
+                    rtBackground = inBackground;
+                }
+
+                if (rtBackground) {
+                    activeAhead->process(t, { 0, 0, 0, stretchFactor.load(), shiftSemitones.load(), latestSeq, latestBuffer }, outputData, ctx.numOutputChannels, numSamples);
+                    return;
+                }
+
+                update(latestSeq, latestBuffer);
+                render(t, stretchFactor.load(), shiftSemitones.load(), outputData, ctx.numOutputChannels, numSamples);
+            } else {
+                update(latestSeq, latestBuffer);
+                render(t, 1.0, 0.0, outputData, ctx.numOutputChannels, numSamples);
+            }
+        }
+
+        void render(double t, double factor, double shift, FloatType** outputData, size_t numOutputChannels, size_t numSamples)
+        {
             // Load sample duration
             auto const sampleDur = sampleDuration.load();
 
@@ -219,30 +368,10 @@ namespace elem
                 rtSampleDuration = sampleDur;
             }
 
-            // Pull newest buffer from queue
-            while (bufferQueue.size() > 0) {
-                bufferQueue.pop(activeBuffer);
-
-                readers[0].reset(sampleDur);
-                readers[1].reset(sampleDur);
-            }
-
-            // Pull newest seq from queue
-            if (seqQueue.size() > 0) {
-                while (seqQueue.size() > 0) {
-                    seqQueue.pop(activeSeq);
-                }
-
-                // New sequence means we'll have to find our new event boundaries given
-                // the current input time
-                prevEvent = activeSeq->end();
-                nextEvent = activeSeq->end();
-            }
-
             // Next, if we don't have the inputs we need, we bail here and zero the buffer
             // hoping to prevent unexpected signals.
-            if (ctx.numInputChannels < 1 || activeSeq == nullptr || activeBuffer == nullptr || sampleDur <= 0.0) {
-                for (size_t i = 0; i < ctx.numOutputChannels; ++i) {
+            if (activeSeq == nullptr || activeBuffer == nullptr || sampleDur <= 0.0) {
+                for (size_t i = 0; i < numOutputChannels; ++i) {
                     std::fill_n(outputData[i], numSamples, FloatType(0));
                 }
 
@@ -257,9 +386,6 @@ namespace elem
             auto const before = [](double t1, double t2) { return t1 <= (t2 + 1e-6); };
             auto const after = [](double t1, double t2) { return t1 >= (t2 - 1e-6); };
 
-            // Downsampling from a-rate to k-rate
-            auto const t = static_cast<double>(inputData[0][0]);
-
             // We update our event boundaries if we just took a new sequence, if we've stepped
             // forwards or backwards over the next event time, or if the incoming time step differs
             // excessively from what we expected
@@ -275,11 +401,16 @@ namespace elem
             }
 
             if constexpr (WithStretch) {
+                if (shift != rtShift) {
+                    stretch.setTransposeSemitones(shift);
+                    rtShift = shift;
+                }
+
                 // Some fractional sample counting here. Every time we calculate the number of
                 // source samples, we inevitably leave a little rounding error. To ensure we
                 // average out correctly over time, we accumulate that rounding error and nudge
                 // our numSourceSamples once the accumulated error exceeds a full sample.
-                double const trueSourceSamples = (double) numSamples / stretchFactor.load();
+                double const trueSourceSamples = (double) numSamples / factor;
                 size_t numSourceSamples = static_cast<size_t>(trueSourceSamples);
 
                 accFracSamples += (trueSourceSamples - (double) numSourceSamples);
@@ -299,8 +430,8 @@ namespace elem
                 std::array<FloatType*, 2> ptrs {{scratchData, scratchData + (numSamples * 4)}};
                 auto** scratchPtrs = ptrs.data();
 
-                readers[0].readAdding(activeBuffer.get(), scratchPtrs, ctx.numOutputChannels, numSourceSamples);
-                readers[1].readAdding(activeBuffer.get(), scratchPtrs, ctx.numOutputChannels, numSourceSamples);
+                readers[0].readAdding(activeBuffer.get(), scratchPtrs, numOutputChannels, numSourceSamples);
+                readers[1].readAdding(activeBuffer.get(), scratchPtrs, numOutputChannels, numSourceSamples);
 
                 stretch.process(scratchPtrs, static_cast<int>(numSourceSamples), outputData, static_cast<int>(numSamples));
             } else {
@@ -309,13 +440,11 @@ namespace elem
                     std::fill_n(outputData[i], numSamples, FloatType(0));
                 }
 
-                readers[0].readAdding(activeBuffer.get(), outputData, ctx.numOutputChannels, numSamples);
-                readers[1].readAdding(activeBuffer.get(), outputData, ctx.numOutputChannels, numSamples);
+                readers[0].readAdding(activeBuffer.get(), outputData, numOutputChannels, numSamples);
+                readers[1].readAdding(activeBuffer.get(), outputData, numOutputChannels, numSamples);
             }
         }
 
-        using Sequence = std::map<double, FloatType, std::less<double>>;
-
         RefCountedPool<Sequence> seqPool;
         SingleWriterSingleReaderQueue<std::shared_ptr<Sequence>> seqQueue;
         std::shared_ptr<Sequence> activeSeq;
@@ -326,6 +455,11 @@ namespace elem
         SingleWriterSingleReaderQueue<SharedResourcePtr> bufferQueue;
         SharedResourcePtr activeBuffer;
 
+        // The newest sequence and buffer, as seen from the realtime thread. The rendering
+        // thread, which is the worker in the background, takes them via `update`.
+        std::shared_ptr<Sequence> latestSeq;
+        SharedResourcePtr latestBuffer;
+
         std::array<detail::MCBufferReader<float>, 2> readers;
         size_t activeReader = 0;
         int64_t nextExpectedBlockStart = 0;
@@ -336,7 +470,18 @@ namespace elem
         signalsmith::stretch::SignalsmithStretch<FloatType> stretch;
         double accFracSamples = 0;
         std::atomic<double> stretchFactor = 1.0;
+        std::atomic<double> shiftSemitones = 0.0;
+        double rtShift = 0;
         std::vector<FloatType> scratchBuffer;
+
+        std::atomic<bool> background = false;
+        bool rtBackground = false;
+
+        // Declared last so that the worker is stopped before the state it renders from
+        // goes away
+        std::shared_ptr<Ahead> ahead;
+        SingleWriterSingleReaderQueue<std::shared_ptr<Ahead>> aheadQueue;
+        std::shared_ptr<Ahead> activeAhead;
     };
 
     template <typename FloatType>
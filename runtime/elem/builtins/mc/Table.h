@@ -4,10 +4,14 @@
 #include "../../SingleWriterSingleReaderQueue.h"
 #include "../../Types.h"
 
+#include "../helpers/Interpolation.h"
+
 
 namespace elem
 {
 
+    // The multichannel counterpart to TableNode, reading every channel of the table at the
+    // position given by its one child and writing each to the matching output channel.
     template <typename FloatType>
     struct StereoTableNode : public GraphNode<FloatType> {
         using GraphNode<FloatType>::GraphNode;
@@ -25,6 +29,22 @@ namespace elem
                 bufferQueue.push(std::move(ref));
             }
 
+            if (key == "interpolation") {
+                if (!val.isString())
+                    return ReturnCode::InvalidPropertyType();
+
+                InterpolationMode m;
+
+                if (!parseInterpolationMode((js::String) val, m))
+                    return ReturnCode::InvalidPropertyValue();
+
+                // Make sure the sinc kernel is built here rather than on the realtime thread
+                if (m == InterpolationMode::Sinc)
+                    detail::SincKernel<FloatType>::get();
+
+                interpolation.store(m);
+            }
+
             return GraphNode<FloatType>::setProperty(key, val);
         }
 
@@ -49,36 +69,45 @@ namespace elem
                 return;
             }
 
+            auto const m = interpolation.load();
+
             for (size_t j = 0; j < numChannels; ++j)
             {
-                auto const bufferView = activeBuffer->getChannelData(j);
-                auto const bufferSize = bufferView.size();
-                auto const bufferData = bufferView.data();
-                auto* inputData = ctx.inputData[0];
-
-
-                if (bufferSize == 0)
-                {
-                    std::fill_n(outputData[j], numSamples, FloatType(0));
-                    continue;
-                }
+                visitChannelData<FloatType>(*activeBuffer, j, [&](auto const& bufferView) {
+                    auto const bufferSize = bufferView.size();
+                    auto const bufferData = bufferView.data();
+                    auto* inputData = ctx.inputData[0];
+
+                    if (bufferSize == 0)
+                    {
+                        std::fill_n(outputData[j], numSamples, FloatType(0));
+                        return;
+                    }
+
+                    for (size_t start = 0; start < numSamples; start += kChunkSize)
+                    {
+                        auto const count = std::min(kChunkSize, numSamples - start);
+
+                        for (size_t i = 0; i < count; ++i)
+                        {
+                            auto const readPos = std::clamp(inputData[start + i], FloatType(0), FloatType(1)) * FloatType(bufferSize - 1);
+
+                            index[i] = static_cast<size_t>(readPos);
+                            frac[i] = readPos - static_cast<FloatType>(index[i]);
+                        }
+
+                        interpolate(m, InterpolationEdge::Clamp, bufferData, bufferSize, index, frac, outputData[j] + start, count);
+                    }
+                });
+            }
+        }
 
-                for (size_t i = 0; i < numSamples; ++i)
-                {
-                    auto const readPos = std::clamp(inputData[i], FloatType(0), FloatType(1)) * FloatType(bufferSize - 1);
-                    auto const readLeft = static_cast<size_t>(readPos);
-                    auto const readRight = readLeft + 1;
-                    auto const frac = readPos - std::floor(readPos);
+        static constexpr size_t kChunkSize = 64;
 
-                    auto const left = bufferData[readLeft % bufferSize];
-                    auto const right = bufferData[readRight % bufferSize];
+        size_t index[kChunkSize];
+        FloatType frac[kChunkSize];
 
-                    // Now we can read the next sample out with linear
-                    // interpolation for sub-sample reads.
-                    outputData[j][i] = left + frac * (right - left);
-                }
-            }
-        }
+        std::atomic<InterpolationMode> interpolation { InterpolationMode::Linear };
 
         SingleWriterSingleReaderQueue<SharedResourcePtr> bufferQueue;
         SharedResourcePtr activeBuffer;
@@ -0,0 +1,381 @@
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <elem/Runtime.h>
+
+
+namespace
+{
+
+    //==============================================================================
+    int failures = 0;
+
+    void expect(bool condition, std::string const& description)
+    {
+        if (!condition) {
+            std::fprintf(stderr, "FAIL: %s\n", description.c_str());
+            ++failures;
+        }
+    }
+
+    //==============================================================================
+    // Helpers for assembling file fixtures in memory
+    using Bytes = std::vector<uint8_t>;
+
+    void appendUInt(Bytes& b, uint32_t v, size_t numBytes, bool bigEndian)
+    {
+        for (size_t i = 0; i < numBytes; ++i) {
+            auto const shift = bigEndian ? (8 * (numBytes - 1 - i)) : (8 * i);
+            b.push_back(static_cast<uint8_t>((v >> shift) & 0xff));
+        }
+    }
+
+    void appendTag(Bytes& b, char const* tag)
+    {
+        b.insert(b.end(), tag, tag + 4);
+    }
+
+    void appendChunk(Bytes& b, char const* tag, Bytes const& body, bool bigEndian)
+    {
+        appendTag(b, tag);
+        appendUInt(b, static_cast<uint32_t>(body.size()), 4, bigEndian);
+        b.insert(b.end(), body.begin(), body.end());
+
+        if (body.size() & 1)
+            b.push_back(0);
+    }
+
+    Bytes wavFmt(uint32_t formatTag, uint32_t numChannels, uint32_t sampleRate, uint32_t bitsPerSample)
+    {
+        auto const blockAlign = numChannels * bitsPerSample / 8;
+
+        Bytes fmt;
+        appendUInt(fmt, formatTag, 2, false);
+        appendUInt(fmt, numChannels, 2, false);
+        appendUInt(fmt, sampleRate, 4, false);
+        appendUInt(fmt, sampleRate * blockAlign, 4, false);
+        appendUInt(fmt, blockAlign, 2, false);
+        appendUInt(fmt, bitsPerSample, 2, false);
+        return fmt;
+    }
+
+    Bytes riff(char const* form, Bytes const& chunks, bool bigEndian)
+    {
+        Bytes b;
+        appendTag(b, bigEndian ? "FORM" : "RIFF");
+        appendUInt(b, static_cast<uint32_t>(chunks.size() + 4), 4, bigEndian);
+        appendTag(b, form);
+        b.insert(b.end(), chunks.begin(), chunks.end());
+        return b;
+    }
+
+    Bytes wav(Bytes const& fmt, Bytes const& data)
+    {
+        Bytes chunks;
+        appendChunk(chunks, "fmt ", fmt, false);
+        appendChunk(chunks, "data", data, false);
+        return riff("WAVE", chunks, false);
+    }
+
+    // An AIFF COMM chunk body, with the sample rate given as its raw 80-bit
+    // extended precision bytes
+    Bytes aiffComm(uint32_t numChannels, uint32_t numFrames, uint32_t sampleSize, std::vector<uint8_t> const& rate)
+    {
+        Bytes comm;
+        appendUInt(comm, numChannels, 2, true);
+        appendUInt(comm, numFrames, 4, true);
+        appendUInt(comm, sampleSize, 2, true);
+        comm.insert(comm.end(), rate.begin(), rate.end());
+        return comm;
+    }
+
+    Bytes aiffSsnd(Bytes const& samples)
+    {
+        Bytes ssnd;
+        appendUInt(ssnd, 0, 4, true);
+        appendUInt(ssnd, 0, 4, true);
+        ssnd.insert(ssnd.end(), samples.begin(), samples.end());
+        return ssnd;
+    }
+
+    //==============================================================================
+    std::filesystem::path const fixtureDir = std::filesystem::temp_directory_path() / "elem-audio-file-loader-test";
+
+    std::string writeFixture(std::string const& name, Bytes const& bytes)
+    {
+        auto const path = (fixtureDir / name).string();
+        std::ofstream file(path, std::ios::binary);
+        file.write(reinterpret_cast<char const*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+        return path;
+    }
+
+    std::string decode(std::string const& name, Bytes const& bytes, elem::DecodedAudioFile& result)
+    {
+        return elem::decodeAudioFile(writeFixture(name, bytes), result);
+    }
+
+    // Every PCM fixture encodes these values, which are exact at each bit depth
+    std::vector<float> const expectedSamples { 0.0f, 0.5f, -0.5f, -1.0f };
+
+    void expectSamples(std::string const& name, std::string const& error, elem::DecodedAudioFile const& result, double sampleRate, size_t numChannels)
+    {
+        expect(error.empty(), name + " decodes without error (got: " + error + ")");
+        expect(result.sampleRate == sampleRate, name + " reports its sample rate");
+        expect(result.channels.size() == numChannels, name + " reports its channel count");
+
+        for (size_t i = 0; i < result.channels.size(); ++i) {
+            expect(result.channels[i] == expectedSamples, name + " decodes channel " + std::to_string(i));
+        }
+    }
+
+    //==============================================================================
+    void testWavPCM()
+    {
+        struct Case { uint32_t bits; std::vector<uint32_t> words; };
+
+        std::vector<Case> const cases {
+            { 16, { 0x0000, 0x4000, 0xc000, 0x8000 } },
+            { 24, { 0x000000, 0x400000, 0xc00000, 0x800000 } },
+            { 32, { 0x00000000, 0x40000000, 0xc0000000, 0x80000000 } },
+        };
+
+        for (auto const& c : cases) {
+            Bytes data;
+
+            // Stereo, with identical left and right channels
+            for (auto w : c.words) {
+                appendUInt(data, w, c.bits / 8, false);
+                appendUInt(data, w, c.bits / 8, false);
+            }
+
+            auto const name = "pcm" + std::to_string(c.bits) + ".wav";
+            elem::DecodedAudioFile result;
+            auto const error = decode(name, wav(wavFmt(1, 2, 48000, c.bits), data), result);
+            expectSamples(name, error, result, 48000, 2);
+        }
+    }
+
+    void testWavFloat()
+    {
+        Bytes data;
+
+        for (auto v : expectedSamples) {
+            uint32_t bits;
+            std::memcpy(&bits, &v, sizeof(float));
+            appendUInt(data, bits, 4, false);
+        }
+
+        elem::DecodedAudioFile result;
+        auto const error = decode("float32.wav", wav(wavFmt(3, 1, 44100, 32), data), result);
+        expectSamples("float32.wav", error, result, 44100, 1);
+    }
+
+    void testWavExtensible()
+    {
+        // A WAVE_FORMAT_EXTENSIBLE fmt chunk, whose sub format GUID begins with the
+        // PCM format code
+        auto fmt = wavFmt(0xfffe, 1, 44100, 24);
+        appendUInt(fmt, 22, 2, false);
+        appendUInt(fmt, 24, 2, false);
+        appendUInt(fmt, 0, 4, false);
+        appendUInt(fmt, 1, 2, false);
+        fmt.resize(fmt.size() + 14, 0);
+
+        Bytes data;
+
+        for (auto w : { 0x000000u, 0x400000u, 0xc00000u, 0x800000u })
+            appendUInt(data, w, 3, false);
+
+        elem::DecodedAudioFile result;
+        auto const error = decode("extensible.wav", wav(fmt, data), result);
+        expectSamples("extensible.wav", error, result, 44100, 1);
+    }
+
+    void testAiff()
+    {
+        struct Case { double sampleRate; std::vector<uint8_t> rate; };
+
+        std::vector<Case> const cases {
+            { 44100, { 0x40, 0x0e, 0xac, 0x44, 0, 0, 0, 0, 0, 0 } },
+            { 48000, { 0x40, 0x0e, 0xbb, 0x80, 0, 0, 0, 0, 0, 0 } },
+            { 22050, { 0x40, 0x0d, 0xac, 0x44, 0, 0, 0, 0, 0, 0 } },
+            { 11025.5, { 0x40, 0x0c, 0xac, 0x46, 0, 0, 0, 0, 0, 0 } },
+        };
+
+        Bytes samples;
+
+        for (auto w : { 0x0000u, 0x4000u, 0xc000u, 0x8000u })
+            appendUInt(samples, w, 2, true);
+
+        for (auto const& c : cases) {
+            Bytes chunks;
+            appendChunk(chunks, "COMM", aiffComm(1, 4, 16, c.rate), true);
+            appendChunk(chunks, "SSND", aiffSsnd(samples), true);
+
+            auto const name = "rate" + std::to_string(static_cast<int>(c.sampleRate)) + ".aif";
+            elem::DecodedAudioFile result;
+            auto const error = decode(name, riff("AIFF", chunks, true), result);
+            expectSamples(name, error, result, c.sampleRate, 1);
+        }
+    }
+
+    void testMalformedHeaders()
+    {
+        Bytes pcm16;
+
+        for (auto w : { 0x0000u, 0x4000u, 0xc000u, 0x8000u })
+            appendUInt(pcm16, w, 2, false);
+
+        auto const valid = wav(wavFmt(1, 1, 44100, 16), pcm16);
+
+        auto expectError = [](std::string const& name, Bytes const& bytes) {
+            elem::DecodedAudioFile result;
+            expect(!decode(name, bytes, result).empty(), name + " is rejected");
+        };
+
+        // Cut off within the fmt chunk body
+        expectError("truncated-fmt.wav", Bytes(valid.begin(), valid.begin() + 28));
+
+        // Cut off before the data chunk
+        expectError("truncated-data.wav", Bytes(valid.begin(), valid.begin() + 36));
+
+        // Cut off within the RIFF header itself
+        expectError("truncated-riff.wav", Bytes(valid.begin(), valid.begin() + 10));
+
+        // An extensible fmt chunk too short to carry its sub format
+        expectError("short-extensible.wav", wav(wavFmt(0xfffe, 1, 44100, 16), pcm16));
+
+        {
+            Bytes chunks;
+            appendChunk(chunks, "data", pcm16, false);
+            appendChunk(chunks, "fmt ", wavFmt(1, 1, 44100, 16), false);
+            expectError("data-first.wav", riff("WAVE", chunks, false));
+        }
+
+        expectError("zero-channels.wav", wav(wavFmt(1, 0, 44100, 16), pcm16));
+        expectError("12-bit.wav", wav(wavFmt(1, 1, 44100, 12), pcm16));
+        expectError("adpcm.wav", wav(wavFmt(2, 1, 44100, 16), pcm16));
+        expectError("not-audio.wav", Bytes { 'n', 'o', 't', ' ', 'a', 'u', 'd', 'i', 'o', '!', '!', '!' });
+
+        Bytes const rate { 0x40, 0x0e, 0xac, 0x44, 0, 0, 0, 0, 0, 0 };
+
+        {
+            // A COMM chunk which ends before the sample rate
+            Bytes comm = aiffComm(1, 4, 16, rate);
+            comm.resize(12);
+
+            Bytes chunks;
+            appendChunk(chunks, "COMM", comm, true);
+            appendChunk(chunks, "SSND", aiffSsnd(pcm16), true);
+            expectError("short-comm.aif", riff("AIFF", chunks, true));
+        }
+
+        {
+            // An AIFC COMM chunk without room for its compression type
+            Bytes chunks;
+            appendChunk(chunks, "COMM", aiffComm(1, 4, 16, rate), true);
+            appendChunk(chunks, "SSND", aiffSsnd(pcm16), true);
+            expectError("short-comm.aifc", riff("AIFC", chunks, true));
+        }
+
+        {
+            // An SSND offset pointing past the end of the chunk
+            Bytes ssnd;
+            appendUInt(ssnd, 1000, 4, true);
+            appendUInt(ssnd, 0, 4, true);
+            ssnd.insert(ssnd.end(), pcm16.begin(), pcm16.end());
+
+            Bytes chunks;
+            appendChunk(chunks, "COMM", aiffComm(1, 4, 16, rate), true);
+            appendChunk(chunks, "SSND", ssnd, true);
+            expectError("bad-offset.aif", riff("AIFF", chunks, true));
+        }
+
+        {
+            Bytes chunks;
+            appendChunk(chunks, "COMM", aiffComm(1, 4, 16, rate), true);
+            expectError("no-ssnd.aif", riff("AIFF", chunks, true));
+        }
+    }
+
+    //==============================================================================
+    void testAsyncCompletionEvent()
+    {
+        Bytes pcm16;
+
+        for (auto w : { 0x0000u, 0x4000u, 0xc000u, 0x8000u })
+            appendUInt(pcm16, w, 2, false);
+
+        auto const goodPath = writeFixture("async.wav", wav(wavFmt(1, 1, 44100, 16), pcm16));
+        auto const badPath = (fixtureDir / "missing.wav").string();
+
+        elem::Runtime<float> runtime(44100, 512);
+        runtime.loadSharedResourceAsync("good", goodPath);
+        runtime.loadSharedResourceAsync("bad", badPath);
+
+        std::vector<elem::js::Object> events;
+        auto const deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+
+        while (events.size() < 2 && std::chrono::steady_clock::now() < deadline) {
+            runtime.processQueuedEvents([&](std::string const& type, elem::js::Value evt) {
+                if (type == "sharedResourceLoaded")
+                    events.push_back(evt.getObject());
+            });
+
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+
+        expect(events.size() == 2, "both loads report a completion event");
+
+        for (auto& evt : events) {
+            auto const name = static_cast<elem::js::String>(evt.at("name"));
+            auto const success = static_cast<elem::js::Boolean>(evt.at("success"));
+            auto const message = static_cast<elem::js::String>(evt.at("message"));
+
+            if (name == "good") {
+                expect(success, "the valid file loads successfully");
+                expect(static_cast<elem::js::String>(evt.at("path")) == goodPath, "the event carries the file path");
+                expect(message.empty(), "a successful load carries no message");
+            } else {
+                expect(name == "bad", "the event carries the resource name");
+                expect(!success, "the missing file fails to load");
+                expect(!message.empty(), "a failed load carries a message");
+            }
+        }
+
+        std::vector<std::string> keys;
+
+        for (auto const& k : runtime.getSharedResourceMapKeys())
+            keys.push_back(k);
+
+        expect(keys == std::vector<std::string> { "good" }, "only the decoded file is added to the shared resource map");
+    }
+
+}
+
+int main()
+{
+    std::filesystem::create_directories(fixtureDir);
+
+    testWavPCM();
+    testWavFloat();
+    testWavExtensible();
+    testAiff();
+    testMalformedHeaders();
+    testAsyncCompletionEvent();
+
+    std::filesystem::remove_all(fixtureDir);
+
+    if (failures > 0) {
+        std::fprintf(stderr, "%d check(s) failed\n", failures);
+        return 1;
+    }
+
+    std::printf("All audio file loader checks passed\n");
+    return 0;
+}
@@ -3,7 +3,6 @@
 #include <memory>
 #include <elem/Runtime.h>
 
-#include "Convolve.h"
 #include "FFT.h"
 #include "Metro.h"
 #include "SampleTime.h"
@@ -27,8 +26,21 @@ public:
 
     //==============================================================================
     /** Called before processing starts. */
-    void prepare (double sr, unsigned int maxBlockSize)
+    val prepare (double sr, unsigned int maxBlockSize)
     {
+        // On a device change we keep the runtime and its graph, and have it prepare
+        // every node for the new settings. If it can't, nothing here changes either.
+        if (runtime) {
+            auto const rc = runtime->prepare(sr, static_cast<int>(maxBlockSize));
+
+            if (rc != elem::ReturnCode::Ok()) {
+                return valueToEmVal(elem::js::Object {
+                    {"success", false},
+                    {"message", elem::ReturnCode::describe(rc)},
+                });
+            }
+        }
+
         sampleRate = sr;
 
         scratchBuffers.clear();
@@ -40,24 +52,27 @@ public:
         for (int i = 0; i < (numInputChannels + numOutputChannels); ++i)
             scratchPointers.push_back(scratchBuffers[i].data());
 
-        // Configure the runtime
-        runtime = std::make_unique<elem::Runtime<double>>(sampleRate, maxBlockSize);
+        if (!runtime) {
+            // Configure the runtime
+            runtime = std::make_unique<elem::Runtime<double>>(sampleRate, maxBlockSize);
 
-        // Register extension nodes
-        runtime->registerNodeType("convolve", [](elem::NodeId const id, double fs, int const bs) {
-            return std::make_shared<elem::ConvolutionNode<double>>(id, fs, bs);
-        });
+            // Register extension nodes
+            runtime->registerNodeType("fft", [](elem::NodeId const id, double fs, int const bs) {
+                return std::make_shared<elem::FFTNode<double>>(id, fs, bs);
+            });
 
-        runtime->registerNodeType("fft", [](elem::NodeId const id, double fs, int const bs) {
-            return std::make_shared<elem::FFTNode<double>>(id, fs, bs);
-        });
+            runtime->registerNodeType("metro", [](elem::NodeId const id, double fs, int const bs) {
+                return std::make_shared<elem::MetronomeNode<double>>(id, fs, bs);
+            });
 
-        runtime->registerNodeType("metro", [](elem::NodeId const id, double fs, int const bs) {
-            return std::make_shared<elem::MetronomeNode<double>>(id, fs, bs);
-        });
+            runtime->registerNodeType("time", [](elem::NodeId const id, double fs, int const bs) {
+                return std::make_shared<elem::SampleTimeNode<double>>(id, fs, bs);
+            });
+        }
 
-        runtime->registerNodeType("time", [](elem::NodeId const id, double fs, int const bs) {
-            return std::make_shared<elem::SampleTimeNode<double>>(id, fs, bs);
+        return valueToEmVal(elem::js::Object {
+            {"success", true},
+            {"message", elem::ReturnCode::describe(elem::ReturnCode::Ok())},
         });
     }
 
@@ -121,56 +136,12 @@ public:
 
     val addSharedResource(val name, val buffer)
     {
-        auto n = emValToValue(name);
-        auto buf = emValToValue(buffer);
-
-        if (!n.isString()) {
-            return valueToEmVal(elem::js::Object {
-                {"success", false},
-                {"message", "name must be a string type"},
-            });
-        }
-
-        if (!buf.isFloat32Array() && !buf.isArray()) {
-            return valueToEmVal(elem::js::Object {
-                {"success", false},
-                {"message", "buffer must be an Array<Float32Array> or a Float32Array"},
-            });
-        }
-
-        if (buf.isArray()) {
-            auto& channels = buf.getArray();
-            std::vector<std::vector<float>> channelData;
-            std::vector<float*> channelPointers;
-
-            for (size_t i = 0; i < channels.size(); ++i) {
-                if (!channels[i].isFloat32Array()) {
-                    return valueToEmVal(elem::js::Object {
-                        {"success", false},
-                        {"message", "buffer must be an Array<Float32Array> or a Float32Array"},
-                    });
-                }
-
-                channelData.push_back(channels[i].getFloat32Array());
-                channelPointers.push_back(channelData[i].data());
-            }
-
-            auto resource = std::make_unique<elem::AudioBufferResource>(channelPointers.data(), channelPointers.size(), channelData[0].size());
-            auto result = runtime->addSharedResource((elem::js::String) n, std::move(resource));
-
-            return valueToEmVal(elem::js::Object {
-                {"success", result},
-                {"message", result ? "Ok" : "cannot overwrite existing shared resource"},
-            });
-        }
-
-        auto& f32vec = buf.getFloat32Array();
-        auto result = runtime->addSharedResource((elem::js::String) n, std::make_unique<elem::AudioBufferResource>(f32vec.data(), f32vec.size()));
+        return addOrUpdateSharedResource(name, buffer, false);
+    }
 
-        return valueToEmVal(elem::js::Object {
-            {"success", result},
-            {"message", result ? "Ok" : "cannot overwrite existing shared resource"},
-        });
+    val updateSharedResource(val name, val buffer)
+    {
+        return addOrUpdateSharedResource(name, buffer, true);
     }
 
     void pruneSharedResources()
@@ -242,6 +213,66 @@ public:
     }
 
 private:
+    //==============================================================================
+    val addOrUpdateSharedResource(val name, val buffer, bool shouldReplace)
+    {
+        auto n = emValToValue(name);
+        auto buf = emValToValue(buffer);
+
+        if (!n.isString()) {
+            return valueToEmVal(elem::js::Object {
+                {"success", false},
+                {"message", "name must be a string type"},
+            });
+        }
+
+        if (!buf.isFloat32Array() && !buf.isArray()) {
+            return valueToEmVal(elem::js::Object {
+                {"success", false},
+                {"message", "buffer must be an Array<Float32Array> or a Float32Array"},
+            });
+        }
+
+        if (buf.isArray()) {
+            auto& channels = buf.getArray();
+            std::vector<std::vector<float>> channelData;
+            std::vector<float*> channelPointers;
+
+            for (size_t i = 0; i < channels.size(); ++i) {
+                if (!channels[i].isFloat32Array()) {
+                    return valueToEmVal(elem::js::Object {
+                        {"success", false},
+                        {"message", "buffer must be an Array<Float32Array> or a Float32Array"},
+                    });
+                }
+
+                channelData.push_back(channels[i].getFloat32Array());
+                channelPointers.push_back(channelData[i].data());
+            }
+
+            auto resource = std::make_unique<elem::AudioBufferResource>(channelPointers.data(), channelPointers.size(), channelData[0].size());
+            auto result = shouldReplace
+                ? runtime->updateSharedResource((elem::js::String) n, std::move(resource))
+                : runtime->addSharedResource((elem::js::String) n, std::move(resource));
+
+            return valueToEmVal(elem::js::Object {
+                {"success", result},
+                {"message", result ? "Ok" : "cannot overwrite existing shared resource"},
+            });
+        }
+
+        auto& f32vec = buf.getFloat32Array();
+        auto resource = std::make_unique<elem::AudioBufferResource>(f32vec.data(), f32vec.size());
+        auto result = shouldReplace
+            ? runtime->updateSharedResource((elem::js::String) n, std::move(resource))
+            : runtime->addSharedResource((elem::js::String) n, std::move(resource));
+
+        return valueToEmVal(elem::js::Object {
+            {"success", result},
+            {"message", result ? "Ok" : "cannot overwrite existing shared resource"},
+        });
+    }
+
     //==============================================================================
     elem::js::Value emValToValue (val const& v)
     {
@@ -381,6 +412,7 @@ EMSCRIPTEN_BINDINGS(Elementary) {
         .function("reset", &ElementaryAudioProcessor::reset)
         .function("gc", &ElementaryAudioProcessor::gc)
         .function("addSharedResource", &ElementaryAudioProcessor::addSharedResource)
+        .function("updateSharedResource", &ElementaryAudioProcessor::updateSharedResource)
         .function("pruneSharedResources", &ElementaryAudioProcessor::pruneSharedResources)
         .function("listSharedResources", &ElementaryAudioProcessor::listSharedResources)
         .function("process", &ElementaryAudioProcessor::process)